@@ -90,6 +90,101 @@ Level = {
         scale = 2.0
     },
 
+    ----------------------------------------------------
+    -- table to define the entities repeated across the map,
+    -- the entities made from a prefab get its group and components
+    ----------------------------------------------------
+    prefabs = {
+        truck_right = {
+            group = "enemies",
+            components = {
+                sprite = {
+                    texture_asset_id = "truck-ford-right-texture",
+                    width = 32,
+                    height = 32,
+                    z_index = 1
+                },
+                box_collider = {
+                    width = 30,
+                    height = 20,
+                    offset = { x = 0, y = 5 }
+                },
+                health = {
+                    health_percentage = 100
+                },
+                projectile_emitter = {
+                    projectile_velocity = { x = 50, y = 0 },
+                    projectile_duration = 5, -- seconds
+                    repeat_frequency = 3, -- seconds
+                    hit_percentage_damage = 5,
+                    should_collide_with_player = true
+                }
+            }
+        },
+        truck_left = {
+            group = "enemies",
+            components = {
+                sprite = {
+                    texture_asset_id = "truck-ford-left-texture",
+                    width = 32,
+                    height = 32,
+                    z_index = 1
+                },
+                box_collider = {
+                    width = 30,
+                    height = 20,
+                    offset = { x = 0, y = 5 }
+                },
+                health = {
+                    health_percentage = 100
+                },
+                projectile_emitter = {
+                    projectile_velocity = { x = -50, y = 0 },
+                    projectile_duration = 2, -- seconds
+                    repeat_frequency = 3, -- seconds
+                    hit_percentage_damage = 5,
+                    should_collide_with_player = true
+                }
+            }
+        },
+        truck_up = {
+            group = "enemies",
+            components = {
+                sprite = {
+                    texture_asset_id = "truck-ford-up-texture",
+                    width = 32,
+                    height = 32,
+                    z_index = 1
+                },
+                box_collider = {
+                    width = 12,
+                    height = 20,
+                    offset = { x = 10, y = 8 }
+                },
+                health = {
+                    health_percentage = 100
+                },
+                projectile_emitter = {
+                    projectile_velocity = { x = 0, y = -100 },
+                    projectile_duration = 2, -- seconds
+                    repeat_frequency = 2, -- seconds
+                    hit_percentage_damage = 5,
+                    should_collide_with_player = true
+                }
+            }
+        },
+        obstacle = {
+            components = {
+                sprite = {
+                    texture_asset_id = "obstacles7-texture",
+                    width = 16,
+                    height = 16,
+                    z_index = 2
+                }
+            }
+        }
+    },
+
     ----------------------------------------------------
     -- table to define entities and their components
     ----------------------------------------------------
@@ -620,620 +715,220 @@ Level = {
         },
         {
             -- Truck
-            group = "enemies",
+            prefab = "truck_right",
+            components = {
+                transform = { position = { x = 600, y = 1000 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_right",
+            components = {
+                transform = { position = { x = 600, y = 1050 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_right",
+            components = {
+                transform = { position = { x = 600, y = 1100 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_right",
+            components = {
+                transform = { position = { x = 600, y = 1150 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_right",
+            components = {
+                transform = { position = { x = 600, y = 1200 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_right",
+            components = {
+                transform = { position = { x = 600, y = 1250 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_left",
+            components = {
+                transform = { position = { x = 1280, y = 1100 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_left",
+            components = {
+                transform = { position = { x = 1240, y = 1150 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_left",
+            components = {
+                transform = { position = { x = 1200, y = 1200 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_up",
+            components = {
+                transform = { position = { x = 850, y = 1840 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_up",
+            components = {
+                transform = { position = { x = 900, y = 1840 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_up",
+            components = {
+                transform = { position = { x = 950, y = 1840 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_up",
+            components = {
+                transform = { position = { x = 1000, y = 1840 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_left",
+            components = {
+                transform = { position = { x = 2400, y = 1100 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_left",
+            components = {
+                transform = { position = { x = 2350, y = 1150 } }
+            }
+        },
+        {
+            -- Truck
+            prefab = "truck_left",
+            components = {
+                transform = { position = { x = 2300, y = 1200 } }
+            }
+        },
+        {
+            -- Army
             components = {
                 transform = {
-                    position = { x = 600, y = 1000 },
+                    position = { x = 500, y = 450 },
                     scale = { x = 1.0, y = 1.0 },
                     rotation = 0.0, -- degrees
                 },
                 sprite = {
-                    texture_asset_id = "truck-ford-right-texture",
+                    texture_asset_id = "army-walk-left-texture",
                     width = 32,
                     height = 32,
                     z_index = 1
                 },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 50, y = 0 },
-                    projectile_duration = 5, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
             }
         },
         {
-            -- Truck
-            group = "enemies",
+            -- Army
             components = {
                 transform = {
-                    position = { x = 600, y = 1050 },
+                    position = { x = 600, y = 800 },
                     scale = { x = 1.0, y = 1.0 },
                     rotation = 0.0, -- degrees
                 },
                 sprite = {
-                    texture_asset_id = "truck-ford-right-texture",
+                    texture_asset_id = "army-gun-right-texture",
                     width = 32,
                     height = 32,
                     z_index = 1
                 },
                 box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
+                    width = 32,
+                    height = 32,
+                    offset = { x = 0, y = 0 }
                 },
                 health = {
                     health_percentage = 100
                 },
                 projectile_emitter = {
-                    projectile_velocity = { x = 50, y = 0 },
-                    projectile_duration = 5, -- seconds
-                    repeat_frequency = 3, -- seconds
+                    projectile_velocity = { x = 100, y = 0 },
+                    projectile_duration = 2, -- seconds
+                    repeat_frequency = 1, -- seconds
                     hit_percentage_damage = 5,
                     should_collide_with_player = true
                 }
             }
         },
         {
-            -- Truck
-            group = "enemies",
+            -- Army
             components = {
                 transform = {
-                    position = { x = 600, y = 1100 },
+                    position = { x = 600, y = 900 },
                     scale = { x = 1.0, y = 1.0 },
                     rotation = 0.0, -- degrees
                 },
                 sprite = {
-                    texture_asset_id = "truck-ford-right-texture",
+                    texture_asset_id = "army-gun-right-texture",
                     width = 32,
                     height = 32,
                     z_index = 1
                 },
                 box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
+                    width = 32,
+                    height = 32,
+                    offset = { x = 0, y = 0 }
                 },
                 health = {
                     health_percentage = 100
                 },
                 projectile_emitter = {
-                    projectile_velocity = { x = 50, y = 0 },
-                    projectile_duration = 5, -- seconds
-                    repeat_frequency = 3, -- seconds
+                    projectile_velocity = { x = 100, y = 0 },
+                    projectile_duration = 2, -- seconds
+                    repeat_frequency = 1, -- seconds
                     hit_percentage_damage = 5,
                     should_collide_with_player = true
                 }
             }
         },
         {
-            -- Truck
-            group = "enemies",
+            -- Army
             components = {
                 transform = {
-                    position = { x = 600, y = 1150 },
+                    position = { x = 1200, y = 900 },
                     scale = { x = 1.0, y = 1.0 },
                     rotation = 0.0, -- degrees
                 },
                 sprite = {
-                    texture_asset_id = "truck-ford-right-texture",
+                    texture_asset_id = "army-walk-left-texture",
                     width = 32,
                     height = 32,
                     z_index = 1
                 },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 50, y = 0 },
-                    projectile_duration = 5, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
             }
         },
         {
-            -- Truck
-            group = "enemies",
+            -- Army
             components = {
                 transform = {
-                    position = { x = 600, y = 1200 },
+                    position = { x = 1600, y = 900 },
                     scale = { x = 1.0, y = 1.0 },
                     rotation = 0.0, -- degrees
                 },
                 sprite = {
-                    texture_asset_id = "truck-ford-right-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 50, y = 0 },
-                    projectile_duration = 5, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 600, y = 1250 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-right-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 50, y = 0 },
-                    projectile_duration = 5, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 1280, y = 1100 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-left-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = -50, y = 0 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 1240, y = 1150 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-left-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = -50, y = 0 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 1200, y = 1200 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-left-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = -50, y = 0 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 850, y = 1840 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-up-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 12,
-                    height = 20,
-                    offset = { x = 10, y = 8 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 0, y = -100 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 2, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 900, y = 1840 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-up-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 12,
-                    height = 20,
-                    offset = { x = 10, y = 8 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 0, y = -100 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 2, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 950, y = 1840 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-up-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 12,
-                    height = 20,
-                    offset = { x = 10, y = 8 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 0, y = -100 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 2, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 1000, y = 1840 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-up-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 12,
-                    height = 20,
-                    offset = { x = 10, y = 8 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 0, y = -100 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 2, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 2400, y = 1100 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-left-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = -50, y = 0 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 2350, y = 1150 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-left-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = -50, y = 0 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Truck
-            group = "enemies",
-            components = {
-                transform = {
-                    position = { x = 2300, y = 1200 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "truck-ford-left-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 30,
-                    height = 20,
-                    offset = { x = 0, y = 5 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = -50, y = 0 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 3, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Army
-            components = {
-                transform = {
-                    position = { x = 500, y = 450 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "army-walk-left-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-            }
-        },
-        {
-            -- Army
-            components = {
-                transform = {
-                    position = { x = 600, y = 800 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "army-gun-right-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 32,
-                    height = 32,
-                    offset = { x = 0, y = 0 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 100, y = 0 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 1, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Army
-            components = {
-                transform = {
-                    position = { x = 600, y = 900 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "army-gun-right-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-                box_collider = {
-                    width = 32,
-                    height = 32,
-                    offset = { x = 0, y = 0 }
-                },
-                health = {
-                    health_percentage = 100
-                },
-                projectile_emitter = {
-                    projectile_velocity = { x = 100, y = 0 },
-                    projectile_duration = 2, -- seconds
-                    repeat_frequency = 1, -- seconds
-                    hit_percentage_damage = 5,
-                    should_collide_with_player = true
-                }
-            }
-        },
-        {
-            -- Army
-            components = {
-                transform = {
-                    position = { x = 1200, y = 900 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "army-walk-left-texture",
-                    width = 32,
-                    height = 32,
-                    z_index = 1
-                },
-            }
-        },
-        {
-            -- Army
-            components = {
-                transform = {
-                    position = { x = 1600, y = 900 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "army-walk-left-texture",
+                    texture_asset_id = "army-walk-left-texture",
                     width = 32,
                     height = 32,
                     z_index = 1
@@ -1508,466 +1203,205 @@ Level = {
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 400, y = 500 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 400, y = 500 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1350, y = 400 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1350, y = 400 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1920, y = 1700 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1920, y = 1700 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 900, y = 800 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 900, y = 800 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 920, y = 800 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 920, y = 800 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 940, y = 800 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 940, y = 800 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 960, y = 800 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 960, y = 800 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 980, y = 800 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 980, y = 800 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1000, y = 800 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1000, y = 800 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1020, y = 800 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1020, y = 800 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1040, y = 800 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1040, y = 800 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 900, y = 710 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 900, y = 710 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 920, y = 710 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 920, y = 710 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 940, y = 710 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 940, y = 710 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 960, y = 710 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 960, y = 710 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 980, y = 710 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 980, y = 710 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1000, y = 710 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1000, y = 710 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1020, y = 710 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1020, y = 710 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1040, y = 710 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1040, y = 710 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 900, y = 725 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 900, y = 725 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 900, y = 740 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 900, y = 740 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 900, y = 755 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 900, y = 755 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 900, y = 770 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 900, y = 770 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 900, y = 785 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 900, y = 785 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1040, y = 725 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1040, y = 725 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1040, y = 740 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1040, y = 740 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1040, y = 755 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1040, y = 755 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1040, y = 770 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1040, y = 770 } }
             }
         },
         {
             -- Obstacle
+            prefab = "obstacle",
             components = {
-                transform = {
-                    position = { x = 1040, y = 785 },
-                    scale = { x = 1.0, y = 1.0 },
-                    rotation = 0.0, -- degrees
-                },
-                sprite = {
-                    texture_asset_id = "obstacles7-texture",
-                    width = 16,
-                    height = 16,
-                    z_index = 2
-                },
+                transform = { position = { x = 1040, y = 785 } }
             }
         },
         {
@@ -2526,25 +1960,24 @@ Level = {
                 health = {
                     health_percentage = 100
                 },
-                on_update_script = {
+                behaviour_script = {
                     [0] =
-                    function(entity, delta_time, ellapsed_time)
-                        -- this function makes the fighter jet move up and down the map shooting projectiles
-                        local current_position_x, current_position_y = get_position(entity)
+                    function(entity)
+                        -- this behaviour makes the fighter jet move up and down the map shooting projectiles,
+                        -- it sleeps until the jet reaches the top or the bottom of the map instead of checking every frame.
+                        -- the position is read again after each wait
                         local current_velocity_x, current_velocity_y = get_velocity(entity)
-
-                        -- if it reaches the top or the bottom of the map
-                        if current_position_y < 10  or current_position_y > map_height - 32 then
-                            set_velocity(entity, 0, current_velocity_y * -1); -- flip the entity y-velocity
-                        else
-                            set_velocity(entity, 0, current_velocity_y); -- do not flip y-velocity
-                        end
-
-                        -- set the transform rotation to match going up or down
-                        if (current_velocity_y < 0) then
+                        local speed = math.abs(current_velocity_y)
+                        while true do
+                            local current_position_x, current_position_y = get_position(entity)
+                            set_velocity(entity, 0, -speed)
                             set_rotation(entity, 0) -- point up
-                        else
+                            wait((current_position_y - 10) / speed)
+
+                            current_position_x, current_position_y = get_position(entity)
+                            set_velocity(entity, 0, speed)
                             set_rotation(entity, 180) -- point down
+                            wait((map_height - 32 - current_position_y) / speed)
                         end
                     end
                 }
@@ -0,0 +1,352 @@
+#include "pch.h"
+
+#include "AssetArchive.h"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "Logger/Logger.h"
+#include "HelperFunctions.h"
+#include "RawTexture.h"
+
+namespace
+{
+	const char MAGIC[4] = { '2', 'D', 'P', 'K' };
+	const std::size_t HEADER_SIZE = 4 * sizeof(std::uint32_t);
+
+	// an image and its raw texture are not both packed, only the one the AssetStore would load
+	bool IsReplacedByRawTexture(const std::filesystem::path& filePath)
+	{
+		const std::filesystem::path extension = filePath.extension();
+		if (extension == ".png" || extension == ".jpg")
+		{
+			return RawTexture::IsUpToDate(filePath.generic_string());
+		}
+		if (RawTexture::IsRawPath(filePath.generic_string()))
+		{
+			for (const char* imageExtension : { ".png", ".jpg" })
+			{
+				const std::string imagePath = std::filesystem::path(filePath).replace_extension(imageExtension).generic_string();
+				if (std::filesystem::exists(imagePath) && !RawTexture::IsUpToDate(imagePath))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	std::size_t Align(std::size_t offset)
+	{
+		return (offset + AssetArchive::BLOB_ALIGNMENT - 1) / AssetArchive::BLOB_ALIGNMENT * AssetArchive::BLOB_ALIGNMENT;
+	}
+
+	// the index is read and written field by field, the layout does not depend on the compiler
+	template <typename T>
+	void Write(std::string& buffer, T value)
+	{
+		buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool Read(const unsigned char*& cursor, const unsigned char* end, T& value)
+	{
+		if (static_cast<std::size_t>(end - cursor) < sizeof(T))
+		{
+			return false;
+		}
+		std::memcpy(&value, cursor, sizeof(T));
+		cursor += sizeof(T);
+		return true;
+	}
+}
+
+AssetArchive::~AssetArchive()
+{
+	Close();
+}
+
+bool AssetArchive::Open(const std::string& archivePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(archivePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		Logger::Error("AssetArchive: could not open " + archivePath);
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	HANDLE mapping = fileSize.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+	m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	const int file = open(archivePath.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		Logger::Error("AssetArchive: could not open " + archivePath);
+		return false;
+	}
+	struct stat fileStatus;
+	fstat(file, &fileStatus);
+	void* data = fileStatus.st_size > 0 ? mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+	// the mapping stays valid once the file is closed
+	close(file);
+	data = data != MAP_FAILED ? data : nullptr;
+	m_size = static_cast<std::size_t>(fileStatus.st_size);
+#endif
+
+	m_data = static_cast<const unsigned char*>(data);
+	if (!m_data)
+	{
+		Logger::Error("AssetArchive: could not map " + archivePath);
+		Close();
+		return false;
+	}
+	if (!ReadIndex())
+	{
+		Logger::Error("AssetArchive: " + archivePath + " is not a valid archive");
+		Close();
+		return false;
+	}
+
+	Logger::Log("AssetArchive: " + archivePath + " opened, " + std::to_string(m_entries.size()) + " files");
+	return true;
+}
+
+void AssetArchive::Close()
+{
+#ifdef _WIN32
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+	}
+	if (m_fileHandle)
+	{
+		CloseHandle(m_fileHandle);
+	}
+#else
+	if (m_data)
+	{
+		munmap(const_cast<unsigned char*>(m_data), m_size);
+	}
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+	m_entries.clear();
+}
+
+void AssetArchive::Prefetch() const
+{
+	if (!m_data)
+	{
+		return;
+	}
+#ifdef _WIN32
+	WIN32_MEMORY_RANGE_ENTRY range{ const_cast<unsigned char*>(m_data), m_size };
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	madvise(const_cast<unsigned char*>(m_data), m_size, MADV_WILLNEED);
+#endif
+}
+
+AssetArchive::Blob AssetArchive::Find(const std::string& filePath) const
+{
+	const std::string path = NormalizePath(filePath);
+	const auto entry = std::lower_bound(m_entries.begin(), m_entries.end(), path, [](const Entry& entry, const std::string& path) { return entry.m_path < path; });
+	if (entry == m_entries.end() || entry->m_path != path)
+	{
+		return Blob();
+	}
+	return Blob{ m_data + entry->m_offset, static_cast<std::size_t>(entry->m_size) };
+}
+
+SDL_RWops* AssetArchive::OpenFile(const std::string& filePath) const
+{
+	const Blob blob = Find(filePath);
+	if (!blob.m_data)
+	{
+		return nullptr;
+	}
+	// SDL takes the size as an int
+	if (blob.m_size > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+	{
+		Logger::Error("AssetArchive: " + filePath + " is too large to be opened");
+		return nullptr;
+	}
+	return SDL_RWFromConstMem(blob.m_data, static_cast<int>(blob.m_size));
+}
+
+bool AssetArchive::Pack(const std::string& assetsDirectory, const std::string& archivePath)
+{
+	std::vector<std::filesystem::path> filePaths;
+	std::error_code error;
+	for (auto entry = std::filesystem::recursive_directory_iterator(assetsDirectory, error); entry != std::filesystem::recursive_directory_iterator(); entry.increment(error))
+	{
+		if (entry->is_directory() && entry->path().filename() == CONST::ARCHIVE::SKIPPED_DIRECTORY)
+		{
+			entry.disable_recursion_pending();
+			continue;
+		}
+		if (entry->is_regular_file() && entry->path().extension() != ".pak" && !IsReplacedByRawTexture(entry->path()))
+		{
+			filePaths.push_back(entry->path());
+		}
+	}
+	if (error)
+	{
+		Logger::Error("AssetArchive: could not read " + assetsDirectory + ": " + error.message());
+		return false;
+	}
+
+	// sorted so that the index can be searched, the blobs are in the same order
+	std::vector<std::string> paths;
+	for (const auto& filePath : filePaths)
+	{
+		paths.push_back(NormalizePath(filePath.generic_string()));
+	}
+	std::vector<std::size_t> order(filePaths.size());
+	for (std::size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&paths](std::size_t a, std::size_t b) { return paths[a] < paths[b]; });
+
+	std::size_t indexSize = 0;
+	for (const auto& path : paths)
+	{
+		indexSize += 2 * sizeof(std::uint64_t) + sizeof(std::uint32_t) + path.size();
+	}
+
+	std::vector<std::string> contents(filePaths.size());
+	std::string index;
+	std::size_t offset = Align(HEADER_SIZE + indexSize);
+	for (const std::size_t i : order)
+	{
+		if (!Helpers::ReadFile(filePaths[i].string(), contents[i]))
+		{
+			Logger::Error("AssetArchive: could not read " + filePaths[i].generic_string());
+			return false;
+		}
+
+		Write<std::uint64_t>(index, offset);
+		Write<std::uint64_t>(index, contents[i].size());
+		Write<std::uint32_t>(index, static_cast<std::uint32_t>(paths[i].size()));
+		index += paths[i];
+		offset = Align(offset + contents[i].size());
+	}
+
+	std::string header(MAGIC, sizeof(MAGIC));
+	Write<std::uint32_t>(header, VERSION);
+	Write<std::uint32_t>(header, static_cast<std::uint32_t>(filePaths.size()));
+	Write<std::uint32_t>(header, static_cast<std::uint32_t>(indexSize));
+
+	std::ofstream archive(archivePath, std::ios::binary | std::ios::trunc);
+	archive << header << index;
+	std::size_t position = header.size() + index.size();
+	for (const std::size_t i : order)
+	{
+		const std::string padding(Align(position) - position, '\0');
+		archive << padding << contents[i];
+		position += padding.size() + contents[i].size();
+	}
+	if (!archive)
+	{
+		Logger::Error("AssetArchive: could not write " + archivePath);
+		return false;
+	}
+
+	Logger::Log("AssetArchive: packed " + std::to_string(filePaths.size()) + " files into " + archivePath + " (" + std::to_string(position / 1024) + " KB)");
+	return true;
+}
+
+std::string AssetArchive::NormalizePath(const std::string& filePath)
+{
+	std::string path = std::filesystem::path(filePath).lexically_normal().generic_string();
+	if (path.compare(0, 2, "./") == 0)
+	{
+		path.erase(0, 2);
+	}
+	return path;
+}
+
+bool AssetArchive::ReadIndex()
+{
+	const unsigned char* cursor = m_data;
+	const unsigned char* end = m_data + m_size;
+
+	std::uint32_t version = 0;
+	std::uint32_t numberOfEntries = 0;
+	std::uint32_t indexSize = 0;
+	if (m_size < HEADER_SIZE || std::memcmp(cursor, MAGIC, sizeof(MAGIC)) != 0)
+	{
+		return false;
+	}
+	cursor += sizeof(MAGIC);
+	Read(cursor, end, version);
+	Read(cursor, end, numberOfEntries);
+	Read(cursor, end, indexSize);
+	if (version != VERSION || indexSize > static_cast<std::size_t>(end - cursor))
+	{
+		return false;
+	}
+
+	// every entry takes at least its offset, size and path length in the index, a larger count is not reserved
+	const std::size_t minimumEntrySize = 2 * sizeof(std::uint64_t) + sizeof(std::uint32_t);
+	if (numberOfEntries > indexSize / minimumEntrySize)
+	{
+		return false;
+	}
+	const unsigned char* indexEnd = cursor + indexSize;
+
+	m_entries.reserve(numberOfEntries);
+	for (std::uint32_t i = 0; i < numberOfEntries; i++)
+	{
+		Entry entry;
+		std::uint32_t pathLength = 0;
+		if (!Read(cursor, indexEnd, entry.m_offset) || !Read(cursor, indexEnd, entry.m_size) || !Read(cursor, indexEnd, pathLength)
+			|| pathLength > static_cast<std::size_t>(indexEnd - cursor))
+		{
+			return false;
+		}
+		entry.m_path.assign(reinterpret_cast<const char*>(cursor), pathLength);
+		cursor += pathLength;
+
+		// a truncated archive would hand out memory past its end
+		if (entry.m_offset > m_size || entry.m_size > m_size - entry.m_offset)
+		{
+			return false;
+		}
+		// Find() searches the index with lower_bound, the paths have to be sorted and unique
+		if (!m_entries.empty() && !(m_entries.back().m_path < entry.m_path))
+		{
+			return false;
+		}
+		m_entries.push_back(std::move(entry));
+	}
+	return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct SDL_RWops;
+
+namespace CONST
+{
+	namespace ARCHIVE
+	{
+		// written by '2DGameEngine --pack-assets', mounted by the game when it exists
+		const std::string ARCHIVE_PATH = "./assets.pak";
+		const std::string ASSETS_DIRECTORY = "./assets";
+		// the scripts are loaded by Lua (see ScriptCache), they are not packed
+		const std::string SKIPPED_DIRECTORY = "scripts";
+	}
+}
+
+// A read only pack of asset files, memory mapped.
+// Layout (little endian):
+//   header   "2DPK", version, number of entries, size of the index        4 x uint32
+//   index    per entry: offset and size of the blob (uint64), length of the path (uint32) and the path
+//   blobs    the content of the files, each one starting at a multiple of BLOB_ALIGNMENT
+// The paths are the ones of the levels without the leading "./", "./assets/images/tank.png" is "assets/images/tank.png".
+// The blobs are handed to SDL with SDL_RWFromConstMem, nothing is copied and no file is opened after Open()
+class AssetArchive
+{
+public:
+	static constexpr std::uint32_t VERSION = 1;
+	static constexpr std::size_t BLOB_ALIGNMENT = 16;
+
+	struct Blob
+	{
+		const unsigned char* m_data = nullptr;
+		std::size_t m_size = 0;
+	};
+
+	AssetArchive() = default;
+	~AssetArchive();
+	AssetArchive(const AssetArchive&) = delete;
+	AssetArchive& operator=(const AssetArchive&) = delete;
+
+	// false (and logged) when the file is missing or is not a valid archive
+	bool Open(const std::string& archivePath);
+	void Close();
+	bool IsOpen() const { return m_data != nullptr; }
+
+	// asks the system to read the whole archive now, in one sequential read, instead of page by page on first use
+	void Prefetch() const;
+
+	// empty when the file is not in the archive
+	Blob Find(const std::string& filePath) const;
+	// a read only SDL stream over the file, nullptr when it is not in the archive. The archive must stay open while it is used
+	SDL_RWops* OpenFile(const std::string& filePath) const;
+
+	std::size_t GetNumberOfFiles() const { return m_entries.size(); }
+
+	// packs every file of the directory (the SKIPPED_DIRECTORY, other archives and the images replaced by a raw texture
+	// excepted, see RawTexture) into archivePath, returns false when a file could not be read
+	// or the archive could not be written
+	static bool Pack(const std::string& assetsDirectory, const std::string& archivePath);
+
+	// "./assets/images/../images/tank.png" and "assets/images/tank.png" are the same entry
+	static std::string NormalizePath(const std::string& filePath);
+private:
+	struct Entry
+	{
+		std::string m_path;
+		std::uint64_t m_offset;
+		std::uint64_t m_size;
+	};
+
+	bool ReadIndex();
+
+	// sorted by path
+	std::vector<Entry> m_entries;
+
+	const unsigned char* m_data = nullptr;
+	std::size_t m_size = 0;
+	// handles of the mapping, platform specific
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+};
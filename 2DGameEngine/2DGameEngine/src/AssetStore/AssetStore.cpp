@@ -2,9 +2,167 @@
 
 #include "AssetStore.h"
 
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+
 #include "Logger/Logger.h"
+#include "RawTexture.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    std::string ToString(double milliseconds)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.2f", milliseconds);
+        return buffer;
+    }
+
+    // either a surface or the pixels of a raw texture
+    struct DecodedImage
+    {
+        SDL_Surface* m_surface = nullptr;
+        RawTexture::Image m_rawImage;
+        std::string m_error;
+        // logged by the calling thread, the Logger is not thread safe
+        std::string m_warning;
+        double m_decodeMilliseconds = 0.;
+
+        bool IsValid() const { return m_surface || m_rawImage.m_pixels; }
+    };
+
+    SDL_Surface* LoadImage(const AssetArchive& archive, const std::string& filePath)
+    {
+        SDL_RWops* archiveFile = archive.OpenFile(filePath);
+        if (!archiveFile)
+        {
+            return IMG_Load(filePath.c_str());
+        }
+        // IMG_Load() guesses the format from the extension, so does this
+        const std::string extension = std::filesystem::path(filePath).extension().string();
+        return IMG_LoadTyped_RW(archiveFile, 1, extension.empty() ? nullptr : extension.c_str() + 1);
+    }
+
+    // thread safe, the raw texture is preferred to the image
+    DecodedImage DecodeImage(const AssetArchive& archive, const std::string& filePath)
+    {
+        DecodedImage image;
+        const auto decodeStart = Clock::now();
+
+        // the packer only packs the raw textures that are up to date
+        const std::string rawPath = RawTexture::IsRawPath(filePath) ? filePath : RawTexture::GetRawPath(filePath);
+        const AssetArchive::Blob rawBlob = archive.Find(rawPath);
+        if (rawBlob.m_data)
+        {
+            RawTexture::Decode(rawBlob.m_data, rawBlob.m_size, image.m_rawImage, image.m_error);
+        }
+        else if (RawTexture::IsRawPath(filePath) || RawTexture::IsUpToDate(filePath))
+        {
+            RawTexture::Load(rawPath, image.m_rawImage, image.m_error);
+        }
+
+        // a raw texture that cannot be read is not fatal while the image is there
+        if (!image.m_rawImage.m_pixels && !RawTexture::IsRawPath(filePath))
+        {
+            if (!image.m_error.empty())
+            {
+                image.m_warning = rawPath + ": " + image.m_error + ", decoding " + filePath + " instead";
+            }
+            image.m_surface = LoadImage(archive, filePath);
+            // SDL keeps the errors per thread
+            image.m_error = image.m_surface ? "" : IMG_GetError();
+        }
+
+        image.m_decodeMilliseconds = MillisecondsSince(decodeStart);
+        return image;
+    }
+
+    // on the thread of the renderer, the surface is freed
+    SDL_Texture* CreateTexture(SDL_Renderer* renderer, DecodedImage& image, std::size_t& bytes)
+    {
+        SDL_Texture* texture = nullptr;
+        if (image.m_surface)
+        {
+            texture = SDL_CreateTextureFromSurface(renderer, image.m_surface);
+            bytes = static_cast<std::size_t>(image.m_surface->pitch) * image.m_surface->h;
+            SDL_FreeSurface(image.m_surface);
+            image.m_surface = nullptr;
+            return texture;
+        }
+
+        // no surface to convert: when the renderer supports the format the pixels are copied as they are
+        const RawTexture::Image& rawImage = image.m_rawImage;
+        texture = SDL_CreateTexture(renderer, rawImage.m_pixelFormat, SDL_TEXTUREACCESS_STATIC, rawImage.m_width, rawImage.m_height);
+        if (texture && SDL_UpdateTexture(texture, nullptr, rawImage.m_pixels, rawImage.m_pitch) != 0)
+        {
+            SDL_DestroyTexture(texture);
+            return nullptr;
+        }
+        if (texture && SDL_ISPIXELFORMAT_ALPHA(rawImage.m_pixelFormat))
+        {
+            // what SDL_CreateTextureFromSurface() does for the images with alpha
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        }
+        bytes = static_cast<std::size_t>(rawImage.m_pitch) * rawImage.m_height;
+        return texture;
+    }
+
+    // calls function(i) for i in [0, count) on up to one thread per core, the calling thread being one of them.
+    // The threads take the next index when they are done with theirs, a slow image does not hold the others back
+    template <typename TFunction>
+    std::size_t ParallelFor(std::size_t count, const TFunction& function)
+    {
+        std::atomic<std::size_t> nextIndex{ 0 };
+        const auto work = [&nextIndex, count, &function]()
+        {
+            for (std::size_t i = nextIndex++; i < count; i = nextIndex++)
+            {
+                function(i);
+            }
+        };
+
+        const std::size_t numberOfCores = std::max(1u, std::thread::hardware_concurrency());
+        const std::size_t numberOfThreads = std::max<std::size_t>(1, std::min(count, numberOfCores));
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < numberOfThreads; i++)
+        {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        return numberOfThreads;
+    }
+}
+
+void AssetHandle::Release()
+{
+    if (IsValid())
+    {
+        if (m_assetType == AssetType::TEXTURE)
+        {
+            m_assetStore->ReleaseTexture(m_assetName);
+        }
+        else
+        {
+            m_assetStore->ReleaseFont(m_assetName);
+        }
+    }
+    m_assetStore = nullptr;
+}
 
 AssetStore::AssetStore()
+    : m_isAlive(std::make_shared<bool>(true))
 {
     Logger::Log("AssetStore constructed");
 }
@@ -15,50 +173,303 @@ AssetStore::~AssetStore()
     Logger::Log("AssetStore destructed");
 }
 
-void AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetName, const std::string& filePath)
+bool AssetStore::MountArchive(const std::string& archivePath)
 {
-    SDL_Surface* surface = IMG_Load(filePath.c_str());
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
+    if (m_archive.IsOpen())
+    {
+        Logger::Error("AssetStore: an archive is already mounted, " + archivePath + " is not");
+        return false;
+    }
+    if (!m_archive.Open(archivePath))
+    {
+        return false;
+    }
+    // the levels read most of it, one sequential read is cheaper than a page fault per file
+    m_archive.Prefetch();
+    return true;
+}
 
-    if (texture)
+AssetHandle AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetName, const std::string& filePath)
+{
+    if (AddTextureReference(assetName, filePath))
     {
-        m_textures.emplace(assetName, texture);
-        Logger::Log("new texture added to AssetStore with id= " + assetName);
+        return MakeHandle(AssetHandle::AssetType::TEXTURE, assetName);
     }
-    else
+
+    DecodedImage image = DecodeImage(m_archive, filePath);
+    if (!image.m_warning.empty())
+    {
+        Logger::Error("AssetStore: " + image.m_warning);
+    }
+    std::size_t bytes = 0;
+    SDL_Texture* texture = image.IsValid() ? CreateTexture(renderer, image, bytes) : nullptr;
+
+    if (!texture)
     {
         Logger::Error("null texture with name = " + assetName + " and filepath = " + filePath);
+        return AssetHandle();
+    }
+
+    StoreTexture(assetName, filePath, texture, bytes);
+    Logger::Log("new texture added to AssetStore with id= " + assetName);
+    return MakeHandle(AssetHandle::AssetType::TEXTURE, assetName);
+}
+
+std::vector<AssetHandle> AssetStore::AddTextures(SDL_Renderer* renderer, const std::vector<TextureAsset>& textures)
+{
+    const auto loadStart = Clock::now();
+
+    // only what is not loaded yet is decoded
+    std::vector<AssetHandle> handles;
+    handles.reserve(textures.size());
+    std::vector<TextureAsset> texturesToLoad;
+    for (const auto& texture : textures)
+    {
+        if (AddTextureReference(texture.m_name, texture.m_filePath))
+        {
+            handles.push_back(MakeHandle(AssetHandle::AssetType::TEXTURE, texture.m_name));
+        }
+        else
+        {
+            texturesToLoad.push_back(texture);
+        }
+    }
+
+    // SDL_image loads its decoders on first use, that is not thread safe
+    IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+
+    std::vector<DecodedImage> images(texturesToLoad.size());
+    const std::size_t numberOfThreads = ParallelFor(texturesToLoad.size(), [this, &texturesToLoad, &images](std::size_t i)
+    {
+        images[i] = DecodeImage(m_archive, texturesToLoad[i].m_filePath);
+    });
+    const double decodeMilliseconds = MillisecondsSince(loadStart);
+
+    const auto uploadStart = Clock::now();
+    for (std::size_t i = 0; i < texturesToLoad.size(); i++)
+    {
+        const TextureAsset& asset = texturesToLoad[i];
+        DecodedImage& image = images[i];
+        if (!image.m_warning.empty())
+        {
+            Logger::Error("AssetStore: " + image.m_warning);
+        }
+        if (!image.IsValid())
+        {
+            Logger::Error("null texture with name = " + asset.m_name + " and filepath = " + asset.m_filePath + ": " + image.m_error);
+            continue;
+        }
+
+        const auto textureStart = Clock::now();
+        std::size_t bytes = 0;
+        SDL_Texture* texture = CreateTexture(renderer, image, bytes);
+        const double uploadMilliseconds = MillisecondsSince(textureStart);
+
+        if (texture)
+        {
+            StoreTexture(asset.m_name, asset.m_filePath, texture, bytes);
+            handles.push_back(MakeHandle(AssetHandle::AssetType::TEXTURE, asset.m_name));
+            Logger::Log("new texture added to AssetStore with id= " + asset.m_name + " (decoded in " + ToString(image.m_decodeMilliseconds)
+                + " ms, uploaded in " + ToString(uploadMilliseconds) + " ms)");
+        }
+        else
+        {
+            Logger::Error("null texture with name = " + asset.m_name + " and filepath = " + asset.m_filePath + ": " + SDL_GetError());
+        }
     }
 
+    Logger::Log("AssetStore: " + std::to_string(texturesToLoad.size()) + " textures loaded in " + ToString(MillisecondsSince(loadStart)) + " ms (decoding "
+        + ToString(decodeMilliseconds) + " ms on " + std::to_string(numberOfThreads) + " threads, uploading " + ToString(MillisecondsSince(uploadStart)) + " ms), "
+        + std::to_string(textures.size() - texturesToLoad.size()) + " already loaded");
+    return handles;
+}
+
+void AssetStore::ReleaseTexture(const std::string& textureName)
+{
+    const auto texture = m_textures.find(textureName);
+    if (texture == m_textures.end())
+    {
+        return;
+    }
+
+    if (--texture->second.m_referenceCount <= 0)
+    {
+        SDL_DestroyTexture(texture->second.m_texture);
+        m_textures.erase(texture);
+        Logger::Log("texture removed from AssetStore with id= " + textureName);
+    }
 }
 
 SDL_Texture* AssetStore::GetTexture(const std::string& assetName) const
 {
-    return m_textures.at(assetName);
+    return m_textures.at(assetName).m_texture;
 }
 
-void AssetStore::AddFont(const std::string& fontName, const std::string& filePath, int fontSize)
+int AssetStore::ReloadTextures(SDL_Renderer* renderer, const std::string& filePath)
 {
-    m_fonts.emplace(fontName, TTF_OpenFont(filePath.c_str(), fontSize));
+    // "./assets/images/tank.png" and "assets/images/tank.png" are the same file
+    const std::filesystem::path changedFile = std::filesystem::path(filePath).lexically_normal();
+
+    int numberOfReloadedTextures = 0;
+    for (auto& texture : m_textures)
+    {
+        if (std::filesystem::path(texture.second.m_filePath).lexically_normal() != changedFile)
+        {
+            continue;
+        }
+
+        const auto reloadStart = Clock::now();
+        DecodedImage image = DecodeImage(m_archive, texture.second.m_filePath);
+        if (!image.m_warning.empty())
+        {
+            Logger::Error("AssetStore: " + image.m_warning);
+        }
+        std::size_t bytes = 0;
+        SDL_Texture* reloadedTexture = image.IsValid() ? CreateTexture(renderer, image, bytes) : nullptr;
+        if (!reloadedTexture)
+        {
+            Logger::Error("AssetStore: " + filePath + " could not be reloaded, the texture " + texture.first + " is kept: "
+                + (image.m_error.empty() ? SDL_GetError() : image.m_error));
+            continue;
+        }
+
+        SDL_DestroyTexture(texture.second.m_texture);
+        texture.second.m_texture = reloadedTexture;
+        texture.second.m_bytes = bytes;
+        numberOfReloadedTextures++;
+        Logger::Log("texture reloaded in AssetStore with id= " + texture.first + " (" + ToString(MillisecondsSince(reloadStart)) + " ms)");
+    }
+    return numberOfReloadedTextures;
+}
+
+AssetHandle AssetStore::AddFont(const std::string& fontName, const std::string& filePath, int fontSize)
+{
+    const auto existingFont = m_fonts.find(fontName);
+    const bool isLoaded = existingFont != m_fonts.end() && existingFont->second.m_filePath == filePath && existingFont->second.m_fontSize == fontSize;
+    if (!isLoaded)
+    {
+        // the font reads its file while it is used, from the archive that is the mapped memory
+        SDL_RWops* archiveFile = m_archive.OpenFile(filePath);
+        TTF_Font* font = archiveFile ? TTF_OpenFontRW(archiveFile, 1, fontSize) : TTF_OpenFont(filePath.c_str(), fontSize);
+        if (!font)
+        {
+            Logger::Error("null font with name = " + fontName + " and filepath = " + filePath);
+            return AssetHandle();
+        }
+
+        // the name is given to another file or size, the references are kept
+        Font& entry = m_fonts[fontName];
+        TTF_CloseFont(entry.m_font);
+        entry.m_font = font;
+        entry.m_filePath = filePath;
+        entry.m_fontSize = fontSize;
+        std::error_code error;
+        entry.m_bytes = archiveFile ? m_archive.Find(filePath).m_size : static_cast<std::size_t>(std::filesystem::file_size(filePath, error));
+    }
+
+    m_fonts[fontName].m_referenceCount++;
+    return MakeHandle(AssetHandle::AssetType::FONT, fontName);
+}
+
+void AssetStore::ReleaseFont(const std::string& fontName)
+{
+    const auto font = m_fonts.find(fontName);
+    if (font == m_fonts.end())
+    {
+        return;
+    }
+
+    if (--font->second.m_referenceCount <= 0)
+    {
+        TTF_CloseFont(font->second.m_font);
+        m_fonts.erase(font);
+        Logger::Log("font removed from AssetStore with id= " + fontName);
+    }
 }
 
 TTF_Font* AssetStore::GetFont(const std::string& fontName) 
 {
-    return m_fonts[fontName];
+    const auto font = m_fonts.find(fontName);
+    return font != m_fonts.end() ? font->second.m_font : nullptr;
+}
+
+int AssetStore::GetTextureReferenceCount(const std::string& textureName) const
+{
+    const auto texture = m_textures.find(textureName);
+    return texture != m_textures.end() ? texture->second.m_referenceCount : 0;
+}
+
+int AssetStore::GetFontReferenceCount(const std::string& fontName) const
+{
+    const auto font = m_fonts.find(fontName);
+    return font != m_fonts.end() ? font->second.m_referenceCount : 0;
+}
+
+AssetMemoryUsage AssetStore::GetMemoryUsage() const
+{
+    AssetMemoryUsage memoryUsage;
+    memoryUsage.m_numberOfTextures = m_textures.size();
+    for (const auto& texture : m_textures)
+    {
+        memoryUsage.m_textureBytes += texture.second.m_bytes;
+    }
+    memoryUsage.m_numberOfFonts = m_fonts.size();
+    for (const auto& font : m_fonts)
+    {
+        memoryUsage.m_fontBytes += font.second.m_bytes;
+    }
+    return memoryUsage;
+}
+
+void AssetStore::LogMemoryUsage() const
+{
+    const AssetMemoryUsage memoryUsage = GetMemoryUsage();
+    Logger::Log("AssetStore memory: " + std::to_string(memoryUsage.m_numberOfTextures) + " textures " + ToString(memoryUsage.m_textureBytes / 1024.) + " KB, "
+        + std::to_string(memoryUsage.m_numberOfFonts) + " fonts " + ToString(memoryUsage.m_fontBytes / 1024.) + " KB");
 }
 
 void AssetStore::ClearAssets()
 {
-    for (auto texture : m_textures)
+    for (auto& texture : m_textures)
     {
-        SDL_DestroyTexture(texture.second);
+        SDL_DestroyTexture(texture.second.m_texture);
     }
     m_textures.clear(); 
     
-    for (auto font : m_fonts)
+    for (auto& font : m_fonts)
     {
-        TTF_CloseFont(font.second);
+        TTF_CloseFont(font.second.m_font);
     }
     m_fonts.clear();
+
+    // a handle kept from before must not release the asset loaded again under its name
+    m_isAlive = std::make_shared<bool>(true);
+}
+
+bool AssetStore::AddTextureReference(const std::string& textureName, const std::string& filePath)
+{
+    const auto texture = m_textures.find(textureName);
+    if (texture == m_textures.end() || texture->second.m_filePath != filePath)
+    {
+        return false;
+    }
+
+    texture->second.m_referenceCount++;
+    return true;
 }
+
+void AssetStore::StoreTexture(const std::string& textureName, const std::string& filePath, SDL_Texture* texture, std::size_t bytes)
+{
+    // the name may have been given to another file, the references are kept
+    Texture& entry = m_textures[textureName];
+    SDL_DestroyTexture(entry.m_texture);
+    entry.m_texture = texture;
+    entry.m_filePath = filePath;
+    entry.m_bytes = bytes;
+    entry.m_referenceCount++;
+}
+
+AssetHandle AssetStore::MakeHandle(AssetHandle::AssetType assetType, const std::string& assetName)
+{
+    return AssetHandle(this, m_isAlive, assetType, assetName);
+}
\ No newline at end of file
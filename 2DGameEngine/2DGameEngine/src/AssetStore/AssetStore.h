@@ -1,27 +1,173 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include <SDL_ttf.h>
 
+#include "AssetArchive.h"
+
 struct SDL_Renderer;
 struct SDL_Texture;
 
+// a texture listed by a level, see AssetStore::AddTextures()
+struct TextureAsset
+{
+	std::string m_name;
+	std::string m_filePath;
+};
+
+// bytes of the pixels of the textures (as decoded, the GPU copy may be padded) and of the font files
+struct AssetMemoryUsage
+{
+	std::size_t m_numberOfTextures = 0;
+	std::size_t m_textureBytes = 0;
+	std::size_t m_numberOfFonts = 0;
+	std::size_t m_fontBytes = 0;
+};
+
+class AssetStore;
+
+// Returned by AssetStore::AddTexture() and AddFont(), it holds one reference to the asset: the asset stays loaded for as
+// long as one of its handles lives. It can be moved around and destroyed after the store
+class AssetHandle
+{
+public:
+	enum class AssetType { TEXTURE, FONT };
+
+	AssetHandle() = default;
+	AssetHandle(AssetStore* assetStore, std::weak_ptr<bool> isAssetStoreAlive, AssetType assetType, std::string assetName)
+		: m_assetStore(assetStore)
+		, m_isAssetStoreAlive(std::move(isAssetStoreAlive))
+		, m_assetType(assetType)
+		, m_assetName(std::move(assetName))
+	{
+	}
+
+	~AssetHandle()
+	{
+		Release();
+	}
+
+	AssetHandle(const AssetHandle&) = delete;
+	AssetHandle& operator=(const AssetHandle&) = delete;
+
+	AssetHandle(AssetHandle&& other) noexcept
+		: m_assetStore(other.m_assetStore)
+		, m_isAssetStoreAlive(std::move(other.m_isAssetStoreAlive))
+		, m_assetType(other.m_assetType)
+		, m_assetName(std::move(other.m_assetName))
+	{
+		other.m_assetStore = nullptr;
+	}
+
+	AssetHandle& operator=(AssetHandle&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Release();
+			m_assetStore = other.m_assetStore;
+			m_isAssetStoreAlive = std::move(other.m_isAssetStoreAlive);
+			m_assetType = other.m_assetType;
+			m_assetName = std::move(other.m_assetName);
+			other.m_assetStore = nullptr;
+		}
+		return *this;
+	}
+
+	void Release();
+	// false once released, and for the assets that could not be loaded
+	bool IsValid() const { return m_assetStore != nullptr && !m_isAssetStoreAlive.expired(); }
+	const std::string& GetAssetName() const { return m_assetName; }
+
+private:
+	AssetStore* m_assetStore = nullptr;
+	std::weak_ptr<bool> m_isAssetStoreAlive;
+	AssetType m_assetType = AssetType::TEXTURE;
+	std::string m_assetName;
+};
+
+// Every asset is reference counted: each Add...() of an asset returns a handle holding a reference, the asset is unloaded
+// when its last handle is destroyed. Adding an asset that is already loaded from the same file only takes a reference.
+// The assets are still found by their name (sprites and labels keep the names), the handles only decide how long they stay.
+// A level keeps the handles of its assets (see LevelLoader) until the next level took its own: the assets both levels use
+// are kept loaded, only the ones the new level adds are loaded and only the ones it does not use anymore are unloaded.
+// The files are read from the mounted archive when there is one and they are in it, from the disk otherwise.
+// An image converted to a raw texture (see RawTexture) is loaded from it as long as it is up to date, its pixels are
+// copied to the texture as they are instead of being decoded
 class AssetStore
 {
 public:
 	AssetStore();
 	~AssetStore();
 
-	void AddTexture(SDL_Renderer* renderer, const std::string& textureName, const std::string& filePath);
+	// false when the archive could not be opened, the assets are then read from the disk. Fonts read from the archive keep
+	// reading it, the archive is mounted once and stays mounted while the store lives
+	bool MountArchive(const std::string& archivePath);
+	bool HasArchive() const { return m_archive.IsOpen(); }
+	// for the files that are not textures nor fonts (tilemaps...), empty when no archive is mounted
+	const AssetArchive& GetArchive() const { return m_archive; }
+
+	// the handle is not valid when the texture could not be loaded
+	[[nodiscard]] AssetHandle AddTexture(SDL_Renderer* renderer, const std::string& textureName, const std::string& filePath);
+	// the images are decoded in parallel by worker threads, the textures are then created one after the other on the
+	// calling thread, which has to be the one using the renderer (see RenderThread). The times are logged per texture.
+	// One handle per texture that could be loaded
+	[[nodiscard]] std::vector<AssetHandle> AddTextures(SDL_Renderer* renderer, const std::vector<TextureAsset>& textures);
 	SDL_Texture* GetTexture(const std::string& assetName) const;
+	// the textures loaded from the file are created again from it, they keep their names and references. A file that cannot
+	// be loaded leaves them as they were. On the thread using the renderer, returns how many textures were reloaded
+	int ReloadTextures(SDL_Renderer* renderer, const std::string& filePath);
 
-	void AddFont(const std::string& fontName, const std::string& filePath, int fontSize);
+	// the handle is not valid when the font could not be loaded
+	[[nodiscard]] AssetHandle AddFont(const std::string& fontName, const std::string& filePath, int fontSize);
 	TTF_Font* GetFont(const std::string& fontName) ;
 
+	// 0 when the asset is not loaded
+	int GetTextureReferenceCount(const std::string& textureName) const;
+	int GetFontReferenceCount(const std::string& fontName) const;
+
+	AssetMemoryUsage GetMemoryUsage() const;
+	void LogMemoryUsage() const;
+
+	// unloads everything whatever the references, the handles given so far become empty
 	void ClearAssets();
 private:
-	std::map<std::string, SDL_Texture*> m_textures;
-	std::map<std::string, TTF_Font*> m_fonts;
+	friend class AssetHandle;
+
+	struct Texture
+	{
+		SDL_Texture* m_texture = nullptr;
+		std::string m_filePath;
+		std::size_t m_bytes = 0;
+		int m_referenceCount = 0;
+	};
+
+	struct Font
+	{
+		TTF_Font* m_font = nullptr;
+		std::string m_filePath;
+		int m_fontSize = 0;
+		std::size_t m_bytes = 0;
+		int m_referenceCount = 0;
+	};
+
+	// true when the texture is already loaded from this file, in which case it takes a reference
+	bool AddTextureReference(const std::string& textureName, const std::string& filePath);
+	void StoreTexture(const std::string& textureName, const std::string& filePath, SDL_Texture* texture, std::size_t bytes);
+	AssetHandle MakeHandle(AssetHandle::AssetType assetType, const std::string& assetName);
+
+	// by the handles only
+	void ReleaseTexture(const std::string& textureName);
+	void ReleaseFont(const std::string& fontName);
+
+	std::map<std::string, Texture> m_textures;
+	std::map<std::string, Font> m_fonts;
+
+	AssetArchive m_archive;
+
+	// watched by the handles, replaced by ClearAssets()
+	std::shared_ptr<bool> m_isAlive;
 };
 
@@ -0,0 +1,349 @@
+#include "pch.h"
+
+#include "RawTexture.h"
+
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+#include "Logger/Logger.h"
+#include "HelperFunctions.h"
+
+namespace
+{
+	const char MAGIC[4] = { '2', 'D', 'T', 'X' };
+	const std::uint32_t VERSION = 1;
+	const std::size_t HEADER_SIZE = 8 * sizeof(std::uint32_t);
+
+	// LZ4: a match is at least 4 bytes, the last match starts 12 bytes before the end at the latest and the last 5 bytes are literals
+	const std::size_t MIN_MATCH = 4;
+	const std::size_t MATCH_FIND_LIMIT = 12;
+	const std::size_t LAST_LITERALS = 5;
+	const std::size_t MAX_OFFSET = 65535;
+	const int HASH_BITS = 12;
+
+	std::uint32_t Read32(const unsigned char* data)
+	{
+		std::uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	void Write32(std::vector<unsigned char>& buffer, std::uint32_t value)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+		buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+	}
+
+	// 15 in the token, the rest as a run of 255 and what is left
+	void WriteLength(std::vector<unsigned char>& buffer, std::size_t length)
+	{
+		for (length -= 15; length >= 255; length -= 255)
+		{
+			buffer.push_back(255);
+		}
+		buffer.push_back(static_cast<unsigned char>(length));
+	}
+
+	bool ReadLength(const unsigned char* data, std::size_t size, std::size_t& position, std::size_t& length)
+	{
+		unsigned char byte;
+		do
+		{
+			if (position >= size)
+			{
+				return false;
+			}
+			byte = data[position++];
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+	void WriteSequence(std::vector<unsigned char>& buffer, const unsigned char* literals, std::size_t numberOfLiterals, std::size_t offset, std::size_t matchLength)
+	{
+		const std::size_t extraMatchLength = matchLength - MIN_MATCH;
+		buffer.push_back(static_cast<unsigned char>((std::min<std::size_t>(numberOfLiterals, 15) << 4) | std::min<std::size_t>(extraMatchLength, 15)));
+		if (numberOfLiterals >= 15)
+		{
+			WriteLength(buffer, numberOfLiterals);
+		}
+		buffer.insert(buffer.end(), literals, literals + numberOfLiterals);
+		buffer.push_back(static_cast<unsigned char>(offset & 0xFF));
+		buffer.push_back(static_cast<unsigned char>(offset >> 8));
+		if (extraMatchLength >= 15)
+		{
+			WriteLength(buffer, extraMatchLength);
+		}
+	}
+}
+
+std::string RawTexture::GetRawPath(const std::string& imagePath)
+{
+	return std::filesystem::path(imagePath).replace_extension(CONST::RAW_TEXTURES::EXTENSION).generic_string();
+}
+
+bool RawTexture::IsRawPath(const std::string& filePath)
+{
+	return std::filesystem::path(filePath).extension() == CONST::RAW_TEXTURES::EXTENSION;
+}
+
+bool RawTexture::IsUpToDate(const std::string& imagePath)
+{
+	std::error_code error;
+	const auto rawTime = std::filesystem::last_write_time(GetRawPath(imagePath), error);
+	if (error)
+	{
+		return false;
+	}
+	const auto imageTime = std::filesystem::last_write_time(imagePath, error);
+	return error || rawTime >= imageTime;
+}
+
+std::vector<unsigned char> RawTexture::Encode(SDL_Surface* surface, Uint32 pixelFormat, Compression compression)
+{
+	SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, pixelFormat, 0);
+	if (!converted)
+	{
+		return std::vector<unsigned char>();
+	}
+
+	SDL_LockSurface(converted);
+	const unsigned char* pixels = static_cast<const unsigned char*>(converted->pixels);
+	const std::size_t size = static_cast<std::size_t>(converted->pitch) * converted->h;
+	std::vector<unsigned char> compressedPixels;
+	if (compression == Compression::LZ4)
+	{
+		compressedPixels = CompressLz4(pixels, size);
+		// noise does not compress
+		compression = compressedPixels.size() < size ? Compression::LZ4 : Compression::NONE;
+	}
+
+	std::vector<unsigned char> data(MAGIC, MAGIC + sizeof(MAGIC));
+	Write32(data, VERSION);
+	Write32(data, pixelFormat);
+	Write32(data, static_cast<std::uint32_t>(converted->w));
+	Write32(data, static_cast<std::uint32_t>(converted->h));
+	Write32(data, static_cast<std::uint32_t>(converted->pitch));
+	Write32(data, static_cast<std::uint32_t>(compression));
+	if (compression == Compression::LZ4)
+	{
+		Write32(data, static_cast<std::uint32_t>(compressedPixels.size()));
+		data.insert(data.end(), compressedPixels.begin(), compressedPixels.end());
+	}
+	else
+	{
+		Write32(data, static_cast<std::uint32_t>(size));
+		data.insert(data.end(), pixels, pixels + size);
+	}
+	SDL_UnlockSurface(converted);
+	SDL_FreeSurface(converted);
+	return data;
+}
+
+bool RawTexture::Decode(const unsigned char* data, std::size_t size, Image& image, std::string& error)
+{
+	if (size < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || Read32(data + 4) != VERSION)
+	{
+		error = "not a raw texture of version " + std::to_string(VERSION);
+		return false;
+	}
+
+	const Uint32 pixelFormat = Read32(data + 8);
+	const std::uint64_t width = Read32(data + 12);
+	const std::uint64_t height = Read32(data + 16);
+	const std::uint64_t pitch = Read32(data + 20);
+	const Compression compression = static_cast<Compression>(Read32(data + 24));
+	const std::size_t storedSize = Read32(data + 28);
+	const unsigned char* storedPixels = data + HEADER_SIZE;
+
+	// checked before anything is allocated from the header, in 64 bits so that nothing wraps around.
+	// FOURCC formats (YUV...) have no bytes per pixel, a pitch check would let them through. SDL pads the rows to 4 bytes
+	const std::uint64_t bytesPerPixel = SDL_ISPIXELFORMAT_FOURCC(pixelFormat) ? 0 : SDL_BYTESPERPIXEL(pixelFormat);
+	if (bytesPerPixel == 0 || width == 0 || height == 0 || width > CONST::RAW_TEXTURES::MAX_DIMENSION || height > CONST::RAW_TEXTURES::MAX_DIMENSION
+		|| pitch < width * bytesPerPixel || pitch > (width * bytesPerPixel + 3) / 4 * 4 || storedSize > size - HEADER_SIZE)
+	{
+		error = "truncated or corrupted raw texture";
+		return false;
+	}
+	const std::size_t pixelsSize = static_cast<std::size_t>(pitch * height);
+
+	image.m_pixelFormat = pixelFormat;
+	image.m_width = static_cast<int>(width);
+	image.m_height = static_cast<int>(height);
+	image.m_pitch = static_cast<int>(pitch);
+
+	if (compression == Compression::NONE && storedSize == pixelsSize)
+	{
+		image.m_pixels = storedPixels;
+		return true;
+	}
+	// a byte of LZ4 is never more than 255 bytes once decompressed
+	if (compression == Compression::LZ4 && pixelsSize / 255 <= storedSize)
+	{
+		// decompressed aside, the compressed pixels can be in the storage (see Load())
+		std::vector<unsigned char> pixels(pixelsSize);
+		if (DecompressLz4(storedPixels, storedSize, pixels.data(), pixels.size()))
+		{
+			image.m_storage = std::move(pixels);
+			image.m_pixels = image.m_storage.data();
+			return true;
+		}
+	}
+	error = "corrupted raw texture pixels";
+	return false;
+}
+
+bool RawTexture::Load(const std::string& filePath, Image& image, std::string& error)
+{
+	// one read of the whole file, the pixels are not parsed
+	if (!Helpers::ReadFile(filePath, image.m_storage))
+	{
+		error = "could not open " + filePath;
+		return false;
+	}
+	// the uncompressed pixels point into the storage, which is replaced by the decompressed ones otherwise
+	return Decode(image.m_storage.data(), image.m_storage.size(), image, error);
+}
+
+int RawTexture::ConvertDirectory(const std::string& imagesDirectory, Uint32 pixelFormat, Compression compression)
+{
+	int numberOfErrors = 0;
+
+	IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(imagesDirectory, error))
+	{
+		if (!entry.is_regular_file() || (entry.path().extension() != ".png" && entry.path().extension() != ".jpg"))
+		{
+			continue;
+		}
+
+		const std::string imagePath = entry.path().generic_string();
+		SDL_Surface* surface = IMG_Load(imagePath.c_str());
+		const std::vector<unsigned char> data = surface ? Encode(surface, pixelFormat, compression) : std::vector<unsigned char>();
+		SDL_FreeSurface(surface);
+		if (data.empty())
+		{
+			Logger::Error("RawTexture: could not convert " + imagePath + ": " + SDL_GetError());
+			numberOfErrors++;
+			continue;
+		}
+
+		const std::string rawPath = GetRawPath(imagePath);
+		std::ofstream file(rawPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		if (!file)
+		{
+			Logger::Error("RawTexture: could not write " + rawPath);
+			numberOfErrors++;
+			continue;
+		}
+		Logger::Log("RawTexture: converted " + imagePath + " (" + std::to_string(entry.file_size() / 1024) + " KB) to "
+			+ rawPath + " (" + std::to_string(data.size() / 1024) + " KB)");
+	}
+
+	if (error)
+	{
+		Logger::Error("RawTexture: could not read " + imagesDirectory + ": " + error.message());
+		numberOfErrors++;
+	}
+	return numberOfErrors;
+}
+
+std::vector<unsigned char> RawTexture::CompressLz4(const unsigned char* data, std::size_t size)
+{
+	std::vector<unsigned char> compressedData;
+	compressedData.reserve(size / 2 + 16);
+
+	// greedy: the last position of each hash of 4 bytes is the only candidate
+	std::vector<std::size_t> lastPositions(std::size_t(1) << HASH_BITS, SIZE_MAX);
+	std::size_t anchor = 0;
+	std::size_t position = 0;
+	while (size >= MATCH_FIND_LIMIT && position <= size - MATCH_FIND_LIMIT)
+	{
+		const std::uint32_t sequence = Read32(data + position);
+		const std::size_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+		const std::size_t candidate = lastPositions[hash];
+		lastPositions[hash] = position;
+		if (candidate == SIZE_MAX || position - candidate > MAX_OFFSET || Read32(data + candidate) != sequence)
+		{
+			position++;
+			continue;
+		}
+
+		std::size_t matchLength = MIN_MATCH;
+		while (position + matchLength < size - LAST_LITERALS && data[candidate + matchLength] == data[position + matchLength])
+		{
+			matchLength++;
+		}
+		WriteSequence(compressedData, data + anchor, position - anchor, position - candidate, matchLength);
+		position += matchLength;
+		anchor = position;
+	}
+
+	// the last sequence only has literals
+	const std::size_t numberOfLiterals = size - anchor;
+	compressedData.push_back(static_cast<unsigned char>(std::min<std::size_t>(numberOfLiterals, 15) << 4));
+	if (numberOfLiterals >= 15)
+	{
+		WriteLength(compressedData, numberOfLiterals);
+	}
+	compressedData.insert(compressedData.end(), data + anchor, data + size);
+	return compressedData;
+}
+
+bool RawTexture::DecompressLz4(const unsigned char* compressedData, std::size_t compressedSize, unsigned char* data, std::size_t size)
+{
+	std::size_t input = 0;
+	std::size_t output = 0;
+	while (input < compressedSize)
+	{
+		const unsigned char token = compressedData[input++];
+
+		std::size_t numberOfLiterals = token >> 4;
+		if (numberOfLiterals == 15 && !ReadLength(compressedData, compressedSize, input, numberOfLiterals))
+		{
+			return false;
+		}
+		if (numberOfLiterals > compressedSize - input || numberOfLiterals > size - output)
+		{
+			return false;
+		}
+		std::memcpy(data + output, compressedData + input, numberOfLiterals);
+		input += numberOfLiterals;
+		output += numberOfLiterals;
+		if (input == compressedSize)
+		{
+			break;
+		}
+
+		if (compressedSize - input < 2)
+		{
+			return false;
+		}
+		const std::size_t offset = compressedData[input] | (compressedData[input + 1] << 8);
+		input += 2;
+		std::size_t matchLength = token & 15;
+		if (offset == 0 || offset > output || (matchLength == 15 && !ReadLength(compressedData, compressedSize, input, matchLength)))
+		{
+			return false;
+		}
+		matchLength += MIN_MATCH;
+		if (matchLength > size - output)
+		{
+			return false;
+		}
+		// the match can overlap what it writes (a run of a repeated pixel has an offset of 4): it repeats the first
+		// 'offset' bytes, which are copied in chunks that double as the copied part grows and never overlap
+		const unsigned char* match = data + output - offset;
+		for (std::size_t copied = 0; copied < matchLength;)
+		{
+			const std::size_t chunk = std::min(matchLength - copied, offset + copied);
+			std::memcpy(data + output + copied, match, chunk);
+			copied += chunk;
+		}
+		output += matchLength;
+	}
+	return output == size;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <SDL.h>
+
+namespace CONST
+{
+	namespace RAW_TEXTURES
+	{
+		// "./assets/images/tank.png" is converted to "./assets/images/tank.rtex"
+		const std::string EXTENSION = ".rtex";
+		const std::string IMAGES_DIRECTORY = "./assets/images/";
+		// the format the Direct3D and OpenGL renderers create their textures with, uploading it is a plain copy
+		const Uint32 PIXEL_FORMAT = SDL_PIXELFORMAT_ARGB8888;
+		// larger than any texture the renderers accept, a header above it is corrupted
+		constexpr std::uint32_t MAX_DIMENSION = 16384;
+	}
+}
+
+// Textures stored as the pixels the renderer uploads, written offline by '2DGameEngine --convert-textures' so that
+// loading a level does not decode PNGs. The pixels can be LZ4 compressed (block format), decompressing them is still
+// several times faster than inflating a PNG and the files stay about as small.
+// Layout (little endian): "2DTX", version, pixel format (SDL_PIXELFORMAT_...), width, height, pitch,
+// compression, size of the stored pixels (8 x uint32, 32 bytes: the pixels stay 16 bytes aligned in the archive)
+namespace RawTexture
+{
+	enum class Compression : std::uint32_t
+	{
+		NONE = 0,
+		LZ4 = 1,
+	};
+
+	struct Image
+	{
+		Uint32 m_pixelFormat = SDL_PIXELFORMAT_UNKNOWN;
+		int m_width = 0;
+		int m_height = 0;
+		int m_pitch = 0;
+		// m_pitch * m_height bytes, pointing into m_storage or into the memory given to Decode()
+		const unsigned char* m_pixels = nullptr;
+		std::vector<unsigned char> m_storage;
+	};
+
+	// "<image path without its extension>.rtex"
+	std::string GetRawPath(const std::string& imagePath);
+	bool IsRawPath(const std::string& filePath);
+	// whether the image has a raw texture that is not older than it. True for a raw texture whose image is gone
+	bool IsUpToDate(const std::string& imagePath);
+
+	// the surface converted to pixelFormat, compressed when asked to and when that makes it smaller
+	std::vector<unsigned char> Encode(SDL_Surface* surface, Uint32 pixelFormat, Compression compression);
+
+	// false (with the reason in 'error') when the data is not a valid raw texture. The uncompressed pixels are not copied,
+	// the data has to outlive the image
+	bool Decode(const unsigned char* data, std::size_t size, Image& image, std::string& error);
+	// same, reading the file
+	bool Load(const std::string& filePath, Image& image, std::string& error);
+
+	// converts every .png and .jpg of the directory, returns how many of them could not be converted
+	int ConvertDirectory(const std::string& imagesDirectory, Uint32 pixelFormat, Compression compression);
+
+	// LZ4 block format, without the frame. DecompressLz4 fails on any block that does not decompress to exactly
+	// 'size' bytes
+	std::vector<unsigned char> CompressLz4(const unsigned char* data, std::size_t size);
+	bool DecompressLz4(const unsigned char* compressedData, std::size_t compressedSize, unsigned char* data, std::size_t size);
+}
@@ -2,12 +2,17 @@
 
 #include <sol/sol.hpp>
 
+// any function can be nil, see ScriptSystem for how batch scripts and behaviours are called
 struct ScriptComponent
 {
 	sol::function m_scriptFunction;
+	sol::function m_batchScriptFunction;
+	sol::function m_behaviourFunction;
 
-	ScriptComponent(sol::function scriptFunction = sol::lua_nil)
+	ScriptComponent(sol::function scriptFunction = sol::lua_nil, sol::function batchScriptFunction = sol::lua_nil, sol::function behaviourFunction = sol::lua_nil)
 		:m_scriptFunction(scriptFunction)
+		, m_batchScriptFunction(batchScriptFunction)
+		, m_behaviourFunction(behaviourFunction)
 	{
 	}
 };
\ No newline at end of file
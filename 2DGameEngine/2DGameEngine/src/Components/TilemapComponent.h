@@ -0,0 +1,16 @@
+#pragma once
+
+#include <memory>
+
+#include "Tilemap/Tilemap.h"
+
+// the tilemap of a level, its tiles are streamed around the camera by TilemapStreamingSystem
+struct TilemapComponent
+{
+	std::shared_ptr<Tilemap> m_tilemap;
+
+	TilemapComponent(std::shared_ptr<Tilemap> tilemap = nullptr)
+		: m_tilemap(tilemap)
+	{
+	}
+};
@@ -76,6 +76,15 @@ void System::RemoveEntity(Entity entityToRemove)
 		m_entities.end());
 }
 
+void System::AddEntities(const std::vector<Entity>& entitiesToAdd)
+{
+	m_entities.reserve(m_entities.size() + entitiesToAdd.size());
+	for (const auto& entity : entitiesToAdd)
+	{
+		AddEntity(entity);
+	}
+}
+
  std::vector<Entity>& System::GetSystemEntities()
 {
 	return m_entities;
@@ -106,6 +115,7 @@ Entity Registry::CreateEntity()
 		if (entityComponentSignatureNotBigEnough)
 		{
 			m_entityComponentSignatures.resize(entityId + 1);
+			m_entityGenerations.resize(entityId + 1);
 		}
 	}
 
@@ -124,6 +134,39 @@ void Registry::DestroyEntity(Entity& entityToDestroy)
 	m_entitiesToDestroy.insert(entityToDestroy);
 }
 
+std::uint32_t Registry::GetGeneration(Entity entity) const
+{
+	return m_entityGenerations.at(entity.GetId());
+}
+
+std::vector<Entity> Registry::Instantiate(const Prefab& prefab, std::size_t numberOfEntities)
+{
+	std::vector<Entity> instances;
+	instances.reserve(numberOfEntities);
+	for (std::size_t i = 0; i < numberOfEntities; i++)
+	{
+		instances.push_back(CreateEntity());
+	}
+
+	for (const auto& component : prefab.GetComponents())
+	{
+		if (component)
+		{
+			component->AddToEntities(*this, instances);
+		}
+	}
+
+	if (!prefab.GetGroup().empty())
+	{
+		for (const auto& instance : instances)
+		{
+			GroupEntity(instance, prefab.GetGroup());
+		}
+	}
+
+	return instances;
+}
+
 void Registry::AddEntityToSystems(Entity entityToAdd)
 {
 	const auto entityToAddId = entityToAdd.GetId();
@@ -139,6 +182,19 @@ void Registry::AddEntityToSystems(Entity entityToAdd)
 	}
 }
 
+void Registry::AddEntitiesToSystems(const Signature& entitiesComponentSignature, const std::vector<Entity>& entitiesToAdd)
+{
+	for (auto& system : m_systems)
+	{
+		const auto& systemComponentSignature = system.second->GetComponentSignature();
+		const bool entitiesHaveSystemRequirements = (entitiesComponentSignature & systemComponentSignature) == systemComponentSignature;
+		if (entitiesHaveSystemRequirements)
+		{
+			system.second->AddEntities(entitiesToAdd);
+		}
+	}
+}
+
 void Registry::RemoveEntityFromSystems(Entity entityToRemove)
 {
 	for (auto& system : m_systems)
@@ -227,13 +283,28 @@ void  Registry::RemoveEntityFromGroup(Entity entity)
 
 void Registry::Update()
 {
-	// add new entities
+	// add new entities, the ones with the same components (the instances of a prefab) are matched with the systems together
 	for (auto& entity : m_entitiesToAdd)
 	{
-		AddEntityToSystems(entity);
+		const Signature& signature = m_entityComponentSignatures.at(entity.GetId());
+		const auto signatureIndex = m_signatureIndices.emplace(signature, m_entitiesToAddPerSignature.size());
+		if (signatureIndex.second)
+		{
+			m_entitiesToAddPerSignature.emplace_back(signature, std::vector<Entity>());
+		}
+		m_entitiesToAddPerSignature[signatureIndex.first->second].second.push_back(entity);
 	}
 	m_entitiesToAdd.clear();
 
+	for (auto& entitiesWithSignature : m_entitiesToAddPerSignature)
+	{
+		if (!entitiesWithSignature.second.empty())
+		{
+			AddEntitiesToSystems(entitiesWithSignature.first, entitiesWithSignature.second);
+			entitiesWithSignature.second.clear();
+		}
+	}
+
 	// destroy entities
 	for (auto& entity : m_entitiesToDestroy)
 	{
@@ -252,6 +323,7 @@ void Registry::Update()
 
 		// make the entity id available to be reused
 		m_freeIds.push_back(entity.GetId());
+		m_entityGenerations[entity.GetId()]++;
 
 		RemoveEntityTag(entity);
 		RemoveEntityFromGroup(entity);
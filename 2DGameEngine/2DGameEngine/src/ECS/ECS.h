@@ -7,6 +7,8 @@
 #include <set>
 #include <memory>
 #include <deque>
+#include <cstdint>
+#include <algorithm>
 #include <unordered_map>
 
 #include "Logger/Logger.h"
@@ -81,10 +83,14 @@ class System
 {
 public:
 	System() = default;
-	~System() = default;
+	virtual ~System() = default;
 
-	void AddEntity(Entity entityToAdd);
-	void RemoveEntity(Entity entityToRemove);
+	// virtual so that systems can keep their own acceleration structures in sync (e.g. RenderSystem)
+	virtual void AddEntity(Entity entityToAdd);
+	virtual void RemoveEntity(Entity entityToRemove);
+
+	// entities with the same components, matched with the system once
+	void AddEntities(const std::vector<Entity>& entitiesToAdd);
 
 	std::vector<Entity>& GetSystemEntities();
 	const Signature& GetComponentSignature() const;
@@ -129,6 +135,18 @@ public:
 
 	void Add(T objectToAdd) { m_data.push_back(objectToAdd); }
 
+	// room for 'numberOfObjects' more objects, without growing the vector or rehashing the maps while they are set
+	void Reserve(std::size_t numberOfObjects)
+	{
+		const std::size_t size = m_size + numberOfObjects;
+		if (size > m_data.size())
+		{
+			m_data.resize(size);
+		}
+		m_entityIdToIndex.reserve(size);
+		m_indexToEntityId.reserve(size);
+	}
+
 	void Set(std::size_t entityId, T objectToSet)
 	{
 		const bool entityAlreadyExists = m_entityIdToIndex.find(entityId) != m_entityIdToIndex.end();
@@ -142,9 +160,9 @@ public:
 			int index = m_size;
 			m_entityIdToIndex.emplace(entityId, index);
 			m_indexToEntityId.emplace(index, entityId);
-			if (index >= m_data.capacity())
+			if (index >= m_data.size())
 			{
-				m_data.resize(m_size * 2);
+				m_data.resize(std::max<std::size_t>(m_size * 2, 1));
 			}
 			m_data.at(index) = objectToSet;
 			m_size++;
@@ -193,6 +211,59 @@ private:
 	std::unordered_map<int, int> m_indexToEntityId;
 };
 
+// a component of a prefab, its value is copied to the entities created from the prefab
+class IPrefabComponent
+{
+public:
+	virtual ~IPrefabComponent() = default;
+	virtual void AddToEntities(class Registry& registry, const std::vector<Entity>& entities) const = 0;
+};
+
+template <typename T>
+class PrefabComponent : public IPrefabComponent
+{
+public:
+	template <typename ...TArgs>
+	PrefabComponent(TArgs&& ...args)
+		: m_component(std::forward<TArgs>(args)...)
+	{
+	}
+
+	void AddToEntities(Registry& registry, const std::vector<Entity>& entities) const override;
+
+	T m_component;
+};
+
+// template of entities that share their components (the trees of a level, the projectiles of an emitter).
+// The components are built once, Registry::Instantiate creates the entities with copies of them
+class Prefab
+{
+public:
+	Prefab() = default;
+
+	// same arguments as Entity::AddComponent, adding a component the prefab has replaces it
+	template <typename TComponent, typename ...TArgs>
+	void AddComponent(TArgs&& ...args);
+	template <typename TComponent>
+	void RemoveComponent();
+	template <typename TComponent>
+	bool HasComponent() const;
+	template <typename TComponent>
+	TComponent& GetComponent() const;
+
+	void Group(const std::string& group) { m_group = group; }
+	const std::string& GetGroup() const { return m_group; }
+
+	const Signature& GetSignature() const { return m_signature; }
+	const std::vector<std::unique_ptr<IPrefabComponent>>& GetComponents() const { return m_components; }
+private:
+	Signature m_signature;
+	std::string m_group;
+
+	// [ vector index = component type id ]
+	std::vector<std::unique_ptr<IPrefabComponent>> m_components;
+};
+
 // manages creation and destruction of entities, add systems,
 // and components
 class Registry
@@ -203,6 +274,9 @@ public:
 	// ENTITY MANAGEMENT
 	Entity CreateEntity();
 	void DestroyEntity(Entity& entityToDestroy);
+	// increased each time an entity with this id is destroyed. The ids are reused, an Entity kept aside is still the
+	// entity it was created as while the generation of its id is the one it had then
+	std::uint32_t GetGeneration(Entity entity) const;
 
 	// COMPONENT MANAGEMENT
 	template <typename TComponent, typename ...TArgs>
@@ -217,6 +291,19 @@ public:
 	template <typename TComponent>
 	TComponent& GetComponent(Entity entity) const;
 
+	// sizes the pool once before adding many components of the type (a level, a batch of entities)
+	template <typename TComponent>
+	void ReserveComponents(std::size_t numberOfComponents);
+
+	// adds a copy of the component to each of the entities, the pool is sized once for all of them
+	template <typename TComponent>
+	void AddComponentToEntities(const std::vector<Entity>& entities, const TComponent& component);
+
+	// PREFABS
+	// creates 'numberOfEntities' entities with copies of the prefab's components (and its group).
+	// Like CreateEntity, they are added to the systems at the next Update
+	std::vector<Entity> Instantiate(const Prefab& prefab, std::size_t numberOfEntities = 1);
+
 	// SYSTEM MANAGEMENT
 	template <typename TSystem, typename ...TArgs>
 	void AddSystem(TArgs&& ...args);
@@ -231,6 +318,7 @@ public:
 	TSystem& GetSystem() const;
 
 	void AddEntityToSystems(Entity entityToAdd);
+	void AddEntitiesToSystems(const Signature& entitiesComponentSignature, const std::vector<Entity>& entitiesToAdd);
 	void RemoveEntityFromSystems(Entity entityToAdd);
 
 	// TAG MANAGEMENT
@@ -248,18 +336,28 @@ public:
 	void Update();
 
 private:
+	template <typename TComponent>
+	std::shared_ptr<Pool<TComponent>> GetOrCreatePool();
+
 	std::size_t m_numEntities = 0;
 
 	// stores the component's signature for each entity.
 	// this informs us of which components each entity has
 	// [ vector index = entity id ]
 	std::vector<Signature> m_entityComponentSignatures;
+	// [ vector index = entity id ]
+	std::vector<std::uint32_t> m_entityGenerations;
 
 	// these sets serve as temp Entity holder so that  they are removed/added at the end 
 	// of the frame rather than at any random time during the frame
 	std::set<Entity> m_entitiesToAdd;
 	std::set<Entity> m_entitiesToDestroy;
 
+	// the entities to add grouped by their signature at Update, so that each group is matched with the systems once.
+	// Kept between updates to reuse the vectors
+	std::unordered_map<Signature, std::size_t> m_signatureIndices;
+	std::vector<std::pair<Signature, std::vector<Entity>>> m_entitiesToAddPerSignature;
+
 	// entity tags (one tag per entity)
 	std::unordered_map<std::string, Entity> m_entityPerTag;
 	std::unordered_map<std::size_t, std::string> m_tagPerEntity;
@@ -307,6 +405,51 @@ TComponent& Entity::GetComponent() const
 }
 
 
+// ------------------------------------ PREFAB TEMPLATE FUNCTIONS-----------------
+
+template <typename T>
+void PrefabComponent<T>::AddToEntities(Registry& registry, const std::vector<Entity>& entities) const
+{
+	registry.AddComponentToEntities<T>(entities, m_component);
+}
+
+template <typename TComponent, typename ...TArgs>
+void Prefab::AddComponent(TArgs&& ...args)
+{
+	const auto componentId = Component<TComponent>::GetId();
+	if (m_components.size() <= componentId)
+	{
+		m_components.resize(componentId + 1);
+	}
+	m_components[componentId] = std::make_unique<PrefabComponent<TComponent>>(std::forward<TArgs>(args)...);
+	m_signature.set(componentId);
+}
+
+template <typename TComponent>
+void Prefab::RemoveComponent()
+{
+	const auto componentId = Component<TComponent>::GetId();
+	if (m_components.size() > componentId)
+	{
+		m_components[componentId].reset();
+	}
+	m_signature.set(componentId, false);
+}
+
+template <typename TComponent>
+bool Prefab::HasComponent() const
+{
+	return m_signature.test(Component<TComponent>::GetId());
+}
+
+template <typename TComponent>
+TComponent& Prefab::GetComponent() const
+{
+	const auto componentId = Component<TComponent>::GetId();
+	return static_cast<PrefabComponent<TComponent>&>(*m_components.at(componentId)).m_component;
+}
+
+
 // ------------------------------------ SYSTEM TEMPLATE FUNCTIONS-----------------
 
 template <typename TComponent>
@@ -325,6 +468,42 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args)
 	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
 
+	std::shared_ptr<Pool<TComponent>> componentToAddPool = GetOrCreatePool<TComponent>();
+
+	TComponent componentToAdd(std::forward<TArgs>(args)...);
+	componentToAddPool->Set(entityId, componentToAdd);
+
+	// update the entity's signature to have the added component
+	m_entityComponentSignatures.at(entityId).set(componentId);
+
+	//Logger::Log("Component id = " + std::to_string(componentId) + " was added to entity id = " + std::to_string(entityId));
+}
+
+template <typename TComponent>
+void Registry::ReserveComponents(std::size_t numberOfComponents)
+{
+	GetOrCreatePool<TComponent>()->Reserve(numberOfComponents);
+}
+
+template <typename TComponent>
+void Registry::AddComponentToEntities(const std::vector<Entity>& entities, const TComponent& component)
+{
+	const auto componentId = Component<TComponent>::GetId();
+
+	std::shared_ptr<Pool<TComponent>> componentToAddPool = GetOrCreatePool<TComponent>();
+	componentToAddPool->Reserve(entities.size());
+	for (const auto& entity : entities)
+	{
+		componentToAddPool->Set(entity.GetId(), component);
+		m_entityComponentSignatures.at(entity.GetId()).set(componentId);
+	}
+}
+
+template <typename TComponent>
+std::shared_ptr<Pool<TComponent>> Registry::GetOrCreatePool()
+{
+	const auto componentId = Component<TComponent>::GetId();
+
 	// check if the component already exists in the componentPool
 	// resize the componentPool if it does not
 	const bool componentAlreadyExists = m_componentPools.size() > componentId;
@@ -339,16 +518,7 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args)
 		m_componentPools.at(componentId) = newComponentPool;
 	}
 
-	std::shared_ptr<Pool<TComponent>> componentToAddPool = std::static_pointer_cast<Pool<TComponent>>(m_componentPools.at(componentId));
-	// check if the pool is sized large enough to fit the new component
-
-	TComponent componentToAdd(std::forward<TArgs>(args)...);
-	componentToAddPool->Set(entityId, componentToAdd);
-
-	// update the entity's signature to have the added component
-	m_entityComponentSignatures.at(entityId).set(componentId);
-
-	//Logger::Log("Component id = " + std::to_string(componentId) + " was added to entity id = " + std::to_string(entityId));
+	return std::static_pointer_cast<Pool<TComponent>>(m_componentPools.at(componentId));
 }
 
 template<typename TComponent>
@@ -0,0 +1,53 @@
+#include "pch.h"
+
+#include "EventArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+EventArena::EventArena(std::size_t blockSize)
+	: m_blockSize(blockSize)
+{
+}
+
+void* EventArena::Allocate(std::size_t size, std::size_t alignment)
+{
+	// look for room from the current block on, blocks too small for this allocation are skipped
+	for (; m_currentBlock < m_blocks.size(); m_currentBlock++, m_offsetInCurrentBlock = 0)
+	{
+		auto& block = m_blocks[m_currentBlock];
+		const std::uintptr_t blockStart = reinterpret_cast<std::uintptr_t>(block.m_memory.get());
+		const std::uintptr_t alignedAddress = (blockStart + m_offsetInCurrentBlock + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+		const std::size_t alignedOffset = alignedAddress - blockStart;
+
+		if (alignedOffset + size <= block.m_size)
+		{
+			m_offsetInCurrentBlock = alignedOffset + size;
+			return block.m_memory.get() + alignedOffset;
+		}
+	}
+
+	// new[] memory is aligned for any fundamental type, bigger payloads get a block of their own
+	const std::size_t newBlockSize = std::max(m_blockSize, size + alignment);
+	m_blocks.push_back(Block{ std::make_unique<unsigned char[]>(newBlockSize), newBlockSize });
+	m_currentBlock = m_blocks.size() - 1;
+	m_offsetInCurrentBlock = 0;
+
+	return Allocate(size, alignment);
+}
+
+void EventArena::Reset()
+{
+	m_currentBlock = 0;
+	m_offsetInCurrentBlock = 0;
+}
+
+std::size_t EventArena::GetNumberOfBytesUsed() const
+{
+	std::size_t numberOfBytesUsed = 0;
+	for (std::size_t i = 0; i < m_currentBlock && i < m_blocks.size(); i++)
+	{
+		numberOfBytesUsed += m_blocks[i].m_size;
+	}
+	return numberOfBytesUsed + m_offsetInCurrentBlock;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <type_traits>
+
+#include "EventSpan.h"
+
+namespace CONST
+{
+	namespace EVENTS
+	{
+		constexpr std::size_t ARENA_BLOCK_SIZE = 64 * 1024;
+	}
+}
+
+// Bump allocator for event payloads too big to live in the event itself (lists of entities, paths...).
+// The event keeps an EventSpan into the arena instead of owning a vector, so building, queueing and
+// delivering it does not allocate. Nothing is freed one by one: Reset() makes all the memory available
+// again and the blocks are kept for the next frame.
+// Only trivially copyable data can be stored, destructors are never called
+class EventArena
+{
+public:
+	EventArena(std::size_t blockSize = CONST::EVENTS::ARENA_BLOCK_SIZE);
+
+	void* Allocate(std::size_t size, std::size_t alignment);
+
+	template <typename T>
+	EventSpan<T> Copy(const T* data, std::size_t count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "EventArena only stores trivially copyable data");
+
+		if (count == 0)
+		{
+			return EventSpan<T>(nullptr, 0);
+		}
+
+		T* copy = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		std::memcpy(copy, data, sizeof(T) * count);
+		return EventSpan<T>(copy, count);
+	}
+
+	// everything allocated so far becomes invalid
+	void Reset();
+
+	std::size_t GetNumberOfBlocks() const { return m_blocks.size(); }
+	std::size_t GetNumberOfBytesUsed() const;
+private:
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> m_memory;
+		std::size_t m_size;
+	};
+
+	std::size_t m_blockSize;
+	std::vector<Block> m_blocks;
+	// allocations are taken from this block, the ones before it are full
+	std::size_t m_currentBlock = 0;
+	std::size_t m_offsetInCurrentBlock = 0;
+};
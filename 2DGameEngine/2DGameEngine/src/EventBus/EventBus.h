@@ -1,58 +1,276 @@
 #pragma once
 
-#include <map>
-#include <list>
-#include <typeindex>
-#include <functional>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
 
 #include "Logger/Logger.h"
 #include "Event.h"
+#include "EventSpan.h"
+#include "EventArena.h"
 
-// needs to exist because we can't have a unique_ptr of template types
-class IEventCallback
+struct IEventType
+{
+protected:
+	// atomic because the first use of an event type may happen on a producer thread
+	inline static std::atomic<std::size_t> m_nextId{ 0 };
+};
+
+// used to assign a unique id to an event type, the ids are dense so they can index the bus' handler arrays
+template <typename TEvent>
+class EventType : public IEventType
 {
 public:
-	virtual ~IEventCallback() = default;
+	static std::size_t GetId()
+	{
+		static auto id = m_nextId++;
+		return id;
+	}
+};
 
-	void Execute(Event& eventToExecute)
+// An object pointer and a plain function pointer, no heap and no virtual call.
+// The member function is baked into the stub when subscribing so the delegate stays two pointers
+struct EventDelegate
+{
+	typedef void (*StubFunction)(void* ownerInstance, const Event& eventToCall);
+
+	void* m_ownerInstance = nullptr;
+	StubFunction m_stubFunction = nullptr;
+
+	void operator()(const Event& eventToCall) const
 	{
-		Call(eventToExecute);
+		m_stubFunction(m_ownerInstance, eventToCall);
 	}
+};
 
-private:
-	virtual void Call(Event& eventToCall) = 0;
+// same as EventDelegate for handlers that receive every queued event of a type at once
+struct EventBatchDelegate
+{
+	typedef void (*StubFunction)(void* ownerInstance, const void* events, std::size_t numberOfEvents);
+
+	void* m_ownerInstance = nullptr;
+	StubFunction m_stubFunction = nullptr;
+
+	void operator()(const void* events, std::size_t numberOfEvents) const
+	{
+		m_stubFunction(m_ownerInstance, events, numberOfEvents);
+	}
 };
 
-template<typename TOwner, typename TEvent>
-class EventCallback : public IEventCallback
+// splits a handler like &DamageSystem::OnCollision into its owner and event types
+template <typename TCallback>
+struct EventCallbackTraits;
+
+template <typename TOwner, typename TEvent>
+struct EventCallbackTraits<void (TOwner::*)(const TEvent&)>
+{
+	typedef TOwner Owner;
+	typedef TEvent HandledEvent;
+	static constexpr bool IS_BATCH = false;
+};
+
+template <typename TOwner, typename TEvent>
+struct EventCallbackTraits<void (TOwner::*)(EventSpan<TEvent>)>
+{
+	typedef TOwner Owner;
+	typedef TEvent HandledEvent;
+	static constexpr bool IS_BATCH = true;
+};
+
+// true when the arguments of EmitEvent are only an already built event
+template <typename TEvent, typename ...TArgs>
+struct IsSingleEvent : std::false_type {};
+
+template <typename TEvent, typename TArg>
+struct IsSingleEvent<TEvent, TArg> : std::is_same<TEvent, std::decay_t<TArg>> {};
+
+class EventBus;
+
+// Returned by EventBus::SubscribeToEvent(), the handler stays subscribed for as long as this handle lives.
+// It can be moved around (usually into a member of the subscriber) and destroyed after the bus
+class EventSubscription
 {
-private:
-	typedef void (TOwner::*CallbackFunction)(TEvent&);
 public:
-	EventCallback(TOwner* ownerInstance, CallbackFunction callbackFunction)
-		: m_ownerInstance(ownerInstance)
-		, m_callbackFunction(callbackFunction)
+	EventSubscription() = default;
+	EventSubscription(EventBus* eventBus, std::weak_ptr<bool> isEventBusAlive, std::size_t eventTypeId, std::size_t subscriptionId)
+		: m_eventBus(eventBus)
+		, m_isEventBusAlive(std::move(isEventBusAlive))
+		, m_eventTypeId(eventTypeId)
+		, m_subscriptionId(subscriptionId)
+	{
+	}
+
+	~EventSubscription()
 	{
+		Unsubscribe();
 	}
 
-	virtual ~EventCallback() override = default;
+	EventSubscription(const EventSubscription&) = delete;
+	EventSubscription& operator=(const EventSubscription&) = delete;
+
+	EventSubscription(EventSubscription&& other) noexcept
+		: m_eventBus(other.m_eventBus)
+		, m_isEventBusAlive(std::move(other.m_isEventBusAlive))
+		, m_eventTypeId(other.m_eventTypeId)
+		, m_subscriptionId(other.m_subscriptionId)
+	{
+		other.m_eventBus = nullptr;
+	}
+
+	EventSubscription& operator=(EventSubscription&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Unsubscribe();
+			m_eventBus = other.m_eventBus;
+			m_isEventBusAlive = std::move(other.m_isEventBusAlive);
+			m_eventTypeId = other.m_eventTypeId;
+			m_subscriptionId = other.m_subscriptionId;
+			other.m_eventBus = nullptr;
+		}
+		return *this;
+	}
+
+	void Unsubscribe();
+	bool IsSubscribed() const { return m_eventBus != nullptr && !m_isEventBusAlive.expired(); }
 
 private:
-	virtual void Call(Event& eventToCall) override
+	EventBus* m_eventBus = nullptr;
+	std::weak_ptr<bool> m_isEventBusAlive;
+	std::size_t m_eventTypeId = 0;
+	std::size_t m_subscriptionId = 0;
+};
+
+struct EventHandler
+{
+	std::size_t m_subscriptionId;
+	// its stub is null once unsubscribed during a dispatch, the handler is erased when the dispatch ends
+	EventDelegate m_delegate;
+};
+
+struct EventBatchHandler
+{
+	std::size_t m_subscriptionId;
+	EventBatchDelegate m_delegate;
+};
+
+// needs to exist because we can't have a unique_ptr of template types
+class IEventQueue
+{
+public:
+	virtual ~IEventQueue() = default;
+
+	virtual void Dispatch(EventBus& eventBus) = 0;
+	virtual std::size_t GetNumberOfEvents() const = 0;
+	virtual void Clear() = 0;
+
+	// used to merge the producers' queues, 'destination' must hold the same event type
+	virtual std::unique_ptr<IEventQueue> CreateEmptyQueue() const = 0;
+	virtual void MoveEventsTo(IEventQueue& destination) = 0;
+};
+
+// The events of one type waiting for EventBus::DispatchQueuedEvents(), stored contiguously so
+// batch handlers get them all in one call. Both vectors keep their memory from one frame to the next
+template <typename TEvent>
+class EventQueue : public IEventQueue
+{
+public:
+	// true when it is the first event waiting in the queue
+	template <typename ...TArgs>
+	bool Enqueue(TArgs&& ...args)
+	{
+		m_events.emplace_back(std::forward<TArgs>(args)...);
+		return m_events.size() == 1;
+	}
+
+	virtual void Dispatch(EventBus& eventBus) override;
+	virtual std::size_t GetNumberOfEvents() const override { return m_events.size(); }
+	virtual void Clear() override { m_events.clear(); }
+
+	virtual std::unique_ptr<IEventQueue> CreateEmptyQueue() const override
+	{
+		return std::make_unique<EventQueue<TEvent>>();
+	}
+
+	virtual void MoveEventsTo(IEventQueue& destination) override
 	{
-		std::invoke(m_callbackFunction, m_ownerInstance,  static_cast<TEvent&>(eventToCall));
+		// one by one, insert() would need the events to be assignable
+		auto& destinationEvents = static_cast<EventQueue<TEvent>&>(destination).m_events;
+		for (auto& eventToMove : m_events)
+		{
+			destinationEvents.push_back(std::move(eventToMove));
+		}
+		m_events.clear();
 	}
 
-	TOwner* m_ownerInstance;
-	CallbackFunction m_callbackFunction;
+private:
+	std::vector<TEvent> m_events;
+	// the events being delivered, the ones enqueued meanwhile go to m_events and wait for the next dispatch
+	std::vector<TEvent> m_eventsBeingDispatched;
 };
 
-typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+// Lets one worker thread enqueue events while others do the same with their own producer.
+// Each producer only appends to its own queues so there is no lock and no atomic, as long as a
+// producer is used by a single thread at a time. The events wait there until the next
+// EventBus::DispatchQueuedEvents(), which must not run while producers are enqueueing.
+// Payloads must not be allocated from the bus' arena, it is not thread safe
+class alignas(64) EventProducer
+{
+public:
+	EventProducer() = default;
 
+	template <typename TEvent, typename ...TArgs>
+	void EnqueueEvent(TArgs&& ...args)
+	{
+		const std::size_t eventTypeId = EventType<TEvent>::GetId();
+		if (eventTypeId >= m_queuesPerEventType.size())
+		{
+			m_queuesPerEventType.resize(eventTypeId + 1);
+		}
+
+		auto& eventQueue = m_queuesPerEventType[eventTypeId];
+		if (eventQueue == nullptr)
+		{
+			eventQueue = std::make_unique<EventQueue<TEvent>>();
+		}
+		if (static_cast<EventQueue<TEvent>&>(*eventQueue).Enqueue(std::forward<TArgs>(args)...))
+		{
+			m_queuedEventTypeIds.push_back(eventTypeId);
+		}
+	}
+
+private:
+	friend class EventBus;
+
+	// indexed by EventType<TEvent>::GetId(), aligned so that two producers never share a cache line
+	std::vector<std::unique_ptr<IEventQueue>> m_queuesPerEventType;
+	// the types that have events, in the order of their first event (see EventBus::DispatchQueuedEvents())
+	std::vector<std::size_t> m_queuedEventTypeIds;
+};
+
+// Subscriptions live until their EventSubscription handle is destroyed, so systems subscribe once.
+// The handlers of an event type sit in contiguous arrays found by indexing with the type's id,
+// emitting an event is an index, a loop and one indirect call per handler, it never allocates.
+//
+// Events are either emitted, every handler runs right away, or enqueued and delivered when
+// DispatchQueuedEvents() is called. An event is built once and every handler gets it by const reference,
+// big payloads can be stored in GetArena() so that the event itself stays small and cheap to queue.
+// Batch handlers (taking an EventSpan) receive all the queued events of their type in one call, in the
+// order they were enqueued, then the handlers taking a single event get them one by one.
+// Emitted events reach batch handlers too, as a span of one event.
+// Worker threads enqueue through an EventProducer each, at the dispatch their events are appended after
+// the ones enqueued on the bus, producer after producer, each in the order it enqueued them, so the order
+// only depends on what every producer did and not on how the threads were scheduled.
+//
+// Handlers may subscribe and unsubscribe while an event is being dispatched: handlers added during
+// a dispatch only receive the following events and removed ones are not called anymore
 class EventBus
 {
 public:
 	EventBus()
+		: m_isAlive(std::make_shared<bool>(true))
 	{
 		Logger::Log("EventBus constructor called");
 	}
@@ -61,42 +279,397 @@ public:
 	{
 		Logger::Log("EventBus destructor called");
 	}
-	
+
+	// removes every handler, queued event and payload, their EventSubscription handles become empty
 	void Reset()
 	{
-		m_subscribers.clear();
+		// the handles given so far only watch the old flag, they stop being subscribed and do nothing when destroyed
+		m_isAlive = std::make_shared<bool>(true);
+		m_arenas[0].Reset();
+		m_arenas[1].Reset();
+		m_queuedEventTypeIds.clear();
+
+		for (auto& eventTypeHandlers : m_eventTypes)
+		{
+			eventTypeHandlers.m_handlers.clear();
+			eventTypeHandlers.m_batchHandlers.clear();
+			if (eventTypeHandlers.m_queue)
+			{
+				eventTypeHandlers.m_queue->Clear();
+			}
+		}
+		for (auto& producer : m_producers)
+		{
+			for (auto& eventQueue : producer.m_queuesPerEventType)
+			{
+				if (eventQueue) eventQueue->Clear();
+			}
+			producer.m_queuedEventTypeIds.clear();
+		}
 	}
 
 	// should be used in this format
-	// eventBus->SubscribeToEvent<CollisionEvent>(this, &Game::OnCollision);
-	template <typename TEvent, typename TOwner>
-	void SubscribeToEvent(TOwner* ownerInstance, void(TOwner::*callbackFunction)(TEvent&))
+	// m_subscription = eventBus->SubscribeToEvent<&Game::OnCollision>(this);
+	// where the handler is either void OnCollision(const CollisionEvent&) or void OnCollision(EventSpan<CollisionEvent>)
+	template <auto TCallbackFunction>
+	[[nodiscard]] EventSubscription SubscribeToEvent(typename EventCallbackTraits<decltype(TCallbackFunction)>::Owner* ownerInstance)
 	{
-		if (m_subscribers[typeid(TEvent)].get() == nullptr)
+		typedef EventCallbackTraits<decltype(TCallbackFunction)> CallbackTraits;
+		typedef typename CallbackTraits::Owner TOwner;
+		typedef typename CallbackTraits::HandledEvent TEvent;
+
+		const std::size_t eventTypeId = EventType<TEvent>::GetId();
+		auto& eventTypeHandlers = GetEventTypeHandlers(eventTypeId);
+		const std::size_t subscriptionId = ++m_lastSubscriptionId;
+
+		if constexpr (CallbackTraits::IS_BATCH)
 		{
-			m_subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
+			EventBatchDelegate batchDelegate;
+			batchDelegate.m_ownerInstance = ownerInstance;
+			batchDelegate.m_stubFunction = [](void* owner, const void* events, std::size_t numberOfEvents)
+			{
+				(static_cast<TOwner*>(owner)->*TCallbackFunction)(EventSpan<TEvent>(static_cast<const TEvent*>(events), numberOfEvents));
+			};
+			eventTypeHandlers.m_batchHandlers.push_back(EventBatchHandler{ subscriptionId, batchDelegate });
+		}
+		else
+		{
+			EventDelegate eventDelegate;
+			eventDelegate.m_ownerInstance = ownerInstance;
+			eventDelegate.m_stubFunction = [](void* owner, const Event& eventToCall)
+			{
+				(static_cast<TOwner*>(owner)->*TCallbackFunction)(static_cast<const TEvent&>(eventToCall));
+			};
+			eventTypeHandlers.m_handlers.push_back(EventHandler{ subscriptionId, eventDelegate });
 		}
 
-		auto subscriberToAdd = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
-		auto& listOfCallbacksForEventType = m_subscribers[typeid(TEvent)];
-		
-		listOfCallbacksForEventType->push_back(std::move(subscriberToAdd));
+		return EventSubscription(this, m_isAlive, eventTypeId, subscriptionId);
 	}
 
-	template <typename TEvent, typename ...TArgs>
+	void Unsubscribe(std::size_t eventTypeId, std::size_t subscriptionId)
+	{
+		if (eventTypeId >= m_eventTypes.size()) return;
+
+		auto& eventTypeHandlers = m_eventTypes[eventTypeId];
+		if (!RemoveHandler(eventTypeHandlers.m_handlers, subscriptionId))
+		{
+			RemoveHandler(eventTypeHandlers.m_batchHandlers, subscriptionId);
+		}
+	}
+
+	// the event is only built if someone listens to it, and then only once.
+	// an already built event goes to the overload below, even a non-const one, so it is not copied
+	template <typename TEvent, typename ...TArgs, typename = std::enable_if_t<!IsSingleEvent<TEvent, TArgs...>::value>>
 	void EmitEvent(TArgs&& ...args)
 	{
-		auto eventHandlers = m_subscribers[typeid(TEvent)].get();
-		if (eventHandlers != nullptr)
+		if (!HasHandlers(EventType<TEvent>::GetId())) return;
+
+		const TEvent eventToEmit(std::forward<TArgs>(args)...);
+		EmitEvent(eventToEmit);
+	}
+
+	// for events built beforehand, the handlers get a reference to this instance
+	template <typename TEvent>
+	void EmitEvent(const TEvent& eventToEmit)
+	{
+		const std::size_t eventTypeId = EventType<TEvent>::GetId();
+		if (!HasHandlers(eventTypeId)) return;
+
+		m_dispatchDepth++;
+
+		CallHandlers(eventTypeId, &EventTypeHandlers::m_batchHandlers, [&](const EventBatchDelegate& batchDelegate)
 		{
-			for (auto it = eventHandlers->begin(); it != eventHandlers->end(); it++)
+			batchDelegate(&eventToEmit, 1);
+		});
+		CallHandlers(eventTypeId, &EventTypeHandlers::m_handlers, [&](const EventDelegate& eventDelegate)
+		{
+			eventDelegate(eventToEmit);
+		});
+
+		EndDispatch();
+	}
+
+	// the event is stored and only delivered by the next DispatchQueuedEvents()
+	template <typename TEvent, typename ...TArgs>
+	void EnqueueEvent(TArgs&& ...args)
+	{
+		const std::size_t eventTypeId = EventType<TEvent>::GetId();
+		auto& eventQueue = GetEventTypeHandlers(eventTypeId).m_queue;
+		if (eventQueue == nullptr)
+		{
+			eventQueue = std::make_unique<EventQueue<TEvent>>();
+		}
+		if (static_cast<EventQueue<TEvent>&>(*eventQueue).Enqueue(std::forward<TArgs>(args)...))
+		{
+			m_queuedEventTypeIds.push_back(eventTypeId);
+		}
+	}
+
+	// to be called before handing the producers to the worker threads, the producers are indexed from 0
+	void SetNumberOfProducers(std::size_t numberOfProducers)
+	{
+		if (numberOfProducers < m_producers.size())
+		{
+			// their events would be lost otherwise
+			MergeProducersEvents();
+		}
+		m_producers.resize(numberOfProducers);
+	}
+
+	std::size_t GetNumberOfProducers() const { return m_producers.size(); }
+
+	// each producer is meant to be used by one thread at a time, the index decides the order of its events
+	EventProducer& GetProducer(std::size_t producerIndex) { return m_producers[producerIndex]; }
+
+	// Payloads allocated here stay valid until the DispatchQueuedEvents() call that follows has delivered them.
+	// There are two arenas, the payloads of the events enqueued during a dispatch go to the other one
+	EventArena& GetArena() { return m_arenas[m_currentArena]; }
+
+	// Delivers the queued events type after type, in the order the first event of each type was queued: on the bus, then
+	// producer after producer. The ids of the types depend on which thread used a type first, they do not decide the order.
+	// Events of a type that was already delivered, or that had no event yet, wait for the next call when a handler enqueues them
+	void DispatchQueuedEvents()
+	{
+		if (m_isDispatchingQueuedEvents)
+		{
+			Logger::Error("DispatchQueuedEvents called from an event handler, the events will be delivered on the next call");
+			return;
+		}
+		m_isDispatchingQueuedEvents = true;
+
+		MergeProducersEvents();
+
+		EventArena& arenaBeingDispatched = m_arenas[m_currentArena];
+		m_currentArena = 1 - m_currentArena;
+
+		// swapped, the types the handlers enqueue go to the list of the next call. Both lists keep their memory
+		m_queuedEventTypeIds.swap(m_eventTypeIdsBeingDispatched);
+		for (const std::size_t eventTypeId : m_eventTypeIdsBeingDispatched)
+		{
+			// the queue lives on the heap, it is not moved if a handler makes m_eventTypes grow
+			auto eventQueue = m_eventTypes[eventTypeId].m_queue.get();
+			if (eventQueue != nullptr)
+			{
+				eventQueue->Dispatch(*this);
+			}
+		}
+		m_eventTypeIdsBeingDispatched.clear();
+
+		arenaBeingDispatched.Reset();
+		m_isDispatchingQueuedEvents = false;
+	}
+
+	std::size_t GetNumberOfQueuedEvents() const
+	{
+		std::size_t numberOfQueuedEvents = 0;
+		for (const auto& eventTypeHandlers : m_eventTypes)
+		{
+			if (eventTypeHandlers.m_queue)
+			{
+				numberOfQueuedEvents += eventTypeHandlers.m_queue->GetNumberOfEvents();
+			}
+		}
+		for (const auto& producer : m_producers)
+		{
+			for (const auto& eventQueue : producer.m_queuesPerEventType)
 			{
-				auto eventHandler = it->get();
-				TEvent eventParams(std::forward<TArgs>(args)...);
-				eventHandler->Execute(eventParams);
+				if (eventQueue) numberOfQueuedEvents += eventQueue->GetNumberOfEvents();
 			}
 		}
+		return numberOfQueuedEvents;
+	}
+
+	std::size_t GetNumberOfHandlers() const
+	{
+		std::size_t numberOfHandlers = 0;
+		for (const auto& eventTypeHandlers : m_eventTypes)
+		{
+			for (const auto& handler : eventTypeHandlers.m_handlers)
+			{
+				if (handler.m_delegate.m_stubFunction != nullptr) numberOfHandlers++;
+			}
+			for (const auto& handler : eventTypeHandlers.m_batchHandlers)
+			{
+				if (handler.m_delegate.m_stubFunction != nullptr) numberOfHandlers++;
+			}
+		}
+		return numberOfHandlers;
 	}
 private:
-	std::map<std::type_index, std::unique_ptr<HandlerList>> m_subscribers;
-};
\ No newline at end of file
+	template <typename TEvent>
+	friend class EventQueue;
+
+	struct EventTypeHandlers
+	{
+		std::vector<EventHandler> m_handlers;
+		std::vector<EventBatchHandler> m_batchHandlers;
+		std::unique_ptr<IEventQueue> m_queue;
+	};
+
+	// appends the events of every producer to the bus' queues, in the order of the producers
+	void MergeProducersEvents()
+	{
+		for (auto& producer : m_producers)
+		{
+			for (const std::size_t eventTypeId : producer.m_queuedEventTypeIds)
+			{
+				auto& producerQueue = producer.m_queuesPerEventType[eventTypeId];
+				if (producerQueue->GetNumberOfEvents() == 0) continue;
+
+				auto& eventQueue = GetEventTypeHandlers(eventTypeId).m_queue;
+				if (eventQueue == nullptr)
+				{
+					eventQueue = producerQueue->CreateEmptyQueue();
+				}
+				if (eventQueue->GetNumberOfEvents() == 0)
+				{
+					m_queuedEventTypeIds.push_back(eventTypeId);
+				}
+				producerQueue->MoveEventsTo(*eventQueue);
+			}
+			producer.m_queuedEventTypeIds.clear();
+		}
+	}
+
+	bool HasHandlers(std::size_t eventTypeId) const
+	{
+		return eventTypeId < m_eventTypes.size() &&
+			(!m_eventTypes[eventTypeId].m_handlers.empty() || !m_eventTypes[eventTypeId].m_batchHandlers.empty());
+	}
+
+	EventTypeHandlers& GetEventTypeHandlers(std::size_t eventTypeId)
+	{
+		if (eventTypeId >= m_eventTypes.size())
+		{
+			m_eventTypes.resize(eventTypeId + 1);
+		}
+		return m_eventTypes[eventTypeId];
+	}
+
+	// called by EventQueue<TEvent>::Dispatch() with the events it is delivering
+	template <typename TEvent>
+	void DeliverQueuedEvents(const std::vector<TEvent>& events)
+	{
+		const std::size_t eventTypeId = EventType<TEvent>::GetId();
+
+		m_dispatchDepth++;
+
+		CallHandlers(eventTypeId, &EventTypeHandlers::m_batchHandlers, [&](const EventBatchDelegate& batchDelegate)
+		{
+			batchDelegate(events.data(), events.size());
+		});
+		for (const auto& queuedEvent : events)
+		{
+			CallHandlers(eventTypeId, &EventTypeHandlers::m_handlers, [&](const EventDelegate& eventDelegate)
+			{
+				eventDelegate(queuedEvent);
+			});
+		}
+
+		EndDispatch();
+	}
+
+	// calls 'callHandler' with the delegate of every handler in the array that is still subscribed
+	template <typename THandler, typename TCallHandler>
+	void CallHandlers(std::size_t eventTypeId, std::vector<THandler> EventTypeHandlers::*handlerArray, TCallHandler&& callHandler)
+	{
+		// handlers subscribed by the handlers below are appended after these
+		const std::size_t numberOfHandlers = (m_eventTypes[eventTypeId].*handlerArray).size();
+
+		for (std::size_t i = 0; i < numberOfHandlers; i++)
+		{
+			// indexed every time and copied, a handler subscribing may grow the arrays and Reset() may empty them
+			const auto& handlers = m_eventTypes[eventTypeId].*handlerArray;
+			if (i >= handlers.size()) break;
+
+			const auto handlerDelegate = handlers[i].m_delegate;
+			if (handlerDelegate.m_stubFunction == nullptr) continue;
+
+			callHandler(handlerDelegate);
+		}
+	}
+
+	void EndDispatch()
+	{
+		m_dispatchDepth--;
+		if (m_dispatchDepth == 0 && m_hasPendingRemovals)
+		{
+			RemoveUnsubscribedHandlers();
+		}
+	}
+
+	template <typename THandler>
+	bool RemoveHandler(std::vector<THandler>& handlers, std::size_t subscriptionId)
+	{
+		for (auto it = handlers.begin(); it != handlers.end(); it++)
+		{
+			if (it->m_subscriptionId != subscriptionId) continue;
+
+			if (m_dispatchDepth > 0)
+			{
+				// the array is being iterated, erasing would shift the handlers not called yet
+				it->m_delegate.m_stubFunction = nullptr;
+				m_hasPendingRemovals = true;
+			}
+			else
+			{
+				handlers.erase(it);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void RemoveUnsubscribedHandlers()
+	{
+		const auto isUnsubscribed = [](const auto& handler) { return handler.m_delegate.m_stubFunction == nullptr; };
+		for (auto& eventTypeHandlers : m_eventTypes)
+		{
+			auto& handlers = eventTypeHandlers.m_handlers;
+			handlers.erase(std::remove_if(handlers.begin(), handlers.end(), isUnsubscribed), handlers.end());
+
+			auto& batchHandlers = eventTypeHandlers.m_batchHandlers;
+			batchHandlers.erase(std::remove_if(batchHandlers.begin(), batchHandlers.end(), isUnsubscribed), batchHandlers.end());
+		}
+		m_hasPendingRemovals = false;
+	}
+
+	// indexed by EventType<TEvent>::GetId()
+	std::vector<EventTypeHandlers> m_eventTypes;
+	// the types that have queued events, in the order of their first event
+	std::vector<std::size_t> m_queuedEventTypeIds;
+	std::vector<std::size_t> m_eventTypeIdsBeingDispatched;
+
+	std::size_t m_lastSubscriptionId = 0;
+	int m_dispatchDepth = 0;
+	bool m_hasPendingRemovals = false;
+	bool m_isDispatchingQueuedEvents = false;
+
+	EventArena m_arenas[2];
+	int m_currentArena = 0;
+
+	std::vector<EventProducer> m_producers;
+
+	// handles check it before unsubscribing, the bus may be destroyed before them
+	std::shared_ptr<bool> m_isAlive;
+};
+
+template <typename TEvent>
+inline void EventQueue<TEvent>::Dispatch(EventBus& eventBus)
+{
+	if (m_events.empty()) return;
+
+	// swapping keeps the memory of both vectors
+	m_events.swap(m_eventsBeingDispatched);
+	eventBus.DeliverQueuedEvents(m_eventsBeingDispatched);
+	m_eventsBeingDispatched.clear();
+}
+
+inline void EventSubscription::Unsubscribe()
+{
+	if (IsSubscribed())
+	{
+		m_eventBus->Unsubscribe(m_eventTypeId, m_subscriptionId);
+	}
+	m_eventBus = nullptr;
+}
\ No newline at end of file
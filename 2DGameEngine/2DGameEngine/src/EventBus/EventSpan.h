@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+// Read only view over contiguous events, what batch handlers receive (the engine is C++17, there is no std::span).
+// Only valid during the handler call, the events are reused for the next dispatch
+template <typename TEvent>
+class EventSpan
+{
+public:
+	EventSpan(const TEvent* events, std::size_t numberOfEvents)
+		: m_events(events)
+		, m_numberOfEvents(numberOfEvents)
+	{
+	}
+
+	const TEvent* begin() const { return m_events; }
+	const TEvent* end() const { return m_events + m_numberOfEvents; }
+
+	const TEvent& operator[](std::size_t index) const { return m_events[index]; }
+	std::size_t size() const { return m_numberOfEvents; }
+	bool empty() const { return m_numberOfEvents == 0; }
+
+private:
+	const TEvent* m_events;
+	std::size_t m_numberOfEvents;
+};
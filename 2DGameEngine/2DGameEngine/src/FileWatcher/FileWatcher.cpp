@@ -0,0 +1,192 @@
+#include "pch.h"
+
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "Logger/Logger.h"
+
+namespace
+{
+	// an editor can write a file more than once when saving it
+	void AddChange(std::vector<std::string>& changes, const std::string& filePath)
+	{
+		if (std::find(changes.begin(), changes.end(), filePath) == changes.end())
+		{
+			changes.push_back(filePath);
+		}
+	}
+}
+
+FileWatcher::FileWatcher(bool shouldUseNotifications, int pollingIntervalInMs)
+	: m_pollingInterval(pollingIntervalInMs)
+	, m_lastPollTime(std::chrono::steady_clock::now())
+{
+#ifdef __linux__
+	if (shouldUseNotifications)
+	{
+		m_notificationDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_notificationDescriptor < 0)
+		{
+			Logger::Error(std::string("FileWatcher: inotify is not available (") + std::strerror(errno) + "), the files are polled");
+		}
+	}
+#else
+	(void)shouldUseNotifications;
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+	if (m_notificationDescriptor >= 0)
+	{
+		close(m_notificationDescriptor);
+	}
+#endif
+}
+
+bool FileWatcher::Watch(const std::string& directory, const std::vector<std::string>& extensions)
+{
+	std::error_code error;
+	if (!std::filesystem::is_directory(directory, error))
+	{
+		Logger::Error("FileWatcher: " + directory + " is not a directory, it is not watched");
+		return false;
+	}
+
+	WatchedDirectory watchedDirectory;
+	watchedDirectory.m_directory = directory;
+	watchedDirectory.m_extensions = extensions;
+
+#ifdef __linux__
+	if (IsUsingNotifications())
+	{
+		// IN_MOVED_TO for the editors that write a copy of the file and rename it over the file
+		watchedDirectory.m_watchDescriptor = inotify_add_watch(m_notificationDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (watchedDirectory.m_watchDescriptor < 0)
+		{
+			Logger::Error("FileWatcher: inotify cannot watch " + directory + " (" + std::strerror(errno) + "), its files are polled");
+		}
+	}
+#endif
+
+	// the files already there are not changes
+	if (watchedDirectory.m_watchDescriptor < 0)
+	{
+		PollWriteTimes(watchedDirectory, nullptr);
+	}
+	m_directories.push_back(std::move(watchedDirectory));
+	return true;
+}
+
+std::vector<std::string> FileWatcher::PollChanges()
+{
+	std::vector<std::string> changes;
+	if (IsUsingNotifications())
+	{
+		ReadNotifications(changes);
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if (now - m_lastPollTime >= m_pollingInterval)
+	{
+		m_lastPollTime = now;
+		for (auto& directory : m_directories)
+		{
+			if (directory.m_watchDescriptor < 0)
+			{
+				PollWriteTimes(directory, &changes);
+			}
+		}
+	}
+	return changes;
+}
+
+bool FileWatcher::IsWatched(const WatchedDirectory& directory, const std::filesystem::path& fileName) const
+{
+	const std::string extension = fileName.extension().string();
+	return std::find(directory.m_extensions.begin(), directory.m_extensions.end(), extension) != directory.m_extensions.end();
+}
+
+void FileWatcher::ReadNotifications(std::vector<std::string>& changes)
+{
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+	while (true)
+	{
+		// the descriptor does not block, nothing left to read ends the loop
+		const ssize_t length = read(m_notificationDescriptor, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			break;
+		}
+
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				Logger::Error("FileWatcher: too many changes at once, some of them were missed");
+				continue;
+			}
+			if (event->len == 0)
+			{
+				continue;
+			}
+
+			const auto directory = std::find_if(m_directories.begin(), m_directories.end(), [event](const WatchedDirectory& watchedDirectory)
+			{
+				return watchedDirectory.m_watchDescriptor == event->wd;
+			});
+			if (directory != m_directories.end() && IsWatched(*directory, event->name))
+			{
+				AddChange(changes, (directory->m_directory / event->name).generic_string());
+			}
+		}
+	}
+#else
+	(void)changes;
+#endif
+}
+
+void FileWatcher::PollWriteTimes(WatchedDirectory& directory, std::vector<std::string>* changes) const
+{
+	std::error_code error;
+	for (auto file = std::filesystem::directory_iterator(directory.m_directory, error); !error && file != std::filesystem::directory_iterator(); file.increment(error))
+	{
+		// a file removed meanwhile does not end the loop
+		std::error_code fileError;
+		const std::filesystem::path fileName = file->path().filename();
+		if (!file->is_regular_file(fileError) || !IsWatched(directory, fileName))
+		{
+			continue;
+		}
+
+		const auto writeTime = file->last_write_time(fileError);
+		if (fileError)
+		{
+			continue;
+		}
+
+		// a new file is a change too
+		const auto knownWriteTime = directory.m_writeTimes.find(fileName.string());
+		if (knownWriteTime == directory.m_writeTimes.end() || knownWriteTime->second != writeTime)
+		{
+			directory.m_writeTimes[fileName.string()] = writeTime;
+			if (changes)
+			{
+				AddChange(*changes, file->path().generic_string());
+			}
+		}
+	}
+}
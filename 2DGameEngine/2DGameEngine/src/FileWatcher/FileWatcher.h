@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+
+namespace CONST
+{
+	namespace FILE_WATCHER
+	{
+		// how often the modification times are compared when the changes are polled
+		constexpr int POLLING_INTERVAL_IN_MS = 250;
+	}
+}
+
+// Reports the files of the watched directories that were written since the last PollChanges(), without blocking.
+// On Linux the directories are watched with inotify, the changes are read from a non blocking descriptor once a frame.
+// Elsewhere, or when inotify cannot be used, the modification times of the files are compared every polling interval.
+// The directories are not watched recursively and only the files with one of the extensions of their directory are reported
+class FileWatcher
+{
+public:
+	FileWatcher(bool shouldUseNotifications = true, int pollingIntervalInMs = CONST::FILE_WATCHER::POLLING_INTERVAL_IN_MS);
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// the extensions with their dot (".lua"), false (and logged) when the directory cannot be watched
+	bool Watch(const std::string& directory, const std::vector<std::string>& extensions);
+
+	// the paths (directory and file name) of the files written since the last call, each one once
+	std::vector<std::string> PollChanges();
+
+	bool IsUsingNotifications() const { return m_notificationDescriptor >= 0; }
+private:
+	struct WatchedDirectory
+	{
+		std::filesystem::path m_directory;
+		std::vector<std::string> m_extensions;
+		int m_watchDescriptor = -1;
+		// by file name, only kept when the directory is polled
+		std::unordered_map<std::string, std::filesystem::file_time_type> m_writeTimes;
+	};
+
+	bool IsWatched(const WatchedDirectory& directory, const std::filesystem::path& fileName) const;
+	void ReadNotifications(std::vector<std::string>& changes);
+	// the files added or written since the last poll are appended to 'changes'
+	void PollWriteTimes(WatchedDirectory& directory, std::vector<std::string>* changes) const;
+
+	std::vector<WatchedDirectory> m_directories;
+	int m_notificationDescriptor = -1;
+	std::chrono::milliseconds m_pollingInterval;
+	std::chrono::steady_clock::time_point m_lastPollTime;
+};
@@ -0,0 +1,379 @@
+#include "pch.h"
+
+#include "CompiledLevel.h"
+
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "AssetStore/AssetArchive.h"
+#include "Game/LuaBackend.h"
+#include "HelperFunctions.h"
+
+namespace
+{
+	const char MAGIC[4] = { '2', 'D', 'L', 'V' };
+	// increased when the records change, or what the loader writes in them (4: box colliders sized after the prefabs)
+	const std::uint32_t VERSION = 4;
+
+	template <typename T>
+	void Append(std::string& data, const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only plain values are written as they are");
+		data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void AppendBlock(std::string& data, const std::string& block)
+	{
+		Append(data, static_cast<std::uint32_t>(block.size()));
+		data.append(block);
+	}
+
+	// the size of the records is written with them, a level compiled by a build whose records differ is not read
+	template <typename T>
+	void AppendArray(std::string& data, const std::vector<T>& records)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only plain records are written as they are");
+		Append(data, static_cast<std::uint32_t>(records.size()));
+		Append(data, static_cast<std::uint32_t>(sizeof(T)));
+		data.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+	}
+
+	class Reader
+	{
+	public:
+		Reader(const char* data, std::size_t size)
+			: m_data(data)
+			, m_size(size)
+		{
+		}
+
+		template <typename T>
+		bool Read(T& value)
+		{
+			if (m_size - m_offset < sizeof(T))
+			{
+				return false;
+			}
+			std::memcpy(&value, m_data + m_offset, sizeof(T));
+			m_offset += sizeof(T);
+			return true;
+		}
+
+		bool ReadBlock(const char*& block, std::uint32_t& size)
+		{
+			if (!Read(size) || m_size - m_offset < size)
+			{
+				return false;
+			}
+			block = m_data + m_offset;
+			m_offset += size;
+			return true;
+		}
+
+		template <typename T>
+		bool ReadArray(std::vector<T>& records)
+		{
+			std::uint32_t numberOfRecords = 0;
+			std::uint32_t recordSize = 0;
+			if (!Read(numberOfRecords) || !Read(recordSize) || recordSize != sizeof(T)
+				|| (m_size - m_offset) / sizeof(T) < numberOfRecords)
+			{
+				return false;
+			}
+			records.resize(numberOfRecords);
+			std::memcpy(records.data(), m_data + m_offset, numberOfRecords * sizeof(T));
+			m_offset += numberOfRecords * sizeof(T);
+			return true;
+		}
+
+		bool IsAtEnd() const { return m_offset == m_size; }
+		// what is left to read
+		const char* GetRemainingData() const { return m_data + m_offset; }
+		std::size_t GetRemainingSize() const { return m_size - m_offset; }
+	private:
+		const char* m_data;
+		std::size_t m_size;
+		std::size_t m_offset = 0;
+	};
+
+	// loading bytecode gives the function the globals as its first upvalue (Lua 5.3) or as its environment (LuaJIT),
+	// any other upvalue would be nil
+	bool DumpFunction(const sol::function& function, std::string& bytecode, std::string& error)
+	{
+		lua_State* L = function.lua_state();
+		function.push();
+		if (lua_iscfunction(L, -1))
+		{
+			lua_pop(L, 1);
+			error = "is a C function";
+			return false;
+		}
+		for (int i = 1; const char* upvalueName = lua_getupvalue(L, -1, i); i++)
+		{
+			const std::string name = upvalueName;
+			lua_pop(L, 1);
+			if (i > 1 || name != "_ENV")
+			{
+				lua_pop(L, 1);
+				error = "uses the local '" + name + "' of the level script";
+				return false;
+			}
+		}
+		lua_pop(L, 1);
+
+		const int result = function.dump(&LuaBackend::WriteBytecode, &bytecode, false, [](lua_State*, int result, lua_Writer, void*, bool) { return result; });
+		if (result != 0)
+		{
+			error = "could not be dumped";
+			return false;
+		}
+		return true;
+	}
+}
+
+std::uint32_t CompiledLevel::Intern(const std::string& string)
+{
+	const auto index = m_stringIndices.find(string);
+	if (index != m_stringIndices.end())
+	{
+		return index->second;
+	}
+	const std::uint32_t newIndex = static_cast<std::uint32_t>(m_strings.size());
+	m_strings.push_back(string);
+	m_stringIndices.emplace(string, newIndex);
+	return newIndex;
+}
+
+std::uint32_t CompiledLevel::AddFunction(const sol::function& function)
+{
+	for (std::size_t i = 0; i < m_functions.size(); i++)
+	{
+		if (m_functions[i].pointer() == function.pointer())
+		{
+			return static_cast<std::uint32_t>(i);
+		}
+	}
+	m_functions.push_back(function);
+	return static_cast<std::uint32_t>(m_functions.size() - 1);
+}
+
+bool CompiledLevel::Write(const std::string& path, std::string& error) const
+{
+	std::string data;
+	data.append(MAGIC, sizeof(MAGIC));
+	Append(data, VERSION);
+	// the checksum of everything after it, written once the level is
+	const std::size_t checksumOffset = data.size();
+	Append(data, std::uint64_t(0));
+	const std::size_t checksummedOffset = data.size();
+	Append(data, m_sourceHash);
+	Append(data, m_window);
+
+	Append(data, static_cast<std::uint32_t>(m_strings.size()));
+	for (const auto& string : m_strings)
+	{
+		AppendBlock(data, string);
+	}
+
+	Append(data, static_cast<std::uint32_t>(m_functions.size()));
+	for (std::size_t i = 0; i < m_functions.size(); i++)
+	{
+		std::string bytecode;
+		std::string dumpError;
+		if (!DumpFunction(m_functions[i], bytecode, dumpError))
+		{
+			const auto script = std::find_if(m_scripts.begin(), m_scripts.end(), [i](const ScriptRecord& record)
+			{
+				return record.m_script == i || record.m_batchScript == i || record.m_behaviour == i;
+			});
+			const std::string entity = script != m_scripts.end() ? std::to_string(script->m_entity) : "?";
+			error = "the script of the entity " + entity + " " + dumpError + ", only the functions using globals can be compiled";
+			return false;
+		}
+		AppendBlock(data, bytecode);
+	}
+
+	AppendArray(data, m_globals);
+	AppendArray(data, m_textures);
+	AppendArray(data, m_fonts);
+	AppendArray(data, m_tilemaps);
+	AppendArray(data, m_entities);
+	AppendArray(data, m_transforms);
+	AppendArray(data, m_rigidbodies);
+	AppendArray(data, m_sprites);
+	AppendArray(data, m_animations);
+	AppendArray(data, m_boxColliders);
+	AppendArray(data, m_healths);
+	AppendArray(data, m_projectileEmitters);
+	AppendArray(data, m_cameraFollowEntities);
+	AppendArray(data, m_keyboardControlled);
+	AppendArray(data, m_dummyCharacterEntities);
+	AppendArray(data, m_scripts);
+
+	const std::uint64_t checksum = Helpers::CalculateChecksum(data.data() + checksummedOffset, data.size() - checksummedOffset);
+	std::memcpy(&data[checksumOffset], &checksum, sizeof(checksum));
+
+	std::error_code directoryError;
+	const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+	if (!directory.empty())
+	{
+		std::filesystem::create_directories(directory, directoryError);
+	}
+
+	std::ofstream file(path, std::ios::binary);
+	file.write(data.data(), static_cast<std::streamsize>(data.size()));
+	if (!file)
+	{
+		error = "could not write " + path;
+		return false;
+	}
+	return true;
+}
+
+bool CompiledLevel::Read(const char* data, std::size_t size, sol::state& lua, std::string& error)
+{
+	*this = CompiledLevel();
+	Reader reader(data, size);
+
+	char magic[sizeof(MAGIC)];
+	std::uint32_t version = 0;
+	if (!reader.Read(magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+	{
+		error = "not a compiled level";
+		return false;
+	}
+	if (!reader.Read(version) || version != VERSION)
+	{
+		error = "compiled level version " + std::to_string(version) + " instead of " + std::to_string(VERSION) + ", compile it again";
+		return false;
+	}
+	// Lua does not check the bytecode it loads, a damaged file could crash it
+	std::uint64_t checksum = 0;
+	if (!reader.Read(checksum) || checksum != Helpers::CalculateChecksum(reader.GetRemainingData(), reader.GetRemainingSize()))
+	{
+		error = "damaged compiled level, compile it again";
+		return false;
+	}
+
+	std::uint32_t numberOfStrings = 0;
+	bool isValid = reader.Read(m_sourceHash) && reader.Read(m_window) && reader.Read(numberOfStrings);
+	for (std::uint32_t i = 0; isValid && i < numberOfStrings; i++)
+	{
+		const char* string = nullptr;
+		std::uint32_t stringSize = 0;
+		isValid = reader.ReadBlock(string, stringSize);
+		if (isValid)
+		{
+			m_strings.emplace_back(string, stringSize);
+		}
+	}
+
+	std::uint32_t numberOfFunctions = 0;
+	isValid = isValid && reader.Read(numberOfFunctions);
+	for (std::uint32_t i = 0; isValid && i < numberOfFunctions; i++)
+	{
+		const char* bytecode = nullptr;
+		std::uint32_t bytecodeSize = 0;
+		isValid = reader.ReadBlock(bytecode, bytecodeSize);
+		if (!isValid)
+		{
+			break;
+		}
+		sol::load_result chunk = lua.load_buffer(bytecode, bytecodeSize, "=compiled level", sol::load_mode::binary);
+		if (!chunk.valid())
+		{
+			const sol::error loadError = chunk;
+			error = std::string("could not load a script: ") + loadError.what();
+			return false;
+		}
+		m_functions.push_back(chunk.get<sol::function>());
+	}
+
+	isValid = isValid
+		&& reader.ReadArray(m_globals)
+		&& reader.ReadArray(m_textures)
+		&& reader.ReadArray(m_fonts)
+		&& reader.ReadArray(m_tilemaps)
+		&& reader.ReadArray(m_entities)
+		&& reader.ReadArray(m_transforms)
+		&& reader.ReadArray(m_rigidbodies)
+		&& reader.ReadArray(m_sprites)
+		&& reader.ReadArray(m_animations)
+		&& reader.ReadArray(m_boxColliders)
+		&& reader.ReadArray(m_healths)
+		&& reader.ReadArray(m_projectileEmitters)
+		&& reader.ReadArray(m_cameraFollowEntities)
+		&& reader.ReadArray(m_keyboardControlled)
+		&& reader.ReadArray(m_dummyCharacterEntities)
+		&& reader.ReadArray(m_scripts)
+		&& reader.IsAtEnd();
+	if (!isValid)
+	{
+		error = "truncated or written by a build with different records, compile it again";
+		return false;
+	}
+	if (!AreReferencesValid())
+	{
+		error = "a record refers to an entity, a string or a script that is not in the level";
+		return false;
+	}
+	return true;
+}
+
+bool CompiledLevel::AreReferencesValid() const
+{
+	const auto isEntity = [this](std::uint32_t entity) { return entity < m_entities.size(); };
+	const auto isString = [this](std::uint32_t string) { return string < m_strings.size(); };
+	const auto isStringOrNone = [this](std::uint32_t string) { return string == NONE || string < m_strings.size(); };
+	const auto isFunctionOrNone = [this](std::uint32_t function) { return function == NONE || function < m_functions.size(); };
+	const auto allOf = [](const auto& records, const auto& isValid) { return std::all_of(records.begin(), records.end(), isValid); };
+
+	return allOf(m_globals, [&](const GlobalRecord& global)
+		{
+			const bool isParentValid = global.m_parent == NONE ? global.m_name != NONE
+				: global.m_parent < m_globals.size() && m_globals[global.m_parent].m_type == ValueType::TABLE;
+			return isParentValid && isStringOrNone(global.m_name) && (global.m_type != ValueType::STRING || isString(global.m_string));
+		})
+		&& allOf(m_textures, [&](const TextureRecord& texture) { return isString(texture.m_assetId) && isString(texture.m_file); })
+		&& allOf(m_fonts, [&](const FontRecord& font) { return isString(font.m_assetId) && isString(font.m_file); })
+		&& allOf(m_tilemaps, [&](const TilemapRecord& tilemap) { return isString(tilemap.m_textureAssetId) && isString(tilemap.m_mapFile); })
+		&& allOf(m_entities, [&](const EntityRecord& entity)
+		{
+			const bool isPrefabValid = entity.m_prefab == NONE
+				|| (entity.m_count > 0 && isEntity(entity.m_prefab) && m_entities[entity.m_prefab].m_count == 0);
+			return isStringOrNone(entity.m_tag) && isStringOrNone(entity.m_group) && isPrefabValid;
+		})
+		&& allOf(m_transforms, [&](const TransformRecord& record) { return isEntity(record.m_entity); })
+		&& allOf(m_rigidbodies, [&](const RigidbodyRecord& record) { return isEntity(record.m_entity); })
+		&& allOf(m_sprites, [&](const SpriteRecord& record) { return isEntity(record.m_entity) && isString(record.m_assetId); })
+		&& allOf(m_animations, [&](const AnimationRecord& record) { return isEntity(record.m_entity); })
+		&& allOf(m_boxColliders, [&](const BoxColliderRecord& record) { return isEntity(record.m_entity); })
+		&& allOf(m_healths, [&](const HealthRecord& record) { return isEntity(record.m_entity); })
+		&& allOf(m_projectileEmitters, [&](const ProjectileEmitterRecord& record) { return isEntity(record.m_entity); })
+		&& allOf(m_cameraFollowEntities, isEntity)
+		&& allOf(m_keyboardControlled, [&](const KeyboardControlledRecord& record) { return isEntity(record.m_entity); })
+		&& allOf(m_dummyCharacterEntities, isEntity)
+		&& allOf(m_scripts, [&](const ScriptRecord& record)
+		{
+			return isEntity(record.m_entity) && isFunctionOrNone(record.m_script) && isFunctionOrNone(record.m_batchScript) && isFunctionOrNone(record.m_behaviour);
+		});
+}
+
+bool CompiledLevel::Load(const std::string& path, const AssetArchive* archive, sol::state& lua, std::string& error)
+{
+	const AssetArchive::Blob packedLevel = archive ? archive->Find(path) : AssetArchive::Blob();
+	if (packedLevel.m_data)
+	{
+		return Read(reinterpret_cast<const char*>(packedLevel.m_data), packedLevel.m_size, lua, error);
+	}
+
+	std::string data;
+	if (!Helpers::ReadFile(path, data))
+	{
+		error = "could not open " + path;
+		return false;
+	}
+	return Read(data.data(), data.size(), lua, error);
+}
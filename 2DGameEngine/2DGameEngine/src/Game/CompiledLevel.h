@@ -0,0 +1,142 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <sol/sol.hpp>
+
+class AssetArchive;
+
+namespace CONST
+{
+	namespace COMPILED_LEVELS
+	{
+		// inside the assets so that the compiled levels are packed with them
+		const std::string DIRECTORY = "./assets/levels/";
+		const std::string EXTENSION = ".lvl";
+	}
+}
+
+// A level resolved from the tables of its script: one array of records per component type, the records referring to
+// their entity by index and to their strings by index in m_strings (each string is stored once). The update scripts
+// are kept as functions, written as bytecode.
+// "2DGameEngine --compile-level <name>" runs the script once and writes the level to a .lvl file, loading that file
+// reads the arrays in one pass instead of running the script and looking every field up (see LevelLoader).
+// The file holds what the script produced when it was compiled: os.date(), math.random()... are not called again,
+// only the positions the script left unspecified are still random
+class CompiledLevel
+{
+public:
+	static constexpr std::uint32_t NONE = 0xFFFFFFFF;
+
+	// the records are copied to and from the file as they are, they have no padding
+	// m_count entities are created from the record, none for a prefab. An entity made from a prefab has the prefab's index
+	// in m_prefab: it gets the prefab's components, its own records replace the prefab's ones of the same component
+	struct EntityRecord { std::uint32_t m_tag; std::uint32_t m_group; std::uint32_t m_prefab; std::uint32_t m_count; };
+	struct TextureRecord { std::uint32_t m_assetId; std::uint32_t m_file; };
+	struct FontRecord { std::uint32_t m_assetId; std::uint32_t m_file; std::int32_t m_fontSize; };
+	struct WindowRecord { std::int32_t m_width; std::int32_t m_height; };
+	struct TilemapRecord
+	{
+		std::uint32_t m_textureAssetId;
+		std::uint32_t m_mapFile;
+		std::int32_t m_tileSize;
+		std::int32_t m_numberOfColumns;
+		std::int32_t m_numberOfRows;
+		std::int32_t m_chunkSize;
+		std::int32_t m_loadRadius;
+		std::int32_t m_unloadRadius;
+		double m_tileScale;
+	};
+
+	// the globals the script defines (map_height, level_setup...) as a tree: the fields of a table follow it and
+	// refer to it with m_parent, the key is a name or, when m_name is NONE, a number
+	enum class ValueType : std::uint32_t { BOOLEAN, INTEGER, NUMBER, STRING, TABLE };
+	struct GlobalRecord
+	{
+		std::uint32_t m_parent;
+		std::uint32_t m_name;
+		ValueType m_type;
+		std::uint32_t m_string;
+		double m_index;
+		double m_number;
+	};
+
+	struct TransformRecord { std::uint32_t m_entity; std::uint32_t m_isPositionRandom; glm::vec2 m_position; glm::vec2 m_scale; double m_rotation; };
+	struct RigidbodyRecord { std::uint32_t m_entity; float m_timeToStopInSecs; glm::vec2 m_velocity; };
+	struct SpriteRecord
+	{
+		std::uint32_t m_entity;
+		std::uint32_t m_assetId;
+		std::uint32_t m_width;
+		std::uint32_t m_height;
+		std::uint32_t m_zIndex;
+		std::uint32_t m_isFixed;
+		std::int32_t m_srcRectX;
+		std::int32_t m_srcRectY;
+	};
+	struct AnimationRecord { std::uint32_t m_entity; std::int32_t m_numFrames; std::int32_t m_speedRate; };
+	struct BoxColliderRecord { std::uint32_t m_entity; std::uint32_t m_width; std::uint32_t m_height; glm::vec2 m_offset; };
+	struct HealthRecord { std::uint32_t m_entity; std::int32_t m_healthPercentage; };
+	struct ProjectileEmitterRecord
+	{
+		std::uint32_t m_entity;
+		glm::vec2 m_velocity;
+		std::int32_t m_frequencyInMs;
+		std::int32_t m_damagePercentage;
+		std::uint32_t m_shouldCollideWithPlayer;
+		std::int32_t m_minVelocityMagnitude;
+		std::int32_t m_maxVelocityMagnitude;
+		float m_timeToReachMaxVelocityInSecs;
+	};
+	struct KeyboardControlledRecord { std::uint32_t m_entity; glm::vec2 m_upVelocity; glm::vec2 m_rightVelocity; glm::vec2 m_downVelocity; glm::vec2 m_leftVelocity; };
+	// indices in m_functions, NONE for the scripts the entity does not have
+	struct ScriptRecord { std::uint32_t m_entity; std::uint32_t m_script; std::uint32_t m_batchScript; std::uint32_t m_behaviour; };
+
+	// the index of the string in m_strings, added the first time
+	std::uint32_t Intern(const std::string& string);
+	// the index of the function in m_functions, a function shared by several entities (batch scripts) is stored once
+	std::uint32_t AddFunction(const sol::function& function);
+	const std::string& GetString(std::uint32_t index) const { return m_strings.at(index); }
+
+	// false, with the reason in 'error', when a script function cannot be written: only the functions that use nothing
+	// but globals can be, the locals of the level script they capture do not exist any more when the level is loaded
+	bool Write(const std::string& path, std::string& error) const;
+	// the functions are loaded into 'lua'. False with the reason in 'error' when the data is not a level compiled by this build
+	bool Read(const char* data, std::size_t size, sol::state& lua, std::string& error);
+	// the file is read in one block (or found in the archive when it is packed)
+	bool Load(const std::string& path, const AssetArchive* archive, sol::state& lua, std::string& error);
+
+	// hash of the script the level was compiled from, a level older than its script is not loaded
+	std::uint64_t m_sourceHash = 0;
+	WindowRecord m_window{ 0, 0 };
+	std::vector<std::string> m_strings;
+	std::vector<sol::function> m_functions;
+	std::vector<GlobalRecord> m_globals;
+
+	std::vector<TextureRecord> m_textures;
+	std::vector<FontRecord> m_fonts;
+	// at most one
+	std::vector<TilemapRecord> m_tilemaps;
+
+	std::vector<EntityRecord> m_entities;
+	std::vector<TransformRecord> m_transforms;
+	std::vector<RigidbodyRecord> m_rigidbodies;
+	std::vector<SpriteRecord> m_sprites;
+	std::vector<AnimationRecord> m_animations;
+	std::vector<BoxColliderRecord> m_boxColliders;
+	std::vector<HealthRecord> m_healths;
+	std::vector<ProjectileEmitterRecord> m_projectileEmitters;
+	std::vector<std::uint32_t> m_cameraFollowEntities;
+	std::vector<KeyboardControlledRecord> m_keyboardControlled;
+	std::vector<std::uint32_t> m_dummyCharacterEntities;
+	std::vector<ScriptRecord> m_scripts;
+private:
+	// the indices of the records are in range, a level read from a damaged file could make the loader read anywhere
+	bool AreReferencesValid() const;
+
+	std::unordered_map<std::string, std::uint32_t> m_stringIndices;
+};
@@ -0,0 +1,251 @@
+#include "pch.h"
+
+#include "ComponentReaders.h"
+
+#include "Game/CompiledLevel.h"
+#include "Logger/Logger.h"
+
+namespace
+{
+	// "name = { x = ..., y = ... }", a missing coordinate keeps the one of the default
+	glm::vec2 ReadVector(const sol::table& table, const char* name, const glm::vec2& defaultVector = glm::vec2(0, 0))
+	{
+		const sol::optional<sol::table> vector = table[name];
+		if (vector == sol::nullopt)
+		{
+			return defaultVector;
+		}
+		return glm::vec2(vector->get_or("x", defaultVector.x), vector->get_or("y", defaultVector.y));
+	}
+
+	// the three scripts of an entity share its record
+	ComponentReaders::Reader ReadScript(std::uint32_t CompiledLevel::ScriptRecord::* function)
+	{
+		return [function](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+		{
+			if (level.m_scripts.empty() || level.m_scripts.back().m_entity != entity)
+			{
+				level.m_scripts.push_back(CompiledLevel::ScriptRecord{ entity, CompiledLevel::NONE, CompiledLevel::NONE, CompiledLevel::NONE });
+			}
+			const sol::function script = component[0];
+			if (script.valid())
+			{
+				level.m_scripts.back().*function = level.AddFunction(script);
+			}
+		};
+	}
+}
+
+// the fields the levels have to give are 0 when they are missing, as they were before the readers
+ComponentReaders::ComponentReaders()
+{
+	// an unspecified position is picked when the level is created
+	Add("transform", [](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+	{
+		const sol::optional<sol::table> position = component["position"];
+		CompiledLevel::TransformRecord record;
+		record.m_entity = entity;
+		record.m_isPositionRandom = position == sol::nullopt ? 1 : 0;
+		record.m_position = ReadVector(component, "position");
+		record.m_scale = ReadVector(component, "scale", glm::vec2(1, 1));
+		record.m_rotation = component.get_or("rotation", 0.);
+		level.m_transforms.push_back(record);
+	});
+
+	Add("rigidbody", [](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+	{
+		level.m_rigidbodies.push_back(CompiledLevel::RigidbodyRecord{ entity, component.get_or("time_to_stop_in_secs", 0.f), ReadVector(component, "velocity") });
+	});
+
+	Add("sprite", [](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+	{
+		CompiledLevel::SpriteRecord record;
+		record.m_entity = entity;
+		record.m_assetId = level.Intern(component.get_or<std::string>("texture_asset_id", ""));
+		record.m_width = component.get_or("width", 0u);
+		record.m_height = component.get_or("height", 0u);
+		record.m_zIndex = component.get_or("z_index", 1u);
+		record.m_isFixed = component.get_or("fixed", false) ? 1 : 0;
+		record.m_srcRectX = static_cast<Uint16>(component.get_or("src_rect_x", 0));
+		record.m_srcRectY = static_cast<Uint16>(component.get_or("src_rect_y", 0));
+		level.m_sprites.push_back(record);
+	});
+
+	Add("animation", [](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+	{
+		level.m_animations.push_back(CompiledLevel::AnimationRecord{ entity, component.get_or("num_frames", 1), component.get_or("speed_rate", 1) });
+	});
+
+	// an unspecified size is left to CompleteRecords(), the sprite or the transform can come from a prefab
+	Add("box_collider", [](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+	{
+		const auto readSize = [&](const char* name) -> std::uint32_t
+		{
+			const sol::optional<int> size = component[name];
+			return size != sol::nullopt ? static_cast<Uint16>(*size) : CompiledLevel::NONE;
+		};
+
+		CompiledLevel::BoxColliderRecord record;
+		record.m_entity = entity;
+		record.m_width = readSize("width");
+		record.m_height = readSize("height");
+		record.m_offset = ReadVector(component, "offset");
+		level.m_boxColliders.push_back(record);
+	});
+
+	Add("health", [](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+	{
+		level.m_healths.push_back(CompiledLevel::HealthRecord{ entity, component.get_or("health_percentage", 100) });
+	});
+
+	Add("projectile_emitter", [](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+	{
+		CompiledLevel::ProjectileEmitterRecord record;
+		record.m_entity = entity;
+		record.m_velocity = ReadVector(component, "projectile_velocity");
+		record.m_frequencyInMs = static_cast<int>(component.get_or("repeat_frequency", 1.f) * 1000);
+		record.m_damagePercentage = component.get_or("hit_percentage_damage", 10);
+		record.m_shouldCollideWithPlayer = component.get_or("should_collide_with_player", false) ? 1 : 0;
+		record.m_minVelocityMagnitude = component.get_or("min_velocity_magnitude", 0);
+		record.m_maxVelocityMagnitude = component.get_or("max_velocity_magnitude", 0);
+		record.m_timeToReachMaxVelocityInSecs = component.get_or("time_to_reach_max_velocity_in_secs", 0.f);
+		level.m_projectileEmitters.push_back(record);
+	});
+
+	Add("camera_follow", [](const sol::table&, std::uint32_t entity, CompiledLevel& level)
+	{
+		level.m_cameraFollowEntities.push_back(entity);
+	});
+
+	Add("keyboard_controller", [](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+	{
+		level.m_keyboardControlled.push_back(CompiledLevel::KeyboardControlledRecord{
+			entity,
+			ReadVector(component, "up_velocity"),
+			ReadVector(component, "right_velocity"),
+			ReadVector(component, "down_velocity"),
+			ReadVector(component, "left_velocity")
+			});
+	});
+
+	Add("dummy_character", [](const sol::table&, std::uint32_t entity, CompiledLevel& level)
+	{
+		level.m_dummyCharacterEntities.push_back(entity);
+	});
+
+	// entities given the same batch function are updated by one call and behaviours run as coroutines that can wait
+	Add("on_update_script", ReadScript(&CompiledLevel::ScriptRecord::m_script));
+	Add("on_update_batch_script", ReadScript(&CompiledLevel::ScriptRecord::m_batchScript));
+	Add("behaviour_script", ReadScript(&CompiledLevel::ScriptRecord::m_behaviour));
+}
+
+void ComponentReaders::Add(const std::string& componentName, Reader reader)
+{
+	const auto existingReader = m_readerIndices.find(componentName);
+	if (existingReader != m_readerIndices.end())
+	{
+		m_readers[existingReader->second].m_read = std::move(reader);
+		return;
+	}
+	m_readerIndices.emplace(componentName, m_readers.size());
+	m_readers.push_back(NamedReader{ componentName, std::move(reader) });
+}
+
+void ComponentReaders::Read(const sol::table& components, std::uint32_t entity, CompiledLevel& level) const
+{
+	// the tables of the components, by reader
+	std::vector<sol::table> componentTables(m_readers.size());
+	for (const auto& component : components)
+	{
+		const std::string componentName = component.first.get_type() == sol::type::string ? component.first.as<std::string>() : "?";
+		const auto reader = m_readerIndices.find(componentName);
+		if (reader == m_readerIndices.end() || component.second.get_type() != sol::type::table)
+		{
+			Logger::Error("LevelLoader: the component '" + componentName + "' of the entity " + std::to_string(entity) + " is not a table with a reader, it is ignored");
+			continue;
+		}
+		componentTables[reader->second] = component.second.as<sol::table>();
+	}
+
+	for (std::size_t i = 0; i < m_readers.size(); i++)
+	{
+		if (componentTables[i].valid())
+		{
+			m_readers[i].m_read(componentTables[i], entity, level);
+		}
+	}
+}
+
+void ComponentReaders::CompleteRecords(CompiledLevel& level) const
+{
+	// the record of each entity record, its own one or else the one of its prefab (read before it)
+	const auto findRecords = [&level](const auto& records)
+	{
+		std::vector<std::uint32_t> recordIndices(level.m_entities.size(), CompiledLevel::NONE);
+		for (std::size_t i = 0; i < records.size(); i++)
+		{
+			recordIndices[records[i].m_entity] = static_cast<std::uint32_t>(i);
+		}
+		for (std::size_t entity = 0; entity < level.m_entities.size(); entity++)
+		{
+			const std::uint32_t prefab = level.m_entities[entity].m_prefab;
+			if (recordIndices[entity] == CompiledLevel::NONE && prefab != CompiledLevel::NONE)
+			{
+				recordIndices[entity] = recordIndices[prefab];
+			}
+		}
+		return recordIndices;
+	};
+	const std::vector<std::uint32_t> sprites = findRecords(level.m_sprites);
+	const std::vector<std::uint32_t> transforms = findRecords(level.m_transforms);
+	const std::vector<std::uint32_t> boxColliders = findRecords(level.m_boxColliders);
+	// the sizes as the level gave them, the records of the prefabs are completed before their instances are
+	const std::vector<CompiledLevel::BoxColliderRecord> readBoxColliders = level.m_boxColliders;
+
+	for (std::uint32_t entity = 0; entity < level.m_entities.size(); entity++)
+	{
+		const std::uint32_t boxColliderIndex = boxColliders[entity];
+		if (boxColliderIndex == CompiledLevel::NONE) continue;
+		CompiledLevel::BoxColliderRecord boxCollider = readBoxColliders[boxColliderIndex];
+		if (boxCollider.m_width != CompiledLevel::NONE && boxCollider.m_height != CompiledLevel::NONE) continue;
+
+		// an instance with the sprite and the transform of its prefab keeps the prefab's box collider
+		const std::uint32_t prefab = level.m_entities[entity].m_prefab;
+		const bool isPrefabBoxCollider = boxCollider.m_entity != entity;
+		if (isPrefabBoxCollider && sprites[entity] == sprites[prefab] && transforms[entity] == transforms[prefab]) continue;
+
+		// a prefab may get its sprite or its transform from each of its instances, only the entities log the missing ones
+		const bool isPrefab = level.m_entities[entity].m_count == 0;
+		const bool hasSpriteAndTransform = sprites[entity] != CompiledLevel::NONE && transforms[entity] != CompiledLevel::NONE;
+		const auto completeSize = [&](std::uint32_t& size, const char* name, std::uint32_t spriteSize, float scale)
+		{
+			if (size != CompiledLevel::NONE)
+			{
+				return;
+			}
+			if (hasSpriteAndTransform)
+			{
+				if (!isPrefab) Logger::InitInfo(std::string("[BOX COLLIDER] boxCollider created with defaultly calculated ") + name);
+				size = static_cast<Uint16>(spriteSize * scale);
+				return;
+			}
+			if (!isPrefab) Logger::Error(std::string("[BOX COLLIDER] boxCollider could not calculate ") + name + " because entity does not have both Sprite or Transform components");
+			size = 1;
+		};
+		const CompiledLevel::SpriteRecord* sprite = hasSpriteAndTransform ? &level.m_sprites[sprites[entity]] : nullptr;
+		const CompiledLevel::TransformRecord* transform = hasSpriteAndTransform ? &level.m_transforms[transforms[entity]] : nullptr;
+		completeSize(boxCollider.m_width, "width", sprite ? sprite->m_width : 0, transform ? transform->m_scale.x : 0);
+		completeSize(boxCollider.m_height, "height", sprite ? sprite->m_height : 0, transform ? transform->m_scale.y : 0);
+
+		// otherwise the instance gets a box collider of its own, replacing the prefab's one
+		if (isPrefabBoxCollider)
+		{
+			boxCollider.m_entity = entity;
+			level.m_boxColliders.push_back(boxCollider);
+		}
+		else
+		{
+			level.m_boxColliders[boxColliderIndex] = boxCollider;
+		}
+	}
+}
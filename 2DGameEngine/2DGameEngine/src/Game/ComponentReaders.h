@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+
+#include <sol/sol.hpp>
+
+class CompiledLevel;
+
+// The readers of the component tables of the level entities ("transform = {...}", "sprite = {...}"), by component name.
+// A reader gets the table of its component, already resolved, and adds the records of the component to the level.
+// The components of an entity are found in one pass over its table, a name without a reader is logged
+class ComponentReaders
+{
+public:
+	using Reader = std::function<void(const sol::table& component, std::uint32_t entity, CompiledLevel& level)>;
+
+	// with the readers of the engine's components
+	ComponentReaders();
+
+	// the readers run in the order they were added, a reader can use the records of the components read before it.
+	// Adding a reader with the name of another one replaces it
+	void Add(const std::string& componentName, Reader reader);
+
+	void Read(const sol::table& components, std::uint32_t entity, CompiledLevel& level) const;
+
+	// once every entity is read: what depends on components an instance may get from its prefab. A box collider without
+	// a size gets the one of the entity's sprite scaled by its transform, whichever of the two records they come from
+	void CompleteRecords(CompiledLevel& level) const;
+private:
+	struct NamedReader
+	{
+		std::string m_componentName;
+		Reader m_read;
+	};
+
+	std::vector<NamedReader> m_readers;
+	std::unordered_map<std::string, std::size_t> m_readerIndices;
+};
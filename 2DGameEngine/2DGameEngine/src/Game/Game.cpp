@@ -2,8 +2,12 @@
 
 #include "Game.h"
 
+#include <filesystem>
+
 #include "Logger/Logger.h"
 #include "Game/LevelLoader.h"
+#include "Game/LuaBackend.h"
+#include "AssetStore/RawTexture.h"
 
 #include "Systems/MovementSystem.h"
 #include "Systems/RenderSystem.h"
@@ -19,6 +23,7 @@
 #include "Systems/RenderHealthBarSystem.h"
 #include "Systems/RenderGUISystem.h"
 #include "Systems/ScriptSystem.h"
+#include "Systems/TilemapStreamingSystem.h"
 
 #include "Events/LeftMouseButtonDownEvent.h"
 #include "Events/LeftMouseButtonUpEvent.h"
@@ -73,9 +78,10 @@ void Game::Initialize()
         return;
     }
 
-    // init renderer
-    m_renderer = SDL_CreateRenderer(m_window, -1, 0);
-    if (!m_renderer)
+    // init renderer, on the thread that is going to use it (see RenderThread).
+    // The window stays on this thread, its events are pumped by ProcessInput()
+    m_renderThread = std::make_unique<RenderThread>([this]() { return SDL_CreateRenderer(m_window, -1, 0); });
+    if (!m_renderThread->Start(CONST::RENDERING::USE_RENDER_THREAD))
     {
         Logger::Error("Error creating SDL renderer");
         return;
@@ -83,7 +89,10 @@ void Game::Initialize()
 
     // initialize Imgui
     ImGui::CreateContext();
-    ImGuiSDL::Initialize(m_renderer, m_windowWidth, m_windowHeight);
+    m_renderThread->Run([](SDL_Renderer* renderer)
+    {
+        ImGuiSDL::Initialize(renderer, m_windowWidth, m_windowHeight);
+    });
 
     // initialize the camera view with the entire screen area
     SDL_Rect dsd{ 0,0, m_windowWidth, m_windowHeight };
@@ -153,13 +162,45 @@ void Game::Setup()
     m_registry->AddSystem<RenderHealthBarSystem>();
     m_registry->AddSystem<RenderGUISystem>();
     m_registry->AddSystem<ScriptSystem>();
+    m_registry->AddSystem<TilemapStreamingSystem>();
 
     m_registry->GetSystem<ScriptSystem>().CreateLuaFunctionBindings(m_lua);
+    // the entity scripts cannot overwrite each other's globals nor stall a frame
+    m_registry->GetSystem<ScriptSystem>().SetSandboxed(true);
+    m_registry->GetSystem<ScriptSystem>().SetInstructionBudget(CONST::SCRIPTS::INSTRUCTION_BUDGET);
+
+    // the systems keep their subscriptions for as long as they live
+    m_registry->GetSystem<MovementSystem>().SubscribeToEvents(m_eventBus);
+    m_registry->GetSystem<DamageSystem>().SubscribeToEvents(m_eventBus);
+    m_registry->GetSystem<KeyboardControlSystem>().SubscribeToEvents(m_eventBus);
+    m_registry->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(m_eventBus);
 
-    LevelLoader levelLoader;
-    m_lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::os);
-   // levelLoader.LoadLevel(2, m_registry, m_assetStore, m_renderer, m_lua);
-    levelLoader.LoadLevel("PlayerPrototype", m_registry, m_assetStore, m_renderer, m_lua);
+    // shipping builds read their assets from the archive, the ones in development from the files
+    if (std::filesystem::exists(CONST::ARCHIVE::ARCHIVE_PATH))
+    {
+        m_assetStore->MountArchive(CONST::ARCHIVE::ARCHIVE_PATH);
+    }
+
+    LuaBackend::OpenLibraries(m_lua);
+    Logger::Log(std::string("scripts run on ") + LuaBackend::GetName());
+    // the textures are created with the renderer
+    m_renderThread->Run([this](SDL_Renderer* renderer)
+    {
+       // m_levelLoader.LoadLevel(2, m_registry, m_assetStore, renderer, m_lua);
+        m_levelLoader.LoadLevel("PlayerPrototype", m_registry, m_assetStore, renderer, m_lua);
+    });
+
+    // the files of an archive do not change
+    if (CONST::HOT_RELOAD::IS_ENABLED && !m_assetStore->HasArchive())
+    {
+        const bool areScriptsWatched = m_fileWatcher.Watch(CONST::SCRIPTS::SCRIPTS_DIRECTORY, { ".lua" });
+        const bool areImagesWatched = m_fileWatcher.Watch(CONST::RAW_TEXTURES::IMAGES_DIRECTORY, { ".png", ".jpg" });
+        m_isHotReloadEnabled = areScriptsWatched || areImagesWatched;
+        Logger::Log(std::string("hot reload of the scripts and images, the changes are ") + (m_fileWatcher.IsUsingNotifications() ? "notified" : "polled"));
+    }
+    // the tiles in view exist before the first frame is drawn
+    m_registry->Update();
+    m_registry->GetSystem<TilemapStreamingSystem>().Update(m_registry, *m_camera);
     SDL_SetWindowSize(m_window, Game::m_windowWidth, Game::m_windowHeight);
     SDL_SetWindowPosition(m_window, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
 
@@ -179,8 +220,8 @@ void Game::Setup()
             Logger::Error("background color not defined on level definition file. Should be [\"level_setup\"][\"background_color\"]");
             backgroundColor = SDL_Color{ 200, 200, 200, 255 };
         }
+        // set on the renderer by the clear command of every frame
         m_backgroundColor = std::make_unique<SDL_Color>(backgroundColor);
-        SDL_SetRenderDrawColor(m_renderer, m_backgroundColor->r, m_backgroundColor->g, m_backgroundColor->b, m_backgroundColor->a);
     }
     
 }
@@ -200,30 +241,76 @@ void Game::Update()
     double deltaTime = (SDL_GetTicks() - m_millisecondsPreviousFrame) * 0.001f;
     m_millisecondsPreviousFrame = SDL_GetTicks();
     
-    // subscription to events will only be alive during one frame
-    // suboptimal, should def be changed
-    m_eventBus->Reset();
-    m_registry->GetSystem<MovementSystem>().SubscribeToEvents(m_eventBus);
-    m_registry->GetSystem<DamageSystem>().SubscribeToEvents(m_eventBus);
-    m_registry->GetSystem<KeyboardControlSystem>().SubscribeToEvents(m_eventBus);
-    m_registry->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(m_eventBus);
-
     // update the registry to add or remove entities that were waiting for the end of the frame
     m_registry->Update();
 
+    if (m_isHotReloadEnabled)
+    {
+        ReloadChangedFiles();
+    }
+
     m_registry->GetSystem<KeyboardControlSystem>().Update(deltaTime);
     m_registry->GetSystem<MovementSystem>().Update(deltaTime);
     m_registry->GetSystem<AnimationSystem>().Update();
     m_registry->GetSystem<CollisionSystem>().Update(m_eventBus);
+    // damage and collision responses run here, after every collider was checked
+    m_eventBus->DispatchQueuedEvents();
     m_registry->GetSystem<ProjectileEmitSystem>().Update(m_registry);
     m_registry->GetSystem<ProjectileLifeCycleSystem>().Update(deltaTime);
     m_registry->GetSystem<CameraMovementSystem>().Update(*m_camera);
+    m_registry->GetSystem<TilemapStreamingSystem>().Update(m_registry, *m_camera);
     m_registry->GetSystem<ScriptSystem>().Update(deltaTime, SDL_GetTicks());
 }
 
+// the scripts of the level entities and the textures are replaced in place, the registry is kept as it is
+void Game::ReloadChangedFiles()
+{
+    const std::vector<std::string> changedFiles = m_fileWatcher.PollChanges();
+    if (changedFiles.empty())
+    {
+        return;
+    }
+
+    const Uint32 reloadStart = SDL_GetTicks();
+    bool hasLevelScriptChanged = false;
+    std::vector<std::string> changedImages;
+    for (const auto& changedFile : changedFiles)
+    {
+        if (std::filesystem::path(changedFile).extension() == ".lua")
+        {
+            // the scripts of the other levels are read when their level is loaded
+            hasLevelScriptChanged = hasLevelScriptChanged || m_levelLoader.IsLoadedLevelScript(changedFile);
+        }
+        else
+        {
+            changedImages.push_back(changedFile);
+        }
+    }
+
+    // the textures are created with the renderer, on its thread. The frames submitted before are drawn first,
+    // the next ones are recorded once every texture was replaced
+    if (!changedImages.empty())
+    {
+        m_renderThread->Run([this, &changedImages](SDL_Renderer* renderer)
+        {
+            for (const auto& changedImage : changedImages)
+            {
+                m_assetStore->ReloadTextures(renderer, changedImage);
+            }
+        });
+    }
+
+    if (hasLevelScriptChanged)
+    {
+        m_levelLoader.ReloadLevelScripts(m_registry, m_lua);
+    }
+    Logger::Log("hot reload of " + std::to_string(changedFiles.size()) + " files in " + std::to_string(SDL_GetTicks() - reloadStart) + " ms");
+}
+
 void Game::Run()
 {
     Setup();
+
     while (m_IsRunning)
     {
         ProcessInput();
@@ -234,26 +321,36 @@ void Game::Run()
 
 void Game::Render()
 {
-    SDL_SetRenderDrawColor(m_renderer, m_backgroundColor->r, m_backgroundColor->g, m_backgroundColor->b, m_backgroundColor->a);
-    SDL_RenderClear(m_renderer);
+    // systems only record commands here, the SDL calls happen when the frame is submitted
+    // (on the render thread while the next frame is simulated, see RenderThread)
+    auto& commandList = m_renderThread->GetRecordingList();
+    commandList.AddClear(*m_backgroundColor);
 
-    m_registry->GetSystem<RenderSystem>().Update(m_renderer, m_assetStore, *m_camera);
-    m_registry->GetSystem<RenderTextSystem>().Update(m_assetStore, m_renderer, *m_camera);
-    m_registry->GetSystem<RenderHealthBarSystem>().Update(m_renderer, m_assetStore, *m_camera);
+    m_registry->GetSystem<RenderSystem>().Update(commandList, m_assetStore, *m_camera);
+    m_registry->GetSystem<RenderTextSystem>().Update(m_assetStore, commandList, *m_camera);
+    m_registry->GetSystem<RenderHealthBarSystem>().Update(commandList, m_assetStore, *m_camera);
     if (m_shouldRenderDebug)
     {
-        m_registry->GetSystem<RenderColliderSystem>().Update(m_renderer, *m_camera);
+        m_registry->GetSystem<RenderColliderSystem>().Update(commandList, *m_camera);
         //m_registry->GetSystem<RenderGUISystem>().Update(m_registry, m_assetStore, *m_camera);
     }
 
-    SDL_RenderPresent(m_renderer);
+    m_renderThread->SubmitFrame();
 }
 
 void Game::Destroy()
 {
-    ImGuiSDL::Deinitialize();
+    // the textures and the renderer are destroyed on the thread that created them
+    if (m_renderThread)
+    {
+        m_renderThread->Run([this](SDL_Renderer*)
+        {
+            m_assetStore->ClearAssets();
+            ImGuiSDL::Deinitialize();
+        });
+        m_renderThread.reset();
+    }
     ImGui::DestroyContext();
-    SDL_DestroyRenderer(m_renderer);
     SDL_DestroyWindow(m_window);
     SDL_Quit();
 }
\ No newline at end of file
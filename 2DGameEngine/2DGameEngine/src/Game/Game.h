@@ -6,6 +6,9 @@
 #include "ECS/ECS.h"
 #include "AssetStore/AssetStore.h"
 #include "EventBus/EventBus.h"
+#include "Renderer/RenderThread.h"
+#include "Game/LevelLoader.h"
+#include "FileWatcher/FileWatcher.h"
 
 namespace CONST
 {
@@ -21,6 +24,11 @@ namespace CONST
 		constexpr auto pico_8 = "pico8-font-8";
 		constexpr auto pico_10 = "pico8-font-10";
 	}
+	namespace HOT_RELOAD
+	{
+		// the level scripts and the images edited while the game runs are reloaded, only when the assets are read from the disk
+		constexpr bool IS_ENABLED = true;
+	}
 }
 //
 struct SDL_Window;
@@ -48,9 +56,9 @@ private:
 	void Render();
 
 	void Setup();
+	void ReloadChangedFiles();
 
 	SDL_Window* m_window = nullptr;
-	SDL_Renderer* m_renderer = nullptr;
 	
 	sol::state m_lua;
 	
@@ -59,6 +67,11 @@ private:
 	std::unique_ptr<Registry> m_registry;
 	std::unique_ptr<AssetStore> m_assetStore;
 	std::unique_ptr<EventBus> m_eventBus;
+	std::unique_ptr<RenderThread> m_renderThread;
+
+	LevelLoader m_levelLoader;
+	FileWatcher m_fileWatcher;
+	bool m_isHotReloadEnabled = false;
 
 	bool m_IsRunning = false; 
 	int m_millisecondsPreviousFrame = 0;
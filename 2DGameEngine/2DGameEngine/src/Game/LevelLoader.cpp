@@ -2,9 +2,18 @@
 
 #include "LevelLoader.h"
 
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <unordered_set>
+
 #include "Game/Game.h"
+#include "Game/ScriptCache.h"
+#include "Game/LuaBackend.h"
 #include "ECS/ECS.h"
 #include "AssetStore/AssetStore.h"
+#include "AssetStore/AssetArchive.h"
 
 #include "Components/TransformComponent.h"
 #include "Components/RigidbodyComponent.h"
@@ -18,6 +27,9 @@
 #include "Components/TextLabelComponent.h"
 #include "Components/ScriptComponent.h"
 #include "Components/DummyCharacterComponent.h"
+#include "Components/TilemapComponent.h"
+
+#include "Systems/ScriptSystem.h"
 
 #include "HelperFunctions.h"
 
@@ -31,41 +43,199 @@ namespace CONST
     }
 }
 
-LevelLoader::LevelLoader()
+LevelLoader::LevelLoader(const std::string& scriptsDirectory, const std::string& compiledLevelsDirectory)
+    : m_scriptsDirectory(scriptsDirectory)
+    , m_compiledLevelsDirectory(compiledLevelsDirectory)
 {
 }
 
 void LevelLoader::LoadLevel(const std::string& levelToLoad, const std::unique_ptr<Registry>& registry, std::unique_ptr<AssetStore>& assetStore, SDL_Renderer* renderer, sol::state& lua)
 {
-    ParseLevel("./assets/scripts/" + levelToLoad + ".lua", registry, assetStore, renderer, lua);
+    CompiledLevel level;
+    m_wasCompiledLevelLoaded = ReadCompiledLevel(levelToLoad, &assetStore->GetArchive(), lua, level);
+    if (!m_wasCompiledLevelLoaded)
+    {
+        // a compiled level older than its script was read before being rejected
+        level = CompiledLevel();
+        if (!ReadLevelScript(m_scriptsDirectory + levelToLoad + ".lua", lua, level))
+        {
+            return;
+        }
+    }
+    CreateLevel(level, registry, assetStore, renderer, lua);
+    m_loadedLevel = levelToLoad;
 }
 
 void LevelLoader::LoadLevel(unsigned int levelToLoad, const std::unique_ptr<Registry>& registry, std::unique_ptr<AssetStore>& assetStore, SDL_Renderer* renderer, sol::state& lua)
 {
-    // this call will check the script's syntax before executing it potentially avoid abortion
-    // of the program if something went wrong by simply spitting a message out
-    sol::load_result script = lua.load_file("./assets/scripts/Level" + std::to_string(levelToLoad) + ".lua");
+    LoadLevel("Level" + std::to_string(levelToLoad), registry, assetStore, renderer, lua);
+}
+
+bool LevelLoader::CompileLevel(const std::string& levelToCompile, sol::state& lua) const
+{
+    const std::string scriptPath = m_scriptsDirectory + levelToCompile + ".lua";
+    std::ifstream scriptFile(scriptPath, std::ios::binary);
+    if (!scriptFile)
+    {
+        Logger::Error("LevelLoader: could not open " + scriptPath);
+        return false;
+    }
+    const std::string source((std::istreambuf_iterator<char>(scriptFile)), std::istreambuf_iterator<char>());
+
+    // the globals the script defines are part of the level, the game and the update scripts read them (level_setup, map_height...)
+    std::unordered_set<std::string> existingGlobals;
+    for (const auto& global : lua.globals())
+    {
+        if (global.first.get_type() == sol::type::string)
+        {
+            existingGlobals.insert(global.first.as<std::string>());
+        }
+    }
+
+    CompiledLevel level;
+    if (!ReadLevelScript(scriptPath, lua, level))
+    {
+        return false;
+    }
+    level.m_sourceHash = ScriptCache::CalculateHash(source);
+
+    // tables are written before their fields, the tables already written are skipped (the loops of references)
+    std::unordered_map<const void*, std::uint32_t> writtenTables;
+    std::function<void(std::uint32_t, const sol::object&, const sol::object&)> addGlobal;
+    addGlobal = [&level, &writtenTables, &addGlobal](std::uint32_t parent, const sol::object& key, const sol::object& value)
+    {
+        CompiledLevel::GlobalRecord global{ parent, CompiledLevel::NONE, CompiledLevel::ValueType::NUMBER, CompiledLevel::NONE, 0, 0 };
+        if (key.get_type() == sol::type::string)
+        {
+            global.m_name = level.Intern(key.as<std::string>());
+        }
+        else if (key.get_type() == sol::type::number)
+        {
+            global.m_index = key.as<double>();
+        }
+        else
+        {
+            return;
+        }
+
+        switch (value.get_type())
+        {
+        case sol::type::boolean:
+            global.m_type = CompiledLevel::ValueType::BOOLEAN;
+            global.m_number = value.as<bool>() ? 1 : 0;
+            break;
+        case sol::type::number:
+            global.m_number = value.as<double>();
+#if LUA_VERSION_NUM >= 503
+            value.push();
+            global.m_type = lua_isinteger(value.lua_state(), -1) ? CompiledLevel::ValueType::INTEGER : CompiledLevel::ValueType::NUMBER;
+            lua_pop(value.lua_state(), 1);
+#endif
+            break;
+        case sol::type::string:
+            global.m_type = CompiledLevel::ValueType::STRING;
+            global.m_string = level.Intern(value.as<std::string>());
+            break;
+        case sol::type::table:
+        {
+            if (writtenTables.find(value.pointer()) != writtenTables.end())
+            {
+                return;
+            }
+            global.m_type = CompiledLevel::ValueType::TABLE;
+            const std::uint32_t table = static_cast<std::uint32_t>(level.m_globals.size());
+            writtenTables.emplace(value.pointer(), table);
+            level.m_globals.push_back(global);
+            for (const auto& field : value.as<sol::table>())
+            {
+                addGlobal(table, field.first, field.second);
+            }
+            return;
+        }
+        default:
+            // functions and userdata are not compiled, the functions of the entities are
+            return;
+        }
+        level.m_globals.push_back(global);
+    };
+
+    for (const auto& global : lua.globals())
+    {
+        const bool isNewGlobal = global.first.get_type() == sol::type::string && existingGlobals.find(global.first.as<std::string>()) == existingGlobals.end();
+        if (isNewGlobal && global.first.as<std::string>() != "Level")
+        {
+            addGlobal(CompiledLevel::NONE, global.first, global.second);
+        }
+    }
+
+    const std::string compiledLevelPath = m_compiledLevelsDirectory + levelToCompile + CONST::COMPILED_LEVELS::EXTENSION;
+    std::string error;
+    if (!level.Write(compiledLevelPath, error))
+    {
+        Logger::Error("LevelLoader: could not compile " + levelToCompile + ": " + error);
+        return false;
+    }
+    Logger::Log("LevelLoader: compiled " + scriptPath + " to " + compiledLevelPath + " (" + std::to_string(level.m_entities.size()) + " entities)");
+    return true;
+}
+
+bool LevelLoader::ReadCompiledLevel(const std::string& levelToLoad, const AssetArchive* archive, sol::state& lua, CompiledLevel& level) const
+{
+    const std::string compiledLevelPath = m_compiledLevelsDirectory + levelToLoad + CONST::COMPILED_LEVELS::EXTENSION;
+    const bool isPacked = archive && archive->Find(compiledLevelPath).m_data;
+    if (!isPacked && !std::filesystem::exists(compiledLevelPath))
+    {
+        return false;
+    }
+
+    std::string error;
+    if (!level.Load(compiledLevelPath, archive, lua, error))
+    {
+        Logger::Error("LevelLoader: " + compiledLevelPath + ": " + error + ", loading the script instead");
+        return false;
+    }
+
+    // a shipped game may not have the scripts, a compiled level is only older than its script when they are both there
+    std::string source;
+    if (Helpers::ReadFile(m_scriptsDirectory + levelToLoad + ".lua", source))
+    {
+        if (ScriptCache::CalculateHash(source) != level.m_sourceHash)
+        {
+            Logger::Log("LevelLoader: " + compiledLevelPath + " is older than its script, loading the script instead");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LevelLoader::ReadLevelScript(const std::string& scriptPath, sol::state& lua, CompiledLevel& level) const
+{
+    // the script is compiled once and checked before being executed, a syntax error is logged
+    // instead of aborting the program. The bytecode is cached for the next loads
+    ScriptCache scriptCache;
+    sol::load_result script = scriptCache.Load(lua, scriptPath);
     if (!script.valid())
     {
         sol::error error = script;
         std::string errorMessage = error.what();
         Logger::Error("Error loading lua script: "+ errorMessage);
-        return;
+        return false;
     }
-    ParseLevel("./assets/scripts/Level" + std::to_string(levelToLoad) + ".lua", registry, assetStore, renderer, lua);
-    
-}
 
-void LevelLoader::ParseLevel(const std::string& levelToLoad, const std::unique_ptr<Registry>& registry, std::unique_ptr<AssetStore>& assetStore, SDL_Renderer* renderer, sol::state& lua)
-{
-    // executes script, could verify if the ending is .lua and if not add it here for safety
-    lua.script_file(levelToLoad);
+    sol::protected_function_result result = script();
+    if (!result.valid())
+    {
+        sol::error error = result;
+        std::string errorMessage = error.what();
+        Logger::Error("Error running lua script: " + errorMessage);
+        return false;
+    }
 
-    sol::table level = lua["Level"];
+    sol::table levelTable = lua["Level"];
 
     // read assets
     {
-        sol::table assets = level["assets"];
+        sol::table assets = levelTable["assets"];
         int i = 0;
         while (true)
         {
@@ -81,14 +251,11 @@ void LevelLoader::ParseLevel(const std::string& levelToLoad, const std::unique_p
             const std::string assetId = asset["id"];
             if (assetType == "texture")
             {
-                assetStore->AddTexture(renderer, asset["id"], asset["file"]);
-                Logger::Log("AssetStore: Added texture: " + assetId);
+                level.m_textures.push_back(CompiledLevel::TextureRecord{ level.Intern(assetId), level.Intern(asset["file"]) });
             }
             else if (assetType == "font")
             {
-                const std::string fontSizeAsString = asset["font_size"];
-                assetStore->AddFont(asset["id"], asset["file"], asset["font_size"]);
-                Logger::Log("AssetStore: Added font: " + assetId + " with size: " + fontSizeAsString);
+                level.m_fonts.push_back(CompiledLevel::FontRecord{ level.Intern(assetId), level.Intern(asset["file"]), asset["font_size"].get<int>() });
             }
             i++;
         }
@@ -99,304 +266,608 @@ void LevelLoader::ParseLevel(const std::string& levelToLoad, const std::unique_p
         const int defaultWindowWidth = 1024;
         const int defaultWindowHeight = 768;
 
-        sol::optional windowSetup = lua["window_setup"];
+        const sol::optional<sol::table> windowSetup = lua["window_setup"];
         if (windowSetup != sol::nullopt)
         {
-            sol::optional windowWidth = lua["window_setup"]["width"];
-            sol::optional windowHeight = lua["window_setup"]["height"];
-            
+            const sol::optional<int> windowWidth = (*windowSetup)["width"];
+            const sol::optional<int> windowHeight = (*windowSetup)["height"];
+
             if (windowWidth != sol::nullopt)
             {
-                Game::m_windowWidth = lua["window_setup"]["width"];
+                level.m_window.m_width = *windowWidth;
             }
-            else 
-            { 
-                Game::m_windowWidth = defaultWindowWidth;
+            else
+            {
+                level.m_window.m_width = defaultWindowWidth;
                 Logger::InitInfo("[WINDOW] No window width specified, using default value of " + std::to_string(defaultWindowWidth));
             }
-            
+
             if (windowHeight != sol::nullopt)
             {
-                Game::m_windowHeight = lua["window_setup"]["height"];
+                level.m_window.m_height = *windowHeight;
             }
             else
             {
-                Game::m_windowHeight = defaultWindowHeight;
+                level.m_window.m_height = defaultWindowHeight;
                 Logger::InitInfo("[WINDOW] No window height specified, using default value of " + std::to_string(defaultWindowHeight));
             }
         }
         else
         {
-            Game::m_windowWidth = defaultWindowWidth;
-            Game::m_windowHeight = defaultWindowHeight;
+            level.m_window.m_width = defaultWindowWidth;
+            level.m_window.m_height = defaultWindowHeight;
 
             Logger::InitInfo("[WINDOW] No window dimensions specified, creating window with default values [" + std::to_string(defaultWindowWidth) + ", " + std::to_string(defaultWindowHeight) + "] ");
         }
     }
 
-    // read map 
+    // read map
     {
-        sol::optional<sol::table> tilemap = level["tilemap"];
-        const bool isMapDefined = tilemap != sol::nullopt;
-        if (isMapDefined)
+        sol::optional<sol::table> hasTilemap = levelTable["tilemap"];
+        if (hasTilemap != sol::nullopt)
         {
-            const sol::table tilemap = level["tilemap"];
-            // load tilemap
-            const Uint16 tileSize = tilemap["tile_size"];
-            double tileScale = tilemap["scale"];
-            const Uint16 mapNumCols = tilemap["num_cols"].get_or(0);
-            const Uint16 mapNumRows = tilemap["num_rows"].get_or(0);
+            const sol::table tilemap = levelTable["tilemap"];
+            CompiledLevel::TilemapRecord record;
+            record.m_textureAssetId = level.Intern(tilemap["texture_asset_id"]);
+            record.m_mapFile = level.Intern(tilemap["map_file"]);
+            record.m_tileScale = tilemap["scale"].get<double>();
+
+            // read as Lua numbers, a size the record cannot hold is rejected instead of wrapping around
+            const auto readSize = [&tilemap](const char* key, std::int32_t defaultSize, std::int32_t& size)
+            {
+                const double value = tilemap[key].get_or(static_cast<double>(defaultSize));
+                if (!(value >= 0 && value <= std::numeric_limits<std::int32_t>::max()))
+                {
+                    Logger::Error("LevelLoader: the tilemap " + std::string(key) + " is out of range (" + std::to_string(value) + "), the tilemap is not loaded");
+                    return false;
+                }
+                size = static_cast<std::int32_t>(value);
+                return true;
+            };
+            // the chunks and radii are optional
+            if (readSize("tile_size", 0, record.m_tileSize)
+                && readSize("num_cols", 0, record.m_numberOfColumns)
+                && readSize("num_rows", 0, record.m_numberOfRows)
+                && readSize("chunk_size", CONST::TILEMAP::CHUNK_SIZE, record.m_chunkSize)
+                && readSize("load_radius", CONST::TILEMAP::LOAD_RADIUS, record.m_loadRadius)
+                && readSize("unload_radius", CONST::TILEMAP::UNLOAD_RADIUS, record.m_unloadRadius))
+            {
+                level.m_tilemaps.push_back(record);
+            }
+        }
+    }
+
+    // read entities. A prefab ("prefabs = { tree = { group = ..., components = {...} } }") is read once, before the first
+    // entity made from it ("{ prefab = "tree", count = 10, components = {...} }")
+    {
+        const sol::optional<sol::table> prefabs = levelTable["prefabs"];
+        std::unordered_map<std::string, std::uint32_t> prefabIndices;
+        const auto readPrefab = [&](const std::string& prefabName)
+        {
+            const auto prefabIndex = prefabIndices.find(prefabName);
+            if (prefabIndex != prefabIndices.end())
+            {
+                return prefabIndex->second;
+            }
 
-            const std::string mapPath = tilemap["map_file"];
-            std::fstream mapFile;
-            if (isMapDefined)
+            const sol::optional<sol::table> prefab = prefabs != sol::nullopt ? (*prefabs)[prefabName].get<sol::optional<sol::table>>() : sol::nullopt;
+            std::uint32_t index = CompiledLevel::NONE;
+            if (prefab == sol::nullopt)
             {
-                mapFile.open(mapPath);
+                Logger::Error("LevelLoader: there is no prefab '" + prefabName + "', the entities made from it only have their own components");
+            }
+            else
+            {
+                index = static_cast<std::uint32_t>(level.m_entities.size());
+                CompiledLevel::EntityRecord prefabRecord{ CompiledLevel::NONE, CompiledLevel::NONE, CompiledLevel::NONE, 0 };
+                const sol::optional<std::string> group = (*prefab)["group"];
+                if (group != sol::nullopt)
+                {
+                    prefabRecord.m_group = level.Intern(*group);
+                }
+                level.m_entities.push_back(prefabRecord);
+
+                const sol::optional<sol::table> components = (*prefab)["components"];
+                if (components != sol::nullopt)
+                {
+                    m_componentReaders.Read(*components, index, level);
+                }
             }
+            prefabIndices.emplace(prefabName, index);
+            return index;
+        };
 
-            for (int y = 0; y < mapNumRows; y++)
+        const sol::table entities = levelTable["entities"];
+        for (std::uint32_t i = 0; ; i++)
+        {
+            // entity
+            const sol::optional<sol::table> entity = entities[i];
+            if (entity == sol::nullopt) break;
+            CompiledLevel::EntityRecord entityRecord{ CompiledLevel::NONE, CompiledLevel::NONE, CompiledLevel::NONE, 1 };
+
+            // prefab, the entity gets its group unless it has its own
+            const sol::optional<std::string> prefab = (*entity)["prefab"];
+            if (prefab != sol::nullopt)
             {
-                for (int x = 0; x < mapNumCols; x++)
+                entityRecord.m_prefab = readPrefab(*prefab);
+                if (entityRecord.m_prefab != CompiledLevel::NONE)
                 {
-                    char ch;
-                    mapFile.get(ch);
-                    const int tilemapYIndex = std::atoi(&ch) * tileSize;
-                    mapFile.get(ch);
-                    const int tilemapXIndex = std::atoi(&ch) * tileSize;
-                    mapFile.ignore();
-
-                    Entity tile = registry->CreateEntity();
-                    tile.Tag("tiles");
-                    tile.AddComponent<TransformComponent>(glm::vec2(x * (tileScale * tileSize), y * (tileScale * tileSize)), glm::vec2(tileScale, tileScale), 0);
-                    tile.AddComponent<SpriteComponent>(tilemap["texture_asset_id"], tileSize, tileSize, 0, false, tilemapXIndex, tilemapYIndex);
+                    entityRecord.m_group = level.m_entities[entityRecord.m_prefab].m_group;
                 }
             }
-            mapFile.close();
 
-            Game::m_mapWidth = tileSize * tileScale * mapNumCols;
-            Game::m_mapHeight = tileSize * tileScale * mapNumRows;
+            // count, the number of entities created from the table
+            const int count = (*entity)["count"].get_or(1);
+            if (count < 1)
+            {
+                Logger::Error("LevelLoader: the entity " + std::to_string(i) + " has a count of " + std::to_string(count) + ", one is created");
+            }
+            entityRecord.m_count = static_cast<std::uint32_t>(std::max(count, 1));
+
+            // tag
+            const sol::optional<std::string> tag = (*entity)["tag"];
+            if (tag != sol::nullopt && entityRecord.m_count > 1)
+            {
+                Logger::Error("LevelLoader: the entity " + std::to_string(i) + " is created " + std::to_string(count) + " times, its tag '" + *tag + "' is ignored");
+            }
+            else if (tag != sol::nullopt)
+            {
+                entityRecord.m_tag = level.Intern(*tag);
+            }
+
+            // group
+            const sol::optional<std::string> group = (*entity)["group"];
+            if (group != sol::nullopt)
+            {
+                entityRecord.m_group = level.Intern(*group);
+            }
+            const std::uint32_t entityIndex = static_cast<std::uint32_t>(level.m_entities.size());
+            level.m_entities.push_back(entityRecord);
+
+            // components, each one is read by the reader registered for its name
+            const sol::optional<sol::table> components = (*entity)["components"];
+            if (components != sol::nullopt)
+            {
+                m_componentReaders.Read(*components, entityIndex, level);
+            }
         }
-        else
+        m_componentReaders.CompleteRecords(level);
+    }
+    return true;
+}
+
+namespace
+{
+    ScriptComponent CreateScriptComponent(const CompiledLevel& level, const CompiledLevel::ScriptRecord& script)
+    {
+        const auto getFunction = [&level](std::uint32_t function)
+        {
+            return function != CompiledLevel::NONE ? level.m_functions[function] : sol::function(sol::lua_nil);
+        };
+        return ScriptComponent(getFunction(script.m_script), getFunction(script.m_batchScript), getFunction(script.m_behaviour));
+    }
+
+    // the script of each entity record, the instances of a prefab without a script of their own have the prefab's one.
+    // Every function of a record without a script is NONE
+    std::vector<CompiledLevel::ScriptRecord> ResolveScripts(const CompiledLevel& level)
+    {
+        const CompiledLevel::ScriptRecord noScript{ CompiledLevel::NONE, CompiledLevel::NONE, CompiledLevel::NONE, CompiledLevel::NONE };
+        std::vector<CompiledLevel::ScriptRecord> scripts(level.m_entities.size(), noScript);
+        for (const auto& script : level.m_scripts)
+        {
+            scripts[script.m_entity] = script;
+        }
+        // the prefabs are read before the entities made from them
+        for (std::size_t i = 0; i < level.m_entities.size(); i++)
         {
-            Game::m_mapWidth = 1024;
-            Game::m_mapHeight = 768;
+            const std::uint32_t prefab = level.m_entities[i].m_prefab;
+            if (scripts[i].m_entity == CompiledLevel::NONE && prefab != CompiledLevel::NONE)
+            {
+                scripts[i] = scripts[prefab];
+            }
         }
+        return scripts;
+    }
 
+    // the bytecode without the lines and the names, moving a function in the script does not change it. None when the
+    // function cannot be compared: a C function, or one capturing locals of the level script, their values are not in
+    // its bytecode (LuaJIT always keeps the lines, a function moved there is replaced too)
+    std::optional<std::string> DumpForComparison(const sol::function& function)
+    {
+        lua_State* L = function.lua_state();
+        function.push();
+        bool isComparable = !lua_iscfunction(L, -1);
+        for (int i = 1; isComparable; i++)
+        {
+            const char* upvalueName = lua_getupvalue(L, -1, i);
+            if (upvalueName == nullptr)
+            {
+                break;
+            }
+            lua_pop(L, 1);
+            isComparable = i == 1 && std::string(upvalueName) == "_ENV";
+        }
+        lua_pop(L, 1);
+
+        std::string bytecode;
+        if (!isComparable || function.dump(&LuaBackend::WriteBytecode, &bytecode, true, [](lua_State*, int result, lua_Writer, void*, bool) { return result; }) != 0)
+        {
+            return std::nullopt;
+        }
+        return bytecode;
     }
 
-    // read entities
+    // adds the components of the level's records through 'adder', which has Reserve<TComponent>(number of records)
+    // and Add<TComponent>(entity of the record, arguments of the component)
+    template <typename TAdder>
+    void AddComponents(const CompiledLevel& level, TAdder& adder)
     {
-        const sol::table entities = level["entities"];
-        Uint16 i = 0;
-        while (true)
+        adder.template Reserve<TransformComponent>(level.m_transforms.size());
+        for (const auto& transform : level.m_transforms)
         {
-            // entity
-            const sol::optional<sol::table> hasEntity = entities[i];
-            if (hasEntity == sol::nullopt) break;
-            auto newEntity = registry->CreateEntity();
-            const sol::table entity = entities[i];
+            adder.template Add<TransformComponent>(transform.m_entity, transform.m_position, transform.m_scale, transform.m_rotation);
+        }
 
-            // tag
-            const sol::optional<std::string> hasTag = entity["tag"];
-            if (hasTag != sol::nullopt)
+        adder.template Reserve<RigidbodyComponent>(level.m_rigidbodies.size());
+        for (const auto& rigidbody : level.m_rigidbodies)
+        {
+            adder.template Add<RigidbodyComponent>(rigidbody.m_entity, rigidbody.m_velocity, rigidbody.m_timeToStopInSecs);
+        }
+
+        adder.template Reserve<SpriteComponent>(level.m_sprites.size());
+        for (const auto& sprite : level.m_sprites)
+        {
+            adder.template Add<SpriteComponent>(sprite.m_entity, level.GetString(sprite.m_assetId), sprite.m_width, sprite.m_height, sprite.m_zIndex,
+                sprite.m_isFixed != 0, static_cast<Uint16>(sprite.m_srcRectX), static_cast<Uint16>(sprite.m_srcRectY));
+        }
+
+        adder.template Reserve<AnimationComponent>(level.m_animations.size());
+        for (const auto& animation : level.m_animations)
+        {
+            adder.template Add<AnimationComponent>(animation.m_entity, animation.m_numFrames, animation.m_speedRate);
+        }
+
+        adder.template Reserve<BoxColliderComponent>(level.m_boxColliders.size());
+        for (const auto& boxCollider : level.m_boxColliders)
+        {
+            adder.template Add<BoxColliderComponent>(boxCollider.m_entity, boxCollider.m_width, boxCollider.m_height, boxCollider.m_offset);
+        }
+
+        adder.template Reserve<HealthComponent>(level.m_healths.size());
+        for (const auto& health : level.m_healths)
+        {
+            adder.template Add<HealthComponent>(health.m_entity, health.m_healthPercentage);
+        }
+
+        adder.template Reserve<ProjectileEmitterComponent>(level.m_projectileEmitters.size());
+        for (const auto& emitter : level.m_projectileEmitters)
+        {
+            adder.template Add<ProjectileEmitterComponent>(emitter.m_entity, emitter.m_velocity, emitter.m_frequencyInMs, emitter.m_damagePercentage,
+                emitter.m_shouldCollideWithPlayer != 0, emitter.m_minVelocityMagnitude, emitter.m_maxVelocityMagnitude, emitter.m_timeToReachMaxVelocityInSecs);
+        }
+
+        for (const auto entity : level.m_cameraFollowEntities)
+        {
+            adder.template Add<CameraFollowComponent>(entity);
+        }
+
+        adder.template Reserve<KeyboardControlledComponent>(level.m_keyboardControlled.size());
+        for (const auto& keyboardControlled : level.m_keyboardControlled)
+        {
+            adder.template Add<KeyboardControlledComponent>(keyboardControlled.m_entity, keyboardControlled.m_upVelocity, keyboardControlled.m_rightVelocity,
+                keyboardControlled.m_downVelocity, keyboardControlled.m_leftVelocity);
+        }
+
+        for (const auto entity : level.m_dummyCharacterEntities)
+        {
+            adder.template Add<DummuCharacterComponent>(entity);
+        }
+
+        adder.template Reserve<ScriptComponent>(level.m_scripts.size());
+        for (const auto& script : level.m_scripts)
+        {
+            adder.template Add<ScriptComponent>(script.m_entity, CreateScriptComponent(level, script));
+        }
+    }
+
+    // the components of the prefab records (the ones no entity is created from)
+    struct PrefabComponentAdder
+    {
+        const CompiledLevel& m_level;
+        std::vector<Prefab>& m_prefabs;
+
+        template <typename TComponent>
+        void Reserve(std::size_t) {}
+
+        template <typename TComponent, typename ...TArgs>
+        void Add(std::uint32_t entity, TArgs&& ...args)
+        {
+            if (m_level.m_entities[entity].m_count == 0)
             {
-                newEntity.Tag(entity["tag"]);
+                m_prefabs[entity].AddComponent<TComponent>(std::forward<TArgs>(args)...);
             }
+        }
+    };
 
-            // group
-            const sol::optional<std::string> hasGroup = entity["group"];
-            if (hasGroup != sol::nullopt)
+    // the components of the other records, added to each of the entities created from the record
+    struct EntityComponentAdder
+    {
+        const std::unique_ptr<Registry>& m_registry;
+        std::vector<Entity>& m_entities;
+        const std::vector<std::size_t>& m_firstEntities;
+
+        template <typename TComponent>
+        void Reserve(std::size_t numberOfComponents)
+        {
+            m_registry->ReserveComponents<TComponent>(numberOfComponents);
+        }
+
+        template <typename TComponent, typename ...TArgs>
+        void Add(std::uint32_t entity, TArgs&& ...args)
+        {
+            for (std::size_t i = m_firstEntities[entity]; i < m_firstEntities[entity + 1]; i++)
             {
-                newEntity.Group(entity["group"]);
+                m_entities[i].AddComponent<TComponent>(args...);
             }
+        }
+    };
+}
 
-            // components
-            const sol::optional<sol::table> hasComponents = entity["components"];
-            if (hasComponents != sol::nullopt)
+void LevelLoader::CreateLevel(const CompiledLevel& level, const std::unique_ptr<Registry>& registry, std::unique_ptr<AssetStore>& assetStore, SDL_Renderer* renderer, sol::state& lua)
+{
+    // globals of a compiled level, the tables before their fields
+    {
+        std::vector<sol::table> tables(level.m_globals.size());
+        for (std::size_t i = 0; i < level.m_globals.size(); i++)
+        {
+            const CompiledLevel::GlobalRecord& global = level.m_globals[i];
+            sol::object value;
+            switch (global.m_type)
             {
-                const sol::table components = entity["components"];
-                // transform
-                const sol::optional<sol::table> hasTransform = components["transform"];
-                if (hasTransform != sol::nullopt)
-                {
-                    glm::vec2 spawnPosition{ 282, 282 };
-
-                    const sol::table transform = components["transform"];
-                    const sol::optional<sol::table> hasPosition = transform["position"];
-                    const bool positionSpecified = hasPosition != sol::nullopt;
-                   
-                    spawnPosition = (positionSpecified)?
-                       glm::vec2(transform["position"]["x"] , transform["position"]["y"]) :
-                       Helpers::CalculateRandomPosition();
-
-                    newEntity.AddComponent<TransformComponent>(
-                        spawnPosition,
-                        glm::vec2(transform["scale"]["x"].get_or(1.0), transform["scale"]["y"].get_or(1.0)),
-                        transform["rotation"].get_or(0)
-                        );
-                }
+            case CompiledLevel::ValueType::BOOLEAN: value = sol::make_object(lua, global.m_number != 0); break;
+            case CompiledLevel::ValueType::INTEGER: value = sol::make_object(lua, static_cast<lua_Integer>(global.m_number)); break;
+            case CompiledLevel::ValueType::NUMBER: value = sol::make_object(lua, global.m_number); break;
+            case CompiledLevel::ValueType::STRING: value = sol::make_object(lua, level.GetString(global.m_string)); break;
+            case CompiledLevel::ValueType::TABLE: tables[i] = lua.create_table(); value = tables[i]; break;
+            }
 
-                // rigidbody
-                const sol::optional<sol::table> hasRigidbody = components["rigidbody"];
-                if (hasRigidbody != sol::nullopt)
-                {
-                    const sol::table rigidbody = components["rigidbody"];
-                    newEntity.AddComponent<RigidbodyComponent>(
-                        glm::vec2(rigidbody["velocity"]["x"].get_or(0), rigidbody["velocity"]["y"].get_or(0)),
-                        rigidbody["time_to_stop_in_secs"]
-                        );
-                }
+            if (global.m_parent == CompiledLevel::NONE)
+            {
+                lua[level.GetString(global.m_name)] = value;
+            }
+            else if (global.m_name != CompiledLevel::NONE)
+            {
+                tables.at(global.m_parent)[level.GetString(global.m_name)] = value;
+            }
+            else
+            {
+                tables.at(global.m_parent)[global.m_index] = value;
+            }
+        }
+    }
 
-                // Sprite
-                sol::optional<sol::table> sprite = entity["components"]["sprite"];
-                if (sprite != sol::nullopt)
-                {
-                    newEntity.AddComponent<SpriteComponent>(
-                        entity["components"]["sprite"]["texture_asset_id"],
-                        entity["components"]["sprite"]["width"],
-                        entity["components"]["sprite"]["height"],
-                        entity["components"]["sprite"]["z_index"].get_or(1),
-                        entity["components"]["sprite"]["fixed"].get_or(false),
-                        entity["components"]["sprite"]["src_rect_x"].get_or(0),
-                        entity["components"]["sprite"]["src_rect_y"].get_or(0)
-                        );
-                }
+    // assets, the textures are loaded together (their images are decoded in parallel).
+    // The assets the previous level also used are already loaded, the ones only it used are released at the end
+    {
+        std::vector<TextureAsset> textures;
+        textures.reserve(level.m_textures.size());
+        for (const auto& texture : level.m_textures)
+        {
+            textures.push_back(TextureAsset{ level.GetString(texture.m_assetId), level.GetString(texture.m_file) });
+        }
+        std::vector<AssetHandle> levelAssets = assetStore->AddTextures(renderer, textures);
 
-                // Animation
-                sol::optional<sol::table> animation = entity["components"]["animation"];
-                if (animation != sol::nullopt)
-                {
-                    newEntity.AddComponent<AnimationComponent>(
-                        entity["components"]["animation"]["num_frames"].get_or(1),
-                        entity["components"]["animation"]["speed_rate"].get_or(1)
-                        );
-                }
+        for (const auto& font : level.m_fonts)
+        {
+            const std::string& assetId = level.GetString(font.m_assetId);
+            levelAssets.push_back(assetStore->AddFont(assetId, level.GetString(font.m_file), font.m_fontSize));
+            Logger::Log("AssetStore: Added font: " + assetId + " with size: " + std::to_string(font.m_fontSize));
+        }
 
-                // BoxCollider
-                sol::optional<sol::table> collider = entity["components"]["box_collider"];
-                if (collider != sol::nullopt)
-                {
-                    Uint16 width = 222, height = 222;
-
-                    // check if width is specified, if not width can be calculated by multiplying the sprite width and the scale of the transform
-                    sol::optional<int> hasSpecifiedWidth = entity["components"]["box_collider"]["width"];
-                    if (hasSpecifiedWidth != sol::nullopt)
-                    {
-                       width = entity["components"]["box_collider"]["width"];
-                    }
-                    else if (newEntity.HasComponent<SpriteComponent>() && newEntity.HasComponent<TransformComponent>())
-                    {
-                        width = newEntity.GetComponent<SpriteComponent>().m_width * newEntity.GetComponent<TransformComponent>().m_scale.x;
-                        Logger::InitInfo("[BOX COLLIDER] boxCollider created with defaultly calculated width");
-                    }
-                    else
-                    {
-                        width = 1;
-                        Logger::Error("[BOX COLLIDER] boxCollider could not calculate width because entity does not have both Sprite or Transform components or they are declared after the BoxCollider");
-                    }
-
-                    // check if hieght is specified, if not height can be calculated by multiplying the sprite height and the scale of the transform
-                    sol::optional<int> hasSpecifiedHeight = entity["components"]["box_collider"]["height"];
-                    if (hasSpecifiedHeight != sol::nullopt)
-                    {
-                        height = entity["components"]["box_collider"]["height"];
-                    }
-                    else if (newEntity.HasComponent<SpriteComponent>() && newEntity.HasComponent<TransformComponent>())
-                    {
-                        height = newEntity.GetComponent<SpriteComponent>().m_height * newEntity.GetComponent<TransformComponent>().m_scale.y;
-                        Logger::InitInfo("[BOX COLLIDER] boxCollider created with defaultly calculated height");
-                    }
-                    else
-                    {
-                        height = 1;
-                        Logger::Error("[BOX COLLIDER] boxCollider could not calculate width because entity does not have both Sprite or Transform components or they are declared after the BoxCollider");
-                    }
-
-                    newEntity.AddComponent<BoxColliderComponent>(
-                        width,
-                        height,
-                        glm::vec2(
-                            entity["components"]["box_collider"]["offset"]["x"].get_or(0),
-                            entity["components"]["box_collider"]["offset"]["y"].get_or(0)
-                        )
-                        );
-                }
+        // after the new level took its references, what it shares with the previous one is not unloaded
+        m_levelAssets = std::move(levelAssets);
+        assetStore->LogMemoryUsage();
+    }
 
-                // Health
-                sol::optional<sol::table> health = entity["components"]["health"];
-                if (health != sol::nullopt)
-                {
-                    newEntity.AddComponent<HealthComponent>(
-                        static_cast<int>(entity["components"]["health"]["health_percentage"].get_or(100))
-                        );
-                }
+    Game::m_windowWidth = level.m_window.m_width;
+    Game::m_windowHeight = level.m_window.m_height;
 
-                // ProjectileEmitter
-                sol::optional<sol::table> projectileEmitter = entity["components"]["projectile_emitter"];
-                if (projectileEmitter != sol::nullopt)
-                {
-                    newEntity.AddComponent<ProjectileEmitterComponent>(
-                        glm::vec2(
-                            entity["components"]["projectile_emitter"]["projectile_velocity"]["x"],
-                            entity["components"]["projectile_emitter"]["projectile_velocity"]["y"]
-                        ),
-                        static_cast<int>(entity["components"]["projectile_emitter"]["repeat_frequency"].get_or(1.0f) * 1000),
-                        static_cast<int>(entity["components"]["projectile_emitter"]["hit_percentage_damage"].get_or(10)),
-                        entity["components"]["projectile_emitter"]["should_collide_with_player"].get_or(false),
-                        entity["components"]["projectile_emitter"]["min_velocity_magnitude"],
-                        entity["components"]["projectile_emitter"]["max_velocity_magnitude"],
-                        entity["components"]["projectile_emitter"]["time_to_reach_max_velocity_in_secs"]
-                        );
-                }
+    // map, the tiles are created around the camera by the TilemapStreamingSystem
+    if (!level.m_tilemaps.empty())
+    {
+        const CompiledLevel::TilemapRecord& tilemap = level.m_tilemaps.front();
+        auto streamedTilemap = std::make_shared<Tilemap>(level.GetString(tilemap.m_textureAssetId), tilemap.m_tileSize, tilemap.m_tileScale, tilemap.m_chunkSize);
+        streamedTilemap->SetStreamingRadius(tilemap.m_loadRadius, tilemap.m_unloadRadius);
+        if (streamedTilemap->Load(level.GetString(tilemap.m_mapFile), tilemap.m_numberOfColumns, tilemap.m_numberOfRows, &assetStore->GetArchive()))
+        {
+            Entity tilemapEntity = registry->CreateEntity();
+            tilemapEntity.AddComponent<TilemapComponent>(streamedTilemap);
+        }
 
-                // CameraFollow
-                sol::optional<sol::table> cameraFollow = entity["components"]["camera_follow"];
-                if (cameraFollow != sol::nullopt)
-                {
-                    newEntity.AddComponent<CameraFollowComponent>();
-                }
+        Game::m_mapWidth = tilemap.m_tileSize * tilemap.m_tileScale * tilemap.m_numberOfColumns;
+        Game::m_mapHeight = tilemap.m_tileSize * tilemap.m_tileScale * tilemap.m_numberOfRows;
+    }
+    else
+    {
+        Game::m_mapWidth = 1024;
+        Game::m_mapHeight = 768;
+    }
 
-                // KeyboardControlled
-                sol::optional<sol::table> keyboardControlled = entity["components"]["keyboard_controller"];
-                if (keyboardControlled != sol::nullopt)
-                {
-                    newEntity.AddComponent<KeyboardControlledComponent>(
-                        glm::vec2(
-                            entity["components"]["keyboard_controller"]["up_velocity"]["x"],
-                            entity["components"]["keyboard_controller"]["up_velocity"]["y"]
-                        ),
-                        glm::vec2(
-                            entity["components"]["keyboard_controller"]["right_velocity"]["x"],
-                            entity["components"]["keyboard_controller"]["right_velocity"]["y"]
-                        ),
-                        glm::vec2(
-                            entity["components"]["keyboard_controller"]["down_velocity"]["x"],
-                            entity["components"]["keyboard_controller"]["down_velocity"]["y"]
-                        ),
-                        glm::vec2(
-                            entity["components"]["keyboard_controller"]["left_velocity"]["x"],
-                            entity["components"]["keyboard_controller"]["left_velocity"]["y"]
-                        )
-                        );
-                }
+    // prefabs, built from their records before the entities made from them are instantiated
+    std::vector<Prefab> prefabs(level.m_entities.size());
+    PrefabComponentAdder prefabComponentAdder{ level, prefabs };
+    AddComponents(level, prefabComponentAdder);
 
-                // DummyCharacterComponent
-                sol::optional<sol::table> dummyCharacter = entity["components"]["dummy_character"];
-                if (dummyCharacter != sol::nullopt)
-                {
-                    newEntity.AddComponent<DummuCharacterComponent>();
-                }
+    // entities, the ones of a record are entities[firstEntities[record], firstEntities[record + 1])
+    std::vector<std::size_t> firstEntities(level.m_entities.size() + 1, 0);
+    std::vector<std::size_t> numberOfInstances(level.m_entities.size(), 0);
+    for (std::size_t i = 0; i < level.m_entities.size(); i++)
+    {
+        const CompiledLevel::EntityRecord& entityRecord = level.m_entities[i];
+        firstEntities[i + 1] = firstEntities[i] + entityRecord.m_count;
+        if (entityRecord.m_prefab != CompiledLevel::NONE)
+        {
+            numberOfInstances[entityRecord.m_prefab] += entityRecord.m_count;
+        }
+    }
 
+    // all the instances of a prefab are created by one Instantiate, then handed to their records in order
+    std::vector<std::vector<Entity>> instances(level.m_entities.size());
+    for (std::size_t i = 0; i < level.m_entities.size(); i++)
+    {
+        if (numberOfInstances[i] > 0)
+        {
+            instances[i] = registry->Instantiate(prefabs[i], numberOfInstances[i]);
+        }
+    }
+    std::vector<std::size_t> nextInstances(level.m_entities.size(), 0);
 
-                // lua script 
-                sol::optional<sol::table> script = entity["components"]["on_update_script"];
-                if (script != sol::nullopt)
-                {
-                    sol::function function = entity["components"]["on_update_script"][0];
-                    newEntity.AddComponent<ScriptComponent>(function);
-                }
+    std::vector<Entity> entities(firstEntities.back(), Entity(0));
+    for (std::size_t i = 0; i < level.m_entities.size(); i++)
+    {
+        const CompiledLevel::EntityRecord& entityRecord = level.m_entities[i];
+        for (std::size_t entity = firstEntities[i]; entity < firstEntities[i + 1]; entity++)
+        {
+            entities[entity] = entityRecord.m_prefab != CompiledLevel::NONE
+                ? instances[entityRecord.m_prefab][nextInstances[entityRecord.m_prefab]++]
+                : registry->CreateEntity();
+            if (entityRecord.m_tag != CompiledLevel::NONE)
+            {
+                entities[entity].Tag(level.GetString(entityRecord.m_tag));
             }
-            i++;
+            if (entityRecord.m_group != CompiledLevel::NONE)
+            {
+                entities[entity].Group(level.GetString(entityRecord.m_group));
+            }
+        }
+    }
+
+    // the components of the entities' own records, replacing the ones of their prefab. Each pool is sized once for the level
+    EntityComponentAdder entityComponentAdder{ registry, entities, firstEntities };
+    AddComponents(level, entityComponentAdder);
+
+    // the positions the level left unspecified are picked for each entity, an entity without a transform of its own uses the prefab's one
+    std::vector<bool> hasTransform(level.m_entities.size(), false);
+    std::vector<bool> isPositionRandom(level.m_entities.size(), false);
+    for (const auto& transform : level.m_transforms)
+    {
+        hasTransform[transform.m_entity] = true;
+        isPositionRandom[transform.m_entity] = transform.m_isPositionRandom != 0;
+    }
+    for (std::size_t i = 0; i < level.m_entities.size(); i++)
+    {
+        const std::uint32_t prefab = level.m_entities[i].m_prefab;
+        const bool hasRandomPosition = hasTransform[i] ? isPositionRandom[i] : prefab != CompiledLevel::NONE && isPositionRandom[prefab];
+        for (std::size_t entity = firstEntities[i]; hasRandomPosition && entity < firstEntities[i + 1]; entity++)
+        {
+            entities[entity].GetComponent<TransformComponent>().m_position = Helpers::CalculateRandomPosition();
         }
     }
+
+    // kept to reload the scripts of the entities
+    m_levelEntityRecords = level.m_entities;
+    m_levelEntityGenerations.clear();
+    m_levelEntityGenerations.reserve(entities.size());
+    for (const Entity& entity : entities)
+    {
+        m_levelEntityGenerations.push_back(registry->GetGeneration(entity));
+    }
+    m_levelEntities = std::move(entities);
+    m_firstLevelEntities = std::move(firstEntities);
+    m_levelFunctions = level.m_functions;
+    m_levelScripts = ResolveScripts(level);
+}
+
+bool LevelLoader::IsLoadedLevelScript(const std::string& filePath) const
+{
+    return !m_loadedLevel.empty()
+        && std::filesystem::path(filePath).lexically_normal() == std::filesystem::path(m_scriptsDirectory + m_loadedLevel + ".lua").lexically_normal();
+}
+
+bool LevelLoader::ReloadLevelScripts(const std::unique_ptr<Registry>& registry, sol::state& lua)
+{
+    if (m_loadedLevel.empty())
+    {
+        Logger::Error("LevelLoader: no level was loaded, there are no scripts to reload");
+        return false;
+    }
+
+    CompiledLevel level;
+    if (!ReadLevelScript(m_scriptsDirectory + m_loadedLevel + ".lua", lua, level))
+    {
+        return false;
+    }
+
+    // the entities are found from the records they were created from, which have to be the same ones
+    const bool haveEntitiesChanged = level.m_entities.size() != m_levelEntityRecords.size()
+        || !std::equal(level.m_entities.begin(), level.m_entities.end(), m_levelEntityRecords.begin(),
+            [](const CompiledLevel::EntityRecord& entityRecord, const CompiledLevel::EntityRecord& loadedEntityRecord)
+            {
+                return entityRecord.m_count == loadedEntityRecord.m_count && entityRecord.m_prefab == loadedEntityRecord.m_prefab;
+            });
+    if (haveEntitiesChanged)
+    {
+        Logger::Error("LevelLoader: the entities of " + m_loadedLevel + " changed, its scripts are reloaded with the level only");
+        return false;
+    }
+
+    // each function is dumped once, a batch script is shared by many records
+    const auto dumpFunctions = [](const std::vector<sol::function>& functions)
+    {
+        std::vector<std::optional<std::string>> bytecodes;
+        bytecodes.reserve(functions.size());
+        for (const auto& function : functions)
+        {
+            bytecodes.push_back(DumpForComparison(function));
+        }
+        return bytecodes;
+    };
+    const std::vector<std::optional<std::string>> loadedBytecodes = dumpFunctions(m_levelFunctions);
+    const std::vector<std::optional<std::string>> bytecodes = dumpFunctions(level.m_functions);
+    const auto hasChanged = [&loadedBytecodes, &bytecodes](std::uint32_t loadedFunction, std::uint32_t function)
+    {
+        if (loadedFunction == CompiledLevel::NONE || function == CompiledLevel::NONE)
+        {
+            return loadedFunction != function;
+        }
+        const auto& loadedBytecode = loadedBytecodes[loadedFunction];
+        const auto& bytecode = bytecodes[function];
+        return !loadedBytecode || !bytecode || *loadedBytecode != *bytecode;
+    };
+
+    std::vector<CompiledLevel::ScriptRecord> scripts = ResolveScripts(level);
+    auto& scriptSystem = registry->GetSystem<ScriptSystem>();
+    std::size_t numberOfReloadedScripts = 0;
+    for (std::size_t i = 0; i < level.m_entities.size(); i++)
+    {
+        const CompiledLevel::ScriptRecord& loadedScript = m_levelScripts[i];
+        const CompiledLevel::ScriptRecord& script = scripts[i];
+        ScriptSystem::ReplacedFunctions replacedFunctions;
+        replacedFunctions.m_isScriptReplaced = hasChanged(loadedScript.m_script, script.m_script);
+        replacedFunctions.m_isBatchScriptReplaced = hasChanged(loadedScript.m_batchScript, script.m_batchScript);
+        replacedFunctions.m_isBehaviourReplaced = hasChanged(loadedScript.m_behaviour, script.m_behaviour);
+        if (!replacedFunctions.m_isScriptReplaced && !replacedFunctions.m_isBatchScriptReplaced && !replacedFunctions.m_isBehaviourReplaced)
+        {
+            continue;
+        }
+
+        const ScriptComponent scriptComponent = CreateScriptComponent(level, script);
+        for (std::size_t entity = m_firstLevelEntities[i]; entity < m_firstLevelEntities[i + 1]; entity++)
+        {
+            // the entities destroyed since (their id may be another entity's now) and the ones created without a script
+            // are left as they are
+            const Entity& levelEntity = m_levelEntities[entity];
+            if (registry->GetGeneration(levelEntity) == m_levelEntityGenerations[entity] && levelEntity.HasComponent<ScriptComponent>())
+            {
+                scriptSystem.ReplaceScript(levelEntity, scriptComponent, replacedFunctions);
+                numberOfReloadedScripts++;
+            }
+        }
+    }
+
+    // the next reload is compared with this one
+    m_levelFunctions = level.m_functions;
+    m_levelScripts = std::move(scripts);
+    Logger::Log("LevelLoader: reloaded the changed scripts of " + std::to_string(numberOfReloadedScripts) + " entities of " + m_loadedLevel);
+    return true;
 }
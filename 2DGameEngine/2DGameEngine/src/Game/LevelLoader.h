@@ -2,21 +2,65 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+
+#include "ECS/ECS.h"
+#include "AssetStore/AssetStore.h"
+#include "Game/ScriptCache.h"
+#include "Game/CompiledLevel.h"
+#include "Game/ComponentReaders.h"
 
 class Registry;
-class AssetStore;
+class AssetArchive;
 struct SDL_Renderer;
-namespace sol { class state; }
 
+// Levels are read from their compiled file (see CompiledLevel) when it is up to date with the script, from the script otherwise
 class LevelLoader
 {
 public:
-	LevelLoader();
+	LevelLoader(const std::string& scriptsDirectory = CONST::SCRIPTS::SCRIPTS_DIRECTORY, const std::string& compiledLevelsDirectory = CONST::COMPILED_LEVELS::DIRECTORY);
 	~LevelLoader() = default;
 
 	// just the name of the file - no paths or extensions
 	void LoadLevel(const std::string& levelToLoad, const std::unique_ptr<Registry>& registry, std::unique_ptr<AssetStore>& assetStore, SDL_Renderer* renderer, sol::state& lua);
 	void LoadLevel(unsigned int levelToLoad, const std::unique_ptr<Registry>& registry, std::unique_ptr<AssetStore>& assetStore, SDL_Renderer* renderer, sol::state& lua);
+
+	// runs the script of the level in 'lua' and writes what it built to the compiled levels directory, false (and logged) on errors
+	bool CompileLevel(const std::string& levelToCompile, sol::state& lua) const;
+
+	bool WasCompiledLevelLoaded() const { return m_wasCompiledLevelLoaded; }
+
+	// whether the file is the script of the last loaded level, the scripts of the other levels are not reloaded
+	bool IsLoadedLevelScript(const std::string& filePath) const;
+
+	// runs the script of the last loaded level again. The update scripts, batch scripts and behaviours whose bytecode changed
+	// replace the ones of the level's entities through the ScriptSystem of the registry, the others keep running (a behaviour
+	// that did not change is not started over). Nothing else of the level is created again.
+	// False (and logged) when the script fails or its entities changed, the entities then keep the scripts they had
+	bool ReloadLevelScripts(const std::unique_ptr<Registry>& registry, sol::state& lua);
+
+	// a reader added or replaced here is used by the next levels read from their script (a new component also needs its records in CompiledLevel)
+	ComponentReaders& GetComponentReaders() { return m_componentReaders; }
 private:
-	void ParseLevel(const std::string& levelToLoad, const std::unique_ptr<Registry>& registry, std::unique_ptr<AssetStore>& assetStore, SDL_Renderer* renderer, sol::state& lua);
-};
\ No newline at end of file
+	bool ReadLevelScript(const std::string& scriptPath, sol::state& lua, CompiledLevel& level) const;
+	bool ReadCompiledLevel(const std::string& levelToLoad, const AssetArchive* archive, sol::state& lua, CompiledLevel& level) const;
+	void CreateLevel(const CompiledLevel& level, const std::unique_ptr<Registry>& registry, std::unique_ptr<AssetStore>& assetStore, SDL_Renderer* renderer, sol::state& lua);
+
+	std::string m_scriptsDirectory;
+	std::string m_compiledLevelsDirectory;
+	ComponentReaders m_componentReaders;
+	bool m_wasCompiledLevelLoaded = false;
+
+	// the last loaded level, the entities created from its record i are m_levelEntities[m_firstLevelEntities[i], m_firstLevelEntities[i + 1])
+	std::string m_loadedLevel;
+	std::vector<CompiledLevel::EntityRecord> m_levelEntityRecords;
+	std::vector<Entity> m_levelEntities;
+	std::vector<std::size_t> m_firstLevelEntities;
+	// of the entities when they were created, an entity destroyed since may have given its id to a new one
+	std::vector<std::uint32_t> m_levelEntityGenerations;
+	// the script functions as they were last loaded and the script of each record, compared with the reloaded ones
+	std::vector<sol::function> m_levelFunctions;
+	std::vector<CompiledLevel::ScriptRecord> m_levelScripts;
+	// keep the textures and fonts of the last loaded level loaded, replaced once the next level holds its own
+	std::vector<AssetHandle> m_levelAssets;
+};
@@ -0,0 +1,68 @@
+#include "pch.h"
+
+#include "LuaBackend.h"
+
+#include "Logger/Logger.h"
+
+namespace
+{
+	// only what exists in 5.3 and not in LuaJIT, everything is left alone when LuaJIT already has it
+	// (table.unpack, table.pack... are there when LuaJIT is built with LUAJIT_ENABLE_LUA52COMPAT)
+	const char* LUA53_SHIMS = R"(
+		table.unpack = table.unpack or unpack
+		table.pack = table.pack or function(...) return { n = select("#", ...), ... } end
+
+		-- every number is a double in LuaJIT, whole numbers are reported as integers
+		math.maxinteger = math.maxinteger or 2^53
+		math.mininteger = math.mininteger or -2^53
+		math.tointeger = math.tointeger or function(x)
+			if type(x) == "number" and x == math.floor(x) and x >= math.mininteger and x <= math.maxinteger then
+				return x
+			end
+			return nil
+		end
+		math.type = math.type or function(x)
+			if type(x) ~= "number" then
+				return nil
+			end
+			return math.tointeger(x) and "integer" or "float"
+		end
+		math.ult = math.ult or function(m, n)
+			if (m >= 0) == (n >= 0) then
+				return m < n
+			end
+			return m >= 0
+		end
+	)";
+}
+
+const char* LuaBackend::GetName()
+{
+#if defined(SOL_LUAJIT) && SOL_LUAJIT
+	return LUAJIT_VERSION;
+#else
+	return LUA_VERSION;
+#endif
+}
+
+void LuaBackend::OpenLibraries(sol::state& lua)
+{
+	lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::os);
+
+#if defined(SOL_LUAJIT) && SOL_LUAJIT
+	lua.open_libraries(sol::lib::table, sol::lib::jit, sol::lib::bit32);
+
+	const auto result = lua.safe_script(LUA53_SHIMS, sol::script_pass_on_error);
+	if (!result.valid())
+	{
+		const sol::error error = result;
+		Logger::Error("Could not install the Lua 5.3 shims: " + std::string(error.what()));
+	}
+#endif
+}
+
+int LuaBackend::WriteBytecode(lua_State*, const void* data, size_t size, void* bytecode)
+{
+	static_cast<std::string*>(bytecode)->append(static_cast<const char*>(data), size);
+	return 0;
+}
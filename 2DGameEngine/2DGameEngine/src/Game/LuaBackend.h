@@ -0,0 +1,19 @@
+#pragma once
+
+#include <sol/sol.hpp>
+
+// The scripts run on Lua 5.3 by default. Building with 'UseLuaJIT=true' (see Lua.props) runs them on LuaJIT 2.1,
+// which implements Lua 5.1: the functions added by 5.2/5.3 that the scripts may call are provided by the shims
+// installed in OpenLibraries(). The 5.3 syntax cannot be shimmed, scripts must not use the integer division (//)
+// or the bitwise operators (LuaJIT has the 'bit' library for those)
+namespace LuaBackend
+{
+	// "Lua 5.3" or "LuaJIT 2.1.x", for logs and benchmarks
+	const char* GetName();
+
+	// opens the libraries the level scripts use, on LuaJIT also the jit library (without it the compiler stays off) and the shims
+	void OpenLibraries(sol::state& lua);
+
+	// lua_Writer appending the bytecode to the std::string given as 'bytecode', for lua_dump() and sol::function::dump()
+	int WriteBytecode(lua_State*, const void* data, size_t size, void* bytecode);
+}
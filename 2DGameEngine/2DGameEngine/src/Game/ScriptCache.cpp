@@ -0,0 +1,178 @@
+#include "pch.h"
+
+#include "ScriptCache.h"
+
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+#include "Logger/Logger.h"
+#include "Game/LuaBackend.h"
+#include "HelperFunctions.h"
+
+namespace
+{
+	// the bytecode follows the header, Lua does not check bytecode: a damaged file must not reach load_buffer()
+	const char MAGIC[4] = { '2', 'D', 'S', 'C' };
+	// increased when the header changes
+	const std::uint32_t VERSION = 1;
+	const std::size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(std::uint32_t) + sizeof(std::uint64_t);
+	// "<source hash>.luac" at the end of every cached script name
+	const std::size_t SOURCE_HASH_SUFFIX_SIZE = 16 + std::strlen(".luac");
+
+	// the bytecode without its header, false when the file is not complete or not the one written
+	bool FindBytecode(const std::string& cachedScript, const char*& bytecode, std::size_t& bytecodeSize)
+	{
+		std::uint32_t version = 0;
+		std::uint64_t checksum = 0;
+		if (cachedScript.size() < HEADER_SIZE || std::memcmp(cachedScript.data(), MAGIC, sizeof(MAGIC)) != 0)
+		{
+			return false;
+		}
+		std::memcpy(&version, cachedScript.data() + sizeof(MAGIC), sizeof(version));
+		std::memcpy(&checksum, cachedScript.data() + sizeof(MAGIC) + sizeof(version), sizeof(checksum));
+
+		bytecode = cachedScript.data() + HEADER_SIZE;
+		bytecodeSize = cachedScript.size() - HEADER_SIZE;
+		return version == VERSION && checksum == Helpers::CalculateChecksum(bytecode, bytecodeSize);
+	}
+}
+
+ScriptCache::ScriptCache(const std::string& cacheDirectory)
+	: m_cacheDirectory(cacheDirectory)
+{
+}
+
+sol::load_result ScriptCache::Load(sol::state& lua, const std::string& scriptPath)
+{
+	std::string source;
+	if (!Helpers::ReadFile(scriptPath, source))
+	{
+		// lua reports the missing file
+		return lua.load_file(scriptPath);
+	}
+
+	// same chunk name as load_file() so that the error messages point at the script
+	const std::string chunkName = "@" + scriptPath;
+	const std::string cachedScriptPath = GetCachedScriptPath(scriptPath, CalculateHash(source));
+
+	std::string cachedScript;
+	if (Helpers::ReadFile(cachedScriptPath, cachedScript))
+	{
+		const char* bytecode = nullptr;
+		std::size_t bytecodeSize = 0;
+		if (FindBytecode(cachedScript, bytecode, bytecodeSize))
+		{
+			sol::load_result chunk = lua.load_buffer(bytecode, bytecodeSize, chunkName, sol::load_mode::binary);
+			if (chunk.valid())
+			{
+				m_numberOfHits++;
+				return chunk;
+			}
+		}
+		Logger::Error("ScriptCache: " + cachedScriptPath + " is not valid bytecode, compiling " + scriptPath + " again");
+	}
+
+	m_numberOfMisses++;
+	sol::load_result chunk = lua.load_buffer(source.data(), source.size(), chunkName, sol::load_mode::text);
+	if (chunk.valid())
+	{
+		Store(chunk, scriptPath, cachedScriptPath);
+	}
+	return chunk;
+}
+
+int ScriptCache::Precompile(sol::state& lua, const std::string& scriptsDirectory)
+{
+	int numberOfErrors = 0;
+
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(scriptsDirectory, error))
+	{
+		if (!entry.is_regular_file() || entry.path().extension() != ".lua")
+		{
+			continue;
+		}
+
+		const std::string scriptPath = entry.path().generic_string();
+		sol::load_result chunk = Load(lua, scriptPath);
+		if (!chunk.valid())
+		{
+			const sol::error compileError = chunk;
+			Logger::Error("ScriptCache: could not compile " + scriptPath + ": " + compileError.what());
+			numberOfErrors++;
+			continue;
+		}
+		Logger::Log("ScriptCache: compiled " + scriptPath);
+	}
+
+	if (error)
+	{
+		Logger::Error("ScriptCache: could not read " + scriptsDirectory + ": " + error.message());
+		numberOfErrors++;
+	}
+	return numberOfErrors;
+}
+
+std::uint64_t ScriptCache::CalculateHash(const std::string& source)
+{
+	// the interpreter is part of the key
+	const std::string backendName = LuaBackend::GetName();
+	const std::uint64_t backendHash = Helpers::CalculateChecksum(backendName.data(), backendName.size());
+	return Helpers::CalculateChecksum(source.data(), source.size(), backendHash);
+}
+
+std::string ScriptCache::GetCachedScriptPath(const std::string& scriptPath, std::uint64_t sourceHash) const
+{
+	// scripts of the same name in different directories get their own entry. The path is not made absolute,
+	// the cache precompiled for a shipping build must still match on another machine
+	const std::string normalizedPath = std::filesystem::path(scriptPath).lexically_normal().generic_string();
+	const std::uint64_t pathHash = Helpers::CalculateChecksum(normalizedPath.data(), normalizedPath.size());
+
+	std::ostringstream cachedScriptPath;
+	cachedScriptPath << m_cacheDirectory << std::filesystem::path(scriptPath).stem().string() << std::hex << std::setfill('0')
+		<< "." << std::setw(16) << pathHash << "." << std::setw(16) << sourceHash << ".luac";
+	return cachedScriptPath.str();
+}
+
+void ScriptCache::Store(const sol::load_result& chunk, const std::string& scriptPath, const std::string& cachedScriptPath) const
+{
+	// debug information is kept, the errors keep their line numbers
+	std::string bytecode;
+	const sol::function function = chunk.get<sol::function>();
+	const int result = function.dump(&LuaBackend::WriteBytecode, &bytecode, false, [](lua_State*, int result, lua_Writer, void*, bool) { return result; });
+	if (result != 0)
+	{
+		Logger::Error("ScriptCache: could not dump the bytecode of " + scriptPath);
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(m_cacheDirectory, error);
+
+	// the bytecode of the previous versions of the script, same name and path hash but another source hash
+	const std::string cachedScriptName = std::filesystem::path(cachedScriptPath).filename().string();
+	const std::string scriptPrefix = cachedScriptName.substr(0, cachedScriptName.size() - SOURCE_HASH_SUFFIX_SIZE);
+	for (const auto& entry : std::filesystem::directory_iterator(m_cacheDirectory, error))
+	{
+		const std::string fileName = entry.path().filename().string();
+		if (fileName != cachedScriptName && fileName.size() == cachedScriptName.size()
+			&& fileName.compare(0, scriptPrefix.size(), scriptPrefix) == 0 && entry.path().extension() == ".luac")
+		{
+			std::filesystem::remove(entry.path(), error);
+		}
+	}
+
+	const std::uint64_t checksum = Helpers::CalculateChecksum(bytecode.data(), bytecode.size());
+	std::ofstream file(cachedScriptPath, std::ios::binary);
+	file.write(MAGIC, sizeof(MAGIC));
+	file.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+	file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+	file.write(bytecode.data(), static_cast<std::streamsize>(bytecode.size()));
+	if (!file)
+	{
+		// the script still runs, it is compiled again next time
+		Logger::Error("ScriptCache: could not write " + cachedScriptPath);
+	}
+}
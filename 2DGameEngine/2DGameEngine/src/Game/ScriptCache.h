@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include <sol/sol.hpp>
+
+namespace CONST
+{
+	namespace SCRIPTS
+	{
+		const std::string SCRIPTS_DIRECTORY = "./assets/scripts/";
+		// inside the assets so that the scripts precompiled for a shipping build are shipped with them
+		const std::string CACHE_DIRECTORY = "./assets/scripts/cache/";
+	}
+}
+
+// Compiles every Lua script once: the bytecode is written to the cache directory as "<script>.<path hash>.<hash>.luac",
+// the hash being the one of the source and of the interpreter (5.3 and LuaJIT bytecode are not compatible).
+// The bytecode is stored with its checksum, a damaged file is compiled again instead of being loaded.
+// A script whose source changed gets a new hash, it is compiled again and its old bytecode is deleted.
+// Loading from the cache still reads the source to hash it but skips the parsing and the compilation
+class ScriptCache
+{
+public:
+	ScriptCache(const std::string& cacheDirectory = CONST::SCRIPTS::CACHE_DIRECTORY);
+
+	// the compiled chunk of the script, not executed yet. On errors the result is not valid and holds the message
+	sol::load_result Load(sol::state& lua, const std::string& scriptPath);
+
+	// compiles every .lua file of the directory into the cache, returns how many of them could not be compiled
+	int Precompile(sol::state& lua, const std::string& scriptsDirectory = CONST::SCRIPTS::SCRIPTS_DIRECTORY);
+
+	std::size_t GetNumberOfHits() const { return m_numberOfHits; }
+	std::size_t GetNumberOfMisses() const { return m_numberOfMisses; }
+
+	// of the source and of the interpreter, compiled levels keep the one of their script
+	static std::uint64_t CalculateHash(const std::string& source);
+private:
+	std::string GetCachedScriptPath(const std::string& scriptPath, std::uint64_t sourceHash) const;
+	void Store(const sol::load_result& chunk, const std::string& scriptPath, const std::string& cachedScriptPath) const;
+
+	std::string m_cacheDirectory;
+	std::size_t m_numberOfHits = 0;
+	std::size_t m_numberOfMisses = 0;
+};
@@ -0,0 +1,152 @@
+#include "pch.h"
+
+#include "ScriptSandbox.h"
+
+#include <string>
+
+#include "Game/LuaBackend.h"
+
+namespace
+{
+	// registry flag keyed by the thread, the hook has no other place to write to
+	void SetHasSpentInstructionBudget(lua_State* thread, bool hasSpentInstructionBudget)
+	{
+		lua_pushlightuserdata(thread, thread);
+		if (hasSpentInstructionBudget)
+		{
+			lua_pushboolean(thread, 1);
+		}
+		else
+		{
+			lua_pushnil(thread);
+		}
+		lua_rawset(thread, LUA_REGISTRYINDEX);
+	}
+
+	void OnInstructionBudgetSpent(lua_State* thread, lua_Debug*)
+	{
+#if !defined(SOL_LUAJIT) || !SOL_LUAJIT
+		// inside a C function called by the script (a comparator of table.sort...), it yields at the next hook
+		if (!lua_isyieldable(thread))
+		{
+			return;
+		}
+#endif
+		SetHasSpentInstructionBudget(thread, true);
+		lua_yield(thread, 0);
+	}
+}
+
+sol::table ScriptSandbox::CreateEnvironment(sol::state_view lua)
+{
+	sol::table environment = lua.create_table();
+	sol::table metatable = lua.create_table_with("__index", lua.globals());
+	environment[sol::metatable_key] = metatable;
+	return environment;
+}
+
+sol::function ScriptSandbox::Isolate(const sol::function& function, const sol::table& environment)
+{
+	lua_State* L = function.lua_state();
+	function.push();
+	const int functionIndex = lua_gettop(L);
+	if (lua_iscfunction(L, functionIndex))
+	{
+		lua_pop(L, 1);
+		return function;
+	}
+
+	// the debug information is kept, it has the names of the upvalues and the lines of the errors
+	std::string bytecode;
+	lua_dump(L, &LuaBackend::WriteBytecode, &bytecode, 0);
+	if (luaL_loadbuffer(L, bytecode.data(), bytecode.size(), "=isolated") != 0)
+	{
+		lua_pop(L, 2);
+		return function;
+	}
+	const int copyIndex = lua_gettop(L);
+
+	// the upvalues of the copy are joined to the ones of the function, except _ENV which becomes the environment
+	for (int upvalue = 1;; upvalue++)
+	{
+		const char* name = lua_getupvalue(L, functionIndex, upvalue);
+		if (name == nullptr)
+		{
+			break;
+		}
+		lua_pop(L, 1);
+
+		if (std::string(name) == "_ENV")
+		{
+			environment.push();
+			lua_setupvalue(L, copyIndex, upvalue);
+		}
+		else
+		{
+			lua_upvaluejoin(L, copyIndex, upvalue, functionIndex, upvalue);
+		}
+	}
+#if LUA_VERSION_NUM < 502
+	environment.push();
+	lua_setfenv(L, copyIndex);
+#endif
+
+	sol::function copy(L, copyIndex);
+	lua_pop(L, 2);
+	return copy;
+}
+
+sol::table ScriptSandbox::GetEnvironment(const sol::function& function)
+{
+	lua_State* L = function.lua_state();
+	function.push();
+#if LUA_VERSION_NUM < 502
+	lua_getfenv(L, -1);
+#else
+	bool hasEnvironment = false;
+	for (int upvalue = 1; const char* name = lua_getupvalue(L, -1, upvalue); upvalue++)
+	{
+		if (std::string(name) == "_ENV")
+		{
+			hasEnvironment = true;
+			break;
+		}
+		lua_pop(L, 1);
+	}
+	if (!hasEnvironment)
+	{
+		lua_pushnil(L);
+	}
+#endif
+
+	sol::table environment;
+	if (lua_istable(L, -1))
+	{
+		environment = sol::table(L, -1);
+	}
+	lua_pop(L, 2);
+	return environment;
+}
+
+void ScriptSandbox::SetInstructionBudget(lua_State* thread, int instructionBudget)
+{
+	lua_sethook(thread, &OnInstructionBudgetSpent, LUA_MASKCOUNT, instructionBudget);
+}
+
+void ScriptSandbox::RemoveInstructionBudget(lua_State* thread)
+{
+	lua_sethook(thread, nullptr, 0, 0);
+}
+
+bool ScriptSandbox::HasSpentInstructionBudget(lua_State* thread)
+{
+	lua_pushlightuserdata(thread, thread);
+	lua_rawget(thread, LUA_REGISTRYINDEX);
+	const bool hasSpentInstructionBudget = lua_toboolean(thread, -1) != 0;
+	lua_pop(thread, 1);
+	if (hasSpentInstructionBudget)
+	{
+		SetHasSpentInstructionBudget(thread, false);
+	}
+	return hasSpentInstructionBudget;
+}
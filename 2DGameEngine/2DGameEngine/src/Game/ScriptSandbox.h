@@ -0,0 +1,30 @@
+#pragma once
+
+#include <sol/sol.hpp>
+
+// Environments and instruction budgets for the entity scripts.
+// The functions of a level are closures of the level chunk and share its globals: sol::set_environment() would change
+// them for every function of the chunk, so a function is given its own environment by copying it (see Isolate()).
+// The budget is a count hook on the thread running the script, it yields the thread once the instructions are spent.
+// On LuaJIT the hooks are not called from compiled code, the budget only stops the interpreted scripts
+namespace ScriptSandbox
+{
+	// the globals can be read through the environment, what the script writes stays in the environment.
+	// A script can still write a global on purpose with '_G.name = value'
+	sol::table CreateEnvironment(sol::state_view lua);
+
+	// a copy of the function running in the environment, it shares the other upvalues (the locals of the level) with
+	// the original. C functions cannot be copied, they are returned as is
+	sol::function Isolate(const sol::function& function, const sol::table& environment);
+
+	// the environment a function returned by Isolate() runs in. Not valid when the function has none of its own
+	// (on Lua 5.3 a function that reads no global has no _ENV)
+	sol::table GetEnvironment(const sol::function& function);
+
+	// (re)starts the count, the thread yields without values after instructionBudget instructions
+	void SetInstructionBudget(lua_State* thread, int instructionBudget);
+	void RemoveInstructionBudget(lua_State* thread);
+
+	// whether the last yield of the thread came from its budget, reading it clears it
+	bool HasSpentInstructionBudget(lua_State* thread);
+}
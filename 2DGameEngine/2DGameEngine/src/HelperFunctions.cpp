@@ -19,3 +19,13 @@ glm::vec2 Helpers::CalculateRandomPosition()
         positionYRange(gen)
     );
 }
+
+std::uint64_t Helpers::CalculateChecksum(const void* data, std::size_t size, std::uint64_t checksum)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        checksum = (checksum ^ bytes[i]) * 1099511628211ull;
+    }
+    return checksum;
+}
@@ -1,8 +1,34 @@
 #pragma once
 
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
 #include "glm/glm.hpp"
 
 namespace Helpers
 {
 	glm::vec2 CalculateRandomPosition();
+
+	// the whole file with one read into 'content' (a std::string or a std::vector of bytes), false when it cannot be read
+	template <typename TBuffer>
+	bool ReadFile(const std::string& filePath, TBuffer& content)
+	{
+		std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+		content.resize(static_cast<std::size_t>(file.tellg()));
+		file.seekg(0);
+		if (!content.empty())
+		{
+			file.read(reinterpret_cast<char*>(&content[0]), static_cast<std::streamsize>(content.size()));
+		}
+		return static_cast<bool>(file);
+	}
+
+	// FNV-1a, 'checksum' continues the one of the data before
+	std::uint64_t CalculateChecksum(const void* data, std::size_t size, std::uint64_t checksum = 14695981039346656037ull);
 }
\ No newline at end of file
@@ -1,9 +1,53 @@
 #include "pch.h"
 
 #include "Game/Game.h"
+#include "Game/ScriptCache.h"
+#include "Game/LevelLoader.h"
+#include "Game/LuaBackend.h"
+#include "AssetStore/AssetArchive.h"
+#include "AssetStore/RawTexture.h"
 
 int main(int argc, char* argv[]) 
 {
+    // fills the script cache for shipping builds: 2DGameEngine --precompile-scripts
+    if (argc > 1 && std::string(argv[1]) == "--precompile-scripts")
+    {
+        // compiling does not need any library
+        sol::state lua;
+        ScriptCache scriptCache;
+        return scriptCache.Precompile(lua) == 0 ? 0 : 1;
+    }
+
+    // packs the assets into the archive the game mounts: 2DGameEngine --pack-assets
+    if (argc > 1 && std::string(argv[1]) == "--pack-assets")
+    {
+        return AssetArchive::Pack(CONST::ARCHIVE::ASSETS_DIRECTORY, CONST::ARCHIVE::ARCHIVE_PATH) ? 0 : 1;
+    }
+
+    // converts the images to raw textures before packing them: 2DGameEngine --convert-textures [--lz4]
+    if (argc > 1 && std::string(argv[1]) == "--convert-textures")
+    {
+        const bool compress = argc > 2 && std::string(argv[2]) == "--lz4";
+        const int numberOfErrors = RawTexture::ConvertDirectory(CONST::RAW_TEXTURES::IMAGES_DIRECTORY, CONST::RAW_TEXTURES::PIXEL_FORMAT,
+            compress ? RawTexture::Compression::LZ4 : RawTexture::Compression::NONE);
+        return numberOfErrors == 0 ? 0 : 1;
+    }
+
+    // compiles levels so that they are loaded without running their scripts: 2DGameEngine --compile-level Level1 Level2...
+    if (argc > 1 && std::string(argv[1]) == "--compile-level")
+    {
+        LevelLoader levelLoader;
+        int numberOfErrors = argc > 2 ? 0 : 1;
+        for (int i = 2; i < argc; i++)
+        {
+            // a state per level, each level keeps the globals its script defines. The scripts may call the libraries
+            sol::state lua;
+            LuaBackend::OpenLibraries(lua);
+            numberOfErrors += levelLoader.CompileLevel(argv[i], lua) ? 0 : 1;
+        }
+        return numberOfErrors == 0 ? 0 : 1;
+    }
+
     Game game;
 
     game.Initialize();
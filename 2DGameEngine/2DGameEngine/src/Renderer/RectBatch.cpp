@@ -0,0 +1,59 @@
+#include "pch.h"
+
+#include "RectBatch.h"
+
+void RectBatch::Add(const SDL_Rect& rect, const SDL_Color& color)
+{
+	for (std::size_t i = 0; i < m_numberOfColorsInUse; i++)
+	{
+		auto& colorGroup = m_colorGroups[i];
+		const bool isSameColor =
+			colorGroup.m_color.r == color.r &&
+			colorGroup.m_color.g == color.g &&
+			colorGroup.m_color.b == color.b &&
+			colorGroup.m_color.a == color.a;
+
+		if (isSameColor)
+		{
+			colorGroup.m_rects.push_back(rect);
+			return;
+		}
+	}
+
+	if (m_numberOfColorsInUse == m_colorGroups.size())
+	{
+		m_colorGroups.emplace_back();
+	}
+
+	auto& newColorGroup = m_colorGroups[m_numberOfColorsInUse];
+	newColorGroup.m_color = color;
+	newColorGroup.m_rects.push_back(rect);
+	m_numberOfColorsInUse++;
+}
+
+void RectBatch::RecordFilled(RenderCommandList& commandList)
+{
+	for (std::size_t i = 0; i < m_numberOfColorsInUse; i++)
+	{
+		commandList.AddFilledRects(m_colorGroups[i].m_rects, m_colorGroups[i].m_color);
+	}
+	Clear();
+}
+
+void RectBatch::RecordOutlines(RenderCommandList& commandList)
+{
+	for (std::size_t i = 0; i < m_numberOfColorsInUse; i++)
+	{
+		commandList.AddRectOutlines(m_colorGroups[i].m_rects, m_colorGroups[i].m_color);
+	}
+	Clear();
+}
+
+void RectBatch::Clear()
+{
+	for (auto& colorGroup : m_colorGroups)
+	{
+		colorGroup.m_rects.clear();
+	}
+	m_numberOfColorsInUse = 0;
+}
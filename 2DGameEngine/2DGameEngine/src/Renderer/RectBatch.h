@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include <SDL.h>
+
+#include "Renderer/RenderCommandList.h"
+
+// Groups rects by color so that overlays made of many small rects (health bars, colliders...)
+// are recorded as one FillRects/DrawRects command per color instead of one command per rect.
+// Overlays only use a few colors so they are kept in a vector, the memory is kept between frames
+class RectBatch
+{
+public:
+	RectBatch() = default;
+
+	void Add(const SDL_Rect& rect, const SDL_Color& color);
+
+	// records one command per color and empties the batch
+	void RecordFilled(RenderCommandList& commandList);
+	void RecordOutlines(RenderCommandList& commandList);
+
+	std::size_t GetNumberOfColors() const { return m_numberOfColorsInUse; }
+private:
+	struct ColorGroup
+	{
+		SDL_Color m_color;
+		std::vector<SDL_Rect> m_rects;
+	};
+
+	void Clear();
+
+	std::vector<ColorGroup> m_colorGroups;
+	// groups past this index are empty but keep their memory for the next frame
+	std::size_t m_numberOfColorsInUse = 0;
+};
@@ -0,0 +1,147 @@
+#include "pch.h"
+
+#include "RenderCommandList.h"
+
+void RenderCommandList::Reset()
+{
+	m_commands.clear();
+	m_textBuffer.clear();
+	m_rectBuffer.clear();
+}
+
+void RenderCommandList::AddClear(const SDL_Color& color)
+{
+	auto& command = AddCommand(RenderCommandType::Clear);
+	command.m_color = color;
+}
+
+void RenderCommandList::AddSprite(SDL_Texture* texture, const SDL_Rect& srcRect, const SDL_Rect& dstRect, double rotation, SDL_RendererFlip flip, unsigned int layer)
+{
+	auto& command = AddCommand(RenderCommandType::Sprite);
+	command.m_texture = texture;
+	command.m_srcRect = srcRect;
+	command.m_dstRect = dstRect;
+	command.m_rotation = rotation;
+	command.m_flip = flip;
+	command.m_layer = layer;
+}
+
+void RenderCommandList::AddFilledRects(const std::vector<SDL_Rect>& rects, const SDL_Color& color)
+{
+	AddRects(RenderCommandType::FillRects, rects, color);
+}
+
+void RenderCommandList::AddRectOutlines(const std::vector<SDL_Rect>& rects, const SDL_Color& color)
+{
+	AddRects(RenderCommandType::DrawRects, rects, color);
+}
+
+void RenderCommandList::AddText(TTF_Font* font, const std::string& text, const SDL_Color& color, int x, int y)
+{
+	auto& command = AddCommand(RenderCommandType::Text);
+	command.m_font = font;
+	command.m_color = color;
+	command.m_dstRect = SDL_Rect{ x, y, 0, 0 };
+	command.m_textOffset = m_textBuffer.size();
+
+	// null terminated so that it can be handed to SDL_ttf as it is
+	m_textBuffer.append(text);
+	m_textBuffer.push_back('\0');
+}
+
+void RenderCommandList::Execute(SDL_Renderer* renderer)
+{
+	m_numberOfDrawCalls = 0;
+
+	std::size_t i = 0;
+	while (i < m_commands.size())
+	{
+		const auto& command = m_commands[i];
+		switch (command.m_type)
+		{
+		case RenderCommandType::Clear:
+			SDL_SetRenderDrawColor(renderer, command.m_color.r, command.m_color.g, command.m_color.b, command.m_color.a);
+			SDL_RenderClear(renderer);
+			break;
+		case RenderCommandType::Sprite:
+			// ExecuteSprites() consumes all the sprites that follow this one
+			i = ExecuteSprites(renderer, i);
+			continue;
+		case RenderCommandType::FillRects:
+			SDL_SetRenderDrawColor(renderer, command.m_color.r, command.m_color.g, command.m_color.b, command.m_color.a);
+			SDL_RenderFillRects(renderer, &m_rectBuffer[command.m_rectOffset], static_cast<int>(command.m_rectCount));
+			m_numberOfDrawCalls++;
+			break;
+		case RenderCommandType::DrawRects:
+			SDL_SetRenderDrawColor(renderer, command.m_color.r, command.m_color.g, command.m_color.b, command.m_color.a);
+			SDL_RenderDrawRects(renderer, &m_rectBuffer[command.m_rectOffset], static_cast<int>(command.m_rectCount));
+			m_numberOfDrawCalls++;
+			break;
+		case RenderCommandType::Text:
+			ExecuteText(renderer, command);
+			break;
+		}
+		i++;
+	}
+}
+
+RenderCommand& RenderCommandList::AddCommand(RenderCommandType type)
+{
+	m_commands.emplace_back();
+	auto& command = m_commands.back();
+	command = RenderCommand{};
+	command.m_type = type;
+	return command;
+}
+
+void RenderCommandList::AddRects(RenderCommandType type, const std::vector<SDL_Rect>& rects, const SDL_Color& color)
+{
+	if (rects.empty()) return;
+
+	auto& command = AddCommand(type);
+	command.m_color = color;
+	command.m_rectOffset = m_rectBuffer.size();
+	command.m_rectCount = rects.size();
+
+	m_rectBuffer.insert(m_rectBuffer.end(), rects.begin(), rects.end());
+}
+
+std::size_t RenderCommandList::ExecuteSprites(SDL_Renderer* renderer, std::size_t firstSprite)
+{
+	std::size_t i = firstSprite;
+
+	m_spriteBatch.Begin();
+	while (i < m_commands.size() && m_commands[i].m_type == RenderCommandType::Sprite)
+	{
+		const auto& command = m_commands[i];
+		m_spriteBatch.Draw(command.m_texture, command.m_srcRect, command.m_dstRect, command.m_rotation, command.m_flip, command.m_layer);
+		i++;
+	}
+	m_spriteBatch.End(renderer);
+
+	m_numberOfDrawCalls += m_spriteBatch.GetNumberOfDrawCalls();
+	return i;
+}
+
+void RenderCommandList::ExecuteText(SDL_Renderer* renderer, const RenderCommand& command)
+{
+	SDL_Surface* surface = TTF_RenderText_Blended(
+		command.m_font,
+		&m_textBuffer[command.m_textOffset],
+		command.m_color
+	);
+	if (!surface) return;
+
+	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+	SDL_FreeSurface(surface);
+
+	int labelWidth = 0;
+	int labelHeight = 0;
+	SDL_QueryTexture(texture, NULL, NULL, &labelWidth, &labelHeight);
+
+	const SDL_Rect dstRect{ command.m_dstRect.x, command.m_dstRect.y, labelWidth, labelHeight };
+
+	SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+	SDL_DestroyTexture(texture);
+	m_numberOfDrawCalls++;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "Renderer/SpriteBatch.h"
+
+enum class RenderCommandType
+{
+	Clear,
+	Sprite,
+	FillRects,
+	DrawRects,
+	Text
+};
+
+// everything a command needs is copied into it when it is recorded so that executing it
+// never reads a component. Textures and fonts are only pointed to, they belong to the AssetStore
+struct RenderCommand
+{
+	RenderCommandType m_type;
+	SDL_Color m_color;
+	SDL_Rect m_srcRect;
+	SDL_Rect m_dstRect;
+	double m_rotation;
+	SDL_RendererFlip m_flip;
+	unsigned int m_layer;
+	SDL_Texture* m_texture;
+	TTF_Font* m_font;
+	// text is stored in the list's text buffer to avoid one string allocation per command
+	std::size_t m_textOffset;
+	// rects of FillRects/DrawRects are stored in the list's rect buffer
+	std::size_t m_rectOffset;
+	std::size_t m_rectCount;
+};
+
+// Draw commands of one frame, in the order they have to be executed.
+// Render systems record into it on the main thread, Execute() issues the SDL calls.
+// Consecutive sprite commands are drawn through a SpriteBatch
+class RenderCommandList
+{
+public:
+	RenderCommandList() = default;
+
+	// removes all the commands but keeps the memory for the next frame
+	void Reset();
+
+	void AddClear(const SDL_Color& color);
+	void AddSprite(SDL_Texture* texture, const SDL_Rect& srcRect, const SDL_Rect& dstRect, double rotation, SDL_RendererFlip flip, unsigned int layer);
+	// all the rects are drawn with one SDL call, see RectBatch
+	void AddFilledRects(const std::vector<SDL_Rect>& rects, const SDL_Color& color);
+	void AddRectOutlines(const std::vector<SDL_Rect>& rects, const SDL_Color& color);
+	// 'x' and 'y' are the top left corner of the text
+	void AddText(TTF_Font* font, const std::string& text, const SDL_Color& color, int x, int y);
+
+	void Execute(SDL_Renderer* renderer);
+
+	std::size_t GetNumberOfCommands() const { return m_commands.size(); }
+	// SDL draw calls issued by the last Execute()
+	std::size_t GetNumberOfDrawCalls() const { return m_numberOfDrawCalls; }
+private:
+	RenderCommand& AddCommand(RenderCommandType type);
+	std::size_t ExecuteSprites(SDL_Renderer* renderer, std::size_t firstSprite);
+	void ExecuteText(SDL_Renderer* renderer, const RenderCommand& command);
+	void AddRects(RenderCommandType type, const std::vector<SDL_Rect>& rects, const SDL_Color& color);
+
+	std::vector<RenderCommand> m_commands;
+	std::string m_textBuffer;
+	std::vector<SDL_Rect> m_rectBuffer;
+
+	SpriteBatch m_spriteBatch;
+	std::size_t m_numberOfDrawCalls = 0;
+};
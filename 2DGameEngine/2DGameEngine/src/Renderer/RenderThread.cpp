@@ -0,0 +1,181 @@
+#include "pch.h"
+
+#include "RenderThread.h"
+
+#include "Logger/Logger.h"
+
+RenderThread::RenderThread(std::function<SDL_Renderer*()> createRenderer)
+	: m_createRenderer(std::move(createRenderer))
+{
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+bool RenderThread::Start(bool shouldUseThread)
+{
+	if (IsRunning() || m_renderer) return true;
+
+	if (!shouldUseThread)
+	{
+		m_renderer = m_createRenderer();
+		return m_renderer != nullptr;
+	}
+
+	m_shouldStop = false;
+	m_isFramePending = false;
+	m_hasCreatedRenderer = false;
+	m_thread = std::thread(&RenderThread::RenderLoop, this);
+
+	// the thread ends right away when it could not create the renderer
+	bool isRendererCreated = false;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workDone.wait(lock, [this]() { return m_hasCreatedRenderer; });
+		isRendererCreated = m_renderer != nullptr;
+	}
+	if (!isRendererCreated)
+	{
+		m_thread.join();
+		return false;
+	}
+
+	Logger::Log("render thread started");
+	return true;
+}
+
+void RenderThread::Stop()
+{
+	if (!IsRunning())
+	{
+		if (m_renderer)
+		{
+			SDL_DestroyRenderer(m_renderer);
+			m_renderer = nullptr;
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shouldStop = true;
+	}
+	m_workSubmitted.notify_one();
+	m_thread.join();
+	Logger::Log("render thread stopped");
+}
+
+void RenderThread::SubmitFrame()
+{
+	if (!IsRunning())
+	{
+		ExecuteFrame(GetRecordingList());
+		GetRecordingList().Reset();
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workDone.wait(lock, [this]() { return !m_isFramePending; });
+
+		m_recordingListIndex = 1 - m_recordingListIndex;
+		m_isFramePending = true;
+	}
+	m_workSubmitted.notify_one();
+
+	// this list was executed two frames ago, the render thread is done with it
+	GetRecordingList().Reset();
+}
+
+void RenderThread::Run(const Job& job)
+{
+	if (!IsRunning())
+	{
+		job(m_renderer);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingJob = &job;
+	}
+	m_workSubmitted.notify_one();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_workDone.wait(lock, [this]() { return m_pendingJob == nullptr; });
+}
+
+void RenderThread::RenderLoop()
+{
+	SDL_Renderer* renderer = m_createRenderer();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_renderer = renderer;
+		m_hasCreatedRenderer = true;
+	}
+	m_workDone.notify_all();
+	if (!renderer)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		int submittedListIndex = -1;
+		const Job* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workSubmitted.wait(lock, [this]() { return m_isFramePending || m_pendingJob || m_shouldStop; });
+
+			// the submitted frame goes first, it was recorded before the job was given.
+			// A frame that is already submitted is still presented before stopping
+			if (m_isFramePending)
+			{
+				submittedListIndex = 1 - m_recordingListIndex;
+			}
+			else if (m_pendingJob)
+			{
+				job = m_pendingJob;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		if (job)
+		{
+			(*job)(renderer);
+		}
+		else
+		{
+			ExecuteFrame(m_commandLists[submittedListIndex]);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (job)
+			{
+				m_pendingJob = nullptr;
+			}
+			else
+			{
+				m_isFramePending = false;
+			}
+		}
+		m_workDone.notify_all();
+	}
+
+	SDL_DestroyRenderer(renderer);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_renderer = nullptr;
+}
+
+void RenderThread::ExecuteFrame(RenderCommandList& commandList)
+{
+	commandList.Execute(m_renderer);
+	SDL_RenderPresent(m_renderer);
+	m_numberOfDrawCalls = commandList.GetNumberOfDrawCalls();
+}
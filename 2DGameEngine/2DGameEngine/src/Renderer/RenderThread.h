@@ -0,0 +1,81 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include "Renderer/RenderCommandList.h"
+
+namespace CONST
+{
+	namespace RENDERING
+	{
+		// when false the renderer is created on the main thread and every frame is executed there right after it is recorded
+		constexpr bool USE_RENDER_THREAD = true;
+	}
+}
+
+// Owns the renderer and two command lists: the main thread records frame N+1 into one while the render
+// thread executes and presents frame N from the other.
+//
+// Handoff rules:
+// - only the main thread touches the recording list (GetRecordingList()) and the registry
+// - SubmitFrame() waits for the render thread to finish the previous frame, then swaps the lists.
+//   After the swap the render thread owns the submitted list and the main thread owns the other one
+// - commands hold copies of component data, the render thread never reads a component
+// - SDL renderers (and the GL or D3D contexts behind them) can only be used from the thread that created them:
+//   the renderer is created, used and destroyed on the render thread. Anything else that needs it (loading textures,
+//   destroying assets...) is a job given to Run(), the calling thread waits while the render thread runs it
+class RenderThread
+{
+public:
+	using Job = std::function<void(SDL_Renderer* renderer)>;
+
+	// 'createRenderer' is called by the thread that is going to use the renderer, see Start()
+	RenderThread(std::function<SDL_Renderer*()> createRenderer);
+	~RenderThread();
+
+	// creates the renderer on the render thread, or on the calling thread which then executes the frames and the jobs
+	// itself when 'shouldUseThread' is false. False when the renderer could not be created
+	bool Start(bool shouldUseThread = CONST::RENDERING::USE_RENDER_THREAD);
+	// the frame already submitted is presented, then the renderer is destroyed on its thread
+	void Stop();
+	bool IsRunning() const { return m_thread.joinable(); }
+
+	RenderCommandList& GetRecordingList() { return m_commandLists[m_recordingListIndex]; }
+
+	// hands the recorded frame to the render thread, if the thread was not started
+	// the frame is executed and presented on the calling thread instead
+	void SubmitFrame();
+
+	// runs the job with the renderer on the thread using it and waits until it is done. The frame submitted before
+	// is executed first, a job can destroy the textures it used
+	void Run(const Job& job);
+
+	// draw calls of the last executed frame
+	std::size_t GetNumberOfDrawCalls() const { return m_numberOfDrawCalls; }
+private:
+	void RenderLoop();
+	void ExecuteFrame(RenderCommandList& commandList);
+
+	std::function<SDL_Renderer*()> m_createRenderer;
+	SDL_Renderer* m_renderer = nullptr;
+
+	RenderCommandList m_commandLists[2];
+	int m_recordingListIndex = 0;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	// a frame, a job or the stop was given to the render thread / the render thread is done with it
+	std::condition_variable m_workSubmitted;
+	std::condition_variable m_workDone;
+	bool m_hasCreatedRenderer = false;
+	bool m_isFramePending = false;
+	const Job* m_pendingJob = nullptr;
+	bool m_shouldStop = false;
+
+	// written by the render thread, read by the main thread for profiling
+	std::atomic<std::size_t> m_numberOfDrawCalls{ 0 };
+};
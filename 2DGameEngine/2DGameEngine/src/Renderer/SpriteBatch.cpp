@@ -0,0 +1,156 @@
+#include "pch.h"
+
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Logger/Logger.h"
+
+void SpriteBatch::Begin()
+{
+	m_items.clear();
+}
+
+void SpriteBatch::Draw(SDL_Texture* texture, const SDL_Rect& srcRect, const SDL_Rect& dstRect, double rotation, SDL_RendererFlip flip, unsigned int layer)
+{
+	if (!texture) return;
+
+	m_items.push_back(BatchItem{ texture, srcRect, dstRect, rotation, flip, layer });
+}
+
+void SpriteBatch::End(SDL_Renderer* renderer)
+{
+	m_numberOfDrawCalls = 0;
+	m_numberOfSprites = m_items.size();
+
+	// stable: the sprites of a layer keep the order they were drawn in
+	std::stable_sort(m_items.begin(), m_items.end(),
+		[](const BatchItem& first, const BatchItem& second)
+		{
+			return first.m_layer < second.m_layer;
+		}
+	);
+
+	// every run of consecutive items with the same texture is one batch
+	std::size_t first = 0;
+	while (first < m_items.size())
+	{
+		std::size_t last = first + 1;
+		while (last < m_items.size() && m_items[last].m_texture == m_items[first].m_texture)
+		{
+			last++;
+		}
+
+#if ENGINE_HAS_RENDER_GEOMETRY
+		const bool wasDrawn = m_isRenderGeometryAvailable && DrawItemsWithRenderGeometry(renderer, first, last);
+		if (!wasDrawn)
+		{
+			DrawItemsWithRenderCopy(renderer, first, last);
+		}
+#else
+		DrawItemsWithRenderCopy(renderer, first, last);
+#endif
+		first = last;
+	}
+
+	m_items.clear();
+}
+
+void SpriteBatch::DrawItemsWithRenderCopy(SDL_Renderer* renderer, std::size_t first, std::size_t last)
+{
+	for (std::size_t i = first; i < last; i++)
+	{
+		const auto& item = m_items[i];
+		SDL_RenderCopyEx(renderer, item.m_texture, &item.m_srcRect, &item.m_dstRect, item.m_rotation, NULL, item.m_flip);
+		m_numberOfDrawCalls++;
+	}
+}
+
+#if ENGINE_HAS_RENDER_GEOMETRY
+bool SpriteBatch::DrawItemsWithRenderGeometry(SDL_Renderer* renderer, std::size_t first, std::size_t last)
+{
+	SDL_Texture* texture = m_items[first].m_texture;
+
+	int textureWidth = 0;
+	int textureHeight = 0;
+	if (SDL_QueryTexture(texture, NULL, NULL, &textureWidth, &textureHeight) != 0 || textureWidth == 0 || textureHeight == 0)
+	{
+		return false;
+	}
+
+	// SDL_RenderGeometry ignores the texture color and alpha mod, they go in the vertex color instead
+	SDL_Color color{ 255, 255, 255, 255 };
+	SDL_GetTextureColorMod(texture, &color.r, &color.g, &color.b);
+	SDL_GetTextureAlphaMod(texture, &color.a);
+
+	m_vertices.clear();
+	m_indices.clear();
+	m_vertices.reserve((last - first) * 4);
+	m_indices.reserve((last - first) * 6);
+
+	const float degreesToRadians = static_cast<float>(M_PI / 180.0);
+	for (std::size_t i = first; i < last; i++)
+	{
+		const auto& item = m_items[i];
+
+		float u0 = static_cast<float>(item.m_srcRect.x) / textureWidth;
+		float u1 = static_cast<float>(item.m_srcRect.x + item.m_srcRect.w) / textureWidth;
+		float v0 = static_cast<float>(item.m_srcRect.y) / textureHeight;
+		float v1 = static_cast<float>(item.m_srcRect.y + item.m_srcRect.h) / textureHeight;
+		if (item.m_flip & SDL_FLIP_HORIZONTAL) std::swap(u0, u1);
+		if (item.m_flip & SDL_FLIP_VERTICAL) std::swap(v0, v1);
+
+		// same as SDL_RenderCopyEx: rotate clockwise around the center of the destination rect
+		const float halfWidth = item.m_dstRect.w * .5f;
+		const float halfHeight = item.m_dstRect.h * .5f;
+		const float centerX = item.m_dstRect.x + halfWidth;
+		const float centerY = item.m_dstRect.y + halfHeight;
+		const float cosine = std::cos(static_cast<float>(item.m_rotation) * degreesToRadians);
+		const float sine = std::sin(static_cast<float>(item.m_rotation) * degreesToRadians);
+
+		const SDL_FPoint corners[4] =
+		{
+			{ -halfWidth, -halfHeight },
+			{ halfWidth, -halfHeight },
+			{ halfWidth, halfHeight },
+			{ -halfWidth, halfHeight }
+		};
+		const SDL_FPoint uvs[4] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+
+		const int firstVertex = static_cast<int>(m_vertices.size());
+		for (int corner = 0; corner < 4; corner++)
+		{
+			const SDL_FPoint position
+			{
+				centerX + corners[corner].x * cosine - corners[corner].y * sine,
+				centerY + corners[corner].x * sine + corners[corner].y * cosine
+			};
+			m_vertices.push_back(SDL_Vertex{ position, color, uvs[corner] });
+		}
+
+		m_indices.insert(m_indices.end(), {
+			firstVertex, firstVertex + 1, firstVertex + 2,
+			firstVertex, firstVertex + 2, firstVertex + 3 });
+	}
+
+	const bool errorRenderingGeometry = SDL_RenderGeometry(
+		renderer,
+		texture,
+		m_vertices.data(),
+		static_cast<int>(m_vertices.size()),
+		m_indices.data(),
+		static_cast<int>(m_indices.size())) != 0;
+
+	if (errorRenderingGeometry)
+	{
+		// the renderer does not support it, stop trying for the rest of the session
+		Logger::Error("SDL_RenderGeometry failed, falling back to SDL_RenderCopyEx: " + std::string(SDL_GetError()));
+		m_isRenderGeometryAvailable = false;
+		return false;
+	}
+
+	m_numberOfDrawCalls++;
+	return true;
+}
+#endif
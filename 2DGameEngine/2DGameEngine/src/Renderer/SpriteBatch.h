@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include <SDL.h>
+
+// SDL_RenderGeometry only exists since SDL 2.0.18, older SDL versions draw every sprite with SDL_RenderCopyEx
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#define ENGINE_HAS_RENDER_GEOMETRY 1
+#else
+#define ENGINE_HAS_RENDER_GEOMETRY 0
+#endif
+
+// Accumulates sprites during a frame and submits consecutive sprites that share a texture
+// as one SDL_RenderGeometry call. Rotation and flip are baked into the vertex positions and uvs.
+//
+// sprites are drawn by layer (z-index) and, inside a layer, in the order they were drawn: only the
+// adjacent sprites of a layer that share a texture are batched, the overlaps stay the same as per sprite draws
+class SpriteBatch
+{
+public:
+	SpriteBatch() = default;
+
+	void Begin();
+	void Draw(SDL_Texture* texture, const SDL_Rect& srcRect, const SDL_Rect& dstRect, double rotation, SDL_RendererFlip flip, unsigned int layer);
+	void End(SDL_Renderer* renderer);
+
+	// both refer to the last End() call
+	std::size_t GetNumberOfDrawCalls() const { return m_numberOfDrawCalls; }
+	std::size_t GetNumberOfSprites() const { return m_numberOfSprites; }
+
+	bool IsUsingRenderGeometry() const { return m_isRenderGeometryAvailable; }
+private:
+	struct BatchItem
+	{
+		SDL_Texture* m_texture;
+		SDL_Rect m_srcRect;
+		SDL_Rect m_dstRect;
+		double m_rotation;
+		SDL_RendererFlip m_flip;
+		unsigned int m_layer;
+	};
+
+	void DrawItemsWithRenderCopy(SDL_Renderer* renderer, std::size_t first, std::size_t last);
+
+	std::vector<BatchItem> m_items;
+
+#if ENGINE_HAS_RENDER_GEOMETRY
+	bool DrawItemsWithRenderGeometry(SDL_Renderer* renderer, std::size_t first, std::size_t last);
+
+	std::vector<SDL_Vertex> m_vertices;
+	std::vector<int> m_indices;
+	bool m_isRenderGeometryAvailable = true;
+#else
+	bool m_isRenderGeometryAvailable = false;
+#endif
+
+	std::size_t m_numberOfDrawCalls = 0;
+	std::size_t m_numberOfSprites = 0;
+};
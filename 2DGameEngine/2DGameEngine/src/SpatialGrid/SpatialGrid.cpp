@@ -0,0 +1,130 @@
+#include "pch.h"
+
+#include "SpatialGrid.h"
+
+#include <cmath>
+
+SpatialGrid::SpatialGrid(int cellSize)
+	: m_cellSize(cellSize > 0 ? cellSize : CONST::SPATIAL_GRID::CELL_SIZE)
+{
+}
+
+void SpatialGrid::Insert(Entity entity, const SDL_FRect& bounds)
+{
+	if (Contains(entity))
+	{
+		Remove(entity);
+	}
+
+	const float halfWidth = bounds.w * .5f;
+	const float halfHeight = bounds.h * .5f;
+	m_maxHalfWidth = std::max(m_maxHalfWidth, halfWidth);
+	m_maxHalfHeight = std::max(m_maxHalfHeight, halfHeight);
+
+	const long long cellKey = CalculateCellKey(
+		CalculateCellCoordinate(bounds.x + halfWidth),
+		CalculateCellCoordinate(bounds.y + halfHeight));
+
+	m_cells[cellKey].push_back(GridItem{ entity, bounds });
+	m_cellPerEntity[entity.GetId()] = cellKey;
+}
+
+void SpatialGrid::Remove(Entity entity)
+{
+	const auto entityCell = m_cellPerEntity.find(entity.GetId());
+	if (entityCell == m_cellPerEntity.end())
+	{
+		return;
+	}
+
+	auto cell = m_cells.find(entityCell->second);
+	if (cell != m_cells.end())
+	{
+		auto& cellItems = cell->second;
+		cellItems.erase(
+			std::remove_if(cellItems.begin(), cellItems.end(),
+				[&entity](const GridItem& item)
+				{
+					return item.m_entity == entity;
+				}
+			),
+			cellItems.end());
+
+		if (cellItems.empty())
+		{
+			m_cells.erase(cell);
+		}
+	}
+	m_cellPerEntity.erase(entityCell);
+}
+
+bool SpatialGrid::Contains(Entity entity) const
+{
+	return m_cellPerEntity.find(entity.GetId()) != m_cellPerEntity.end();
+}
+
+void SpatialGrid::Clear()
+{
+	m_cells.clear();
+	m_cellPerEntity.clear();
+	m_maxHalfWidth = 0;
+	m_maxHalfHeight = 0;
+}
+
+std::size_t SpatialGrid::GetSize() const
+{
+	return m_cellPerEntity.size();
+}
+
+std::size_t SpatialGrid::GetNumberOfCells() const
+{
+	return m_cells.size();
+}
+
+void SpatialGrid::Query(const SDL_Rect& area, std::vector<Entity>& entitiesInArea) const
+{
+	if (m_cells.empty())
+	{
+		return;
+	}
+
+	// an entity can be stored in a cell outside the area as long as half of it is inside
+	const int firstCellX = CalculateCellCoordinate(area.x - m_maxHalfWidth);
+	const int lastCellX = CalculateCellCoordinate(area.x + area.w + m_maxHalfWidth);
+	const int firstCellY = CalculateCellCoordinate(area.y - m_maxHalfHeight);
+	const int lastCellY = CalculateCellCoordinate(area.y + area.h + m_maxHalfHeight);
+
+	for (int cellY = firstCellY; cellY <= lastCellY; cellY++)
+	{
+		for (int cellX = firstCellX; cellX <= lastCellX; cellX++)
+		{
+			const auto cell = m_cells.find(CalculateCellKey(cellX, cellY));
+			if (cell == m_cells.end()) continue;
+
+			for (const auto& item : cell->second)
+			{
+				const auto& bounds = item.m_bounds;
+				const bool isOutsideArea =
+					bounds.x + bounds.w < area.x ||
+					bounds.x > area.x + area.w ||
+					bounds.y + bounds.h < area.y ||
+					bounds.y > area.y + area.h;
+
+				if (!isOutsideArea)
+				{
+					entitiesInArea.push_back(item.m_entity);
+				}
+			}
+		}
+	}
+}
+
+long long SpatialGrid::CalculateCellKey(int cellX, int cellY) const
+{
+	return (static_cast<long long>(cellX) << 32) | static_cast<unsigned int>(cellY);
+}
+
+int SpatialGrid::CalculateCellCoordinate(float worldCoordinate) const
+{
+	return static_cast<int>(std::floor(worldCoordinate / m_cellSize));
+}
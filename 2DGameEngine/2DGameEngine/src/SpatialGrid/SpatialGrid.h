@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include <SDL.h>
+
+#include "ECS/ECS.h"
+
+namespace CONST
+{
+	namespace SPATIAL_GRID
+	{
+		constexpr int CELL_SIZE = 256;
+	}
+}
+
+// Loose uniform grid used to find which entities intersect an area without testing all of them.
+// Each entity is stored only in the cell that contains the center of its bounds, queries are then
+// expanded by the biggest half extent ever inserted so that entities overlapping a neighbour cell are still found.
+// Meant for entities that do not move, bounds are not updated after Insert()
+class SpatialGrid
+{
+public:
+	SpatialGrid(int cellSize = CONST::SPATIAL_GRID::CELL_SIZE);
+
+	void Insert(Entity entity, const SDL_FRect& bounds);
+	void Remove(Entity entity);
+	bool Contains(Entity entity) const;
+	void Clear();
+
+	std::size_t GetSize() const;
+	std::size_t GetNumberOfCells() const;
+
+	// appends to 'entitiesInArea' every entity whose bounds intersect 'area'
+	void Query(const SDL_Rect& area, std::vector<Entity>& entitiesInArea) const;
+private:
+	struct GridItem
+	{
+		Entity m_entity;
+		SDL_FRect m_bounds;
+	};
+
+	long long CalculateCellKey(int cellX, int cellY) const;
+	int CalculateCellCoordinate(float worldCoordinate) const;
+
+	int m_cellSize;
+	float m_maxHalfWidth = 0;
+	float m_maxHalfHeight = 0;
+
+	std::unordered_map<long long, std::vector<GridItem>> m_cells;
+	// [ key = entity id, value = key of the cell the entity is in ]
+	std::unordered_map<std::size_t, long long> m_cellPerEntity;
+};
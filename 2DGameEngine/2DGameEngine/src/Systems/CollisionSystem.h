@@ -17,6 +17,8 @@ public:
 		RequireComponent<BoxColliderComponent>();
 	}
 
+	// the collisions are only enqueued, the handlers run when the caller dispatches the queued events
+	// so that no component is modified while the colliders are being checked.
 	// not a fan of this arg, violates R.34 of guidelines since eventBus is not being reseated
 	void Update(std::unique_ptr<EventBus>& eventBus)
 	{
@@ -43,7 +45,7 @@ public:
 							const bool collisionDetected = CheckAABBCollision(firstTransform, firstCollider, secondTransform, secondCollider);
 							if (collisionDetected)
 							{
-								eventBus->EmitEvent<CollisionEvent>(first, second);
+								eventBus->EnqueueEvent<CollisionEvent>(first, second);
 								firstCollider.m_isColliding = true;
 								secondCollider.m_isColliding = true;
 								//Logger::Log("emitted collision");
@@ -22,15 +22,20 @@ public:
 
 	void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus)
 	{
-		eventBus->SubscribeToEvent<CollisionEvent>(this, &DamageSystem::OnCollision);
+		m_collisionSubscription = eventBus->SubscribeToEvent<&DamageSystem::OnCollisions>(this);
+	}
 
+	// called once per frame with every collision, in the order CollisionSystem found them
+	void OnCollisions(EventSpan<CollisionEvent> collisions)
+	{
+		for (const auto& collision : collisions)
+		{
+			OnCollision(collision.m_a, collision.m_b);
+		}
 	}
 
-	void OnCollision(CollisionEvent& eventParams)
+	void OnCollision(Entity a, Entity b)
 	{
-		Entity& a = eventParams.m_a;
-		Entity& b = eventParams.m_b;
-		
 		//Logger::Log("CollisionEvent between: " + std::to_string(a.GetId()) + " and " + std::to_string(b.GetId()));
 		
 		// projectile and player collisions
@@ -55,6 +60,8 @@ public:
 	}
 
 private:
+	EventSubscription m_collisionSubscription;
+
 	void OnProjectileCollidesPlayer(Entity& projectile, Entity& player)
 	{
 		const auto& projectileComponent = projectile.GetComponent<ProjectileComponent>();
@@ -33,10 +33,10 @@ public:
 
 	void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus)
 	{
-		//eventBus->SubscribeToEvent<KeyPressedEvent>(this, &KeyboardControlSystem::OnKeyPressed);
+		//m_keyPressedSubscription = eventBus->SubscribeToEvent<&KeyboardControlSystem::OnKeyPressed>(this);
 	}
 
-	void OnKeyPressed(KeyPressedEvent& keyPressedEvent)
+	void OnKeyPressed(const KeyPressedEvent& keyPressedEvent)
 	{
 		for (auto entity : GetSystemEntities())
 		{
@@ -144,4 +144,7 @@ public:
 			rigidbody.m_velocity = newVelocity;
 		}
 	}
+
+private:
+	EventSubscription m_keyPressedSubscription;
 };
\ No newline at end of file
@@ -22,14 +22,20 @@ public:
 
 	void SubscribeToEvents(const std::unique_ptr<EventBus>& eventBus)
 	{
-		eventBus->SubscribeToEvent<CollisionEvent>(this, &MovementSystem::OnCollision);
+		m_collisionSubscription = eventBus->SubscribeToEvent<&MovementSystem::OnCollisions>(this);
 	}
 
-	void OnCollision(CollisionEvent& eventParams)
+	// called once per frame with every collision, in the order CollisionSystem found them
+	void OnCollisions(EventSpan<CollisionEvent> collisions)
 	{
-		Entity& a = eventParams.m_a;
-		Entity& b = eventParams.m_b;
+		for (const auto& collision : collisions)
+		{
+			OnCollision(collision.m_a, collision.m_b);
+		}
+	}
 
+	void OnCollision(Entity a, Entity b)
+	{
 		// enemy and obstacle collision
 		if (a.BelongsToGroup("enemies") && b.BelongsToGroup("obstacles"))
 		{
@@ -122,6 +128,8 @@ public:
 	}
 
 private:
+	EventSubscription m_collisionSubscription;
+
 	void StopEntity(Entity& entityToStop)
 	{
 		entityToStop.GetComponent<RigidbodyComponent>().m_velocity = { 0,0 };
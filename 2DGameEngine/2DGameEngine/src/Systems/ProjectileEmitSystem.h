@@ -21,16 +21,37 @@ public:
 	{
 		RequireComponent<ProjectileEmitterComponent>();
 		RequireComponent<TransformComponent>();
+
+		// the components shared by all the projectiles, the ones of each shot are set after they are instantiated
+		m_projectilePrefab.Group("projectiles");
+		m_projectilePrefab.AddComponent<TransformComponent>();
+		m_projectilePrefab.AddComponent<RigidbodyComponent>();
+		m_projectilePrefab.AddComponent<SpriteComponent>("bullet-image", 64, 64, 4);
+		m_projectilePrefab.AddComponent<BoxColliderComponent>();
+		m_projectilePrefab.AddComponent<ProjectileComponent>();
+
+		const float scaleFactorX = 0.15f;
+		const float scaleFactorY = 0.15f;
+		const int spriteWidth = 64;
+		const int spriteHeight = 64;
+		m_playerProjectilePrefab.Group("projectiles");
+		m_playerProjectilePrefab.AddComponent<TransformComponent>(glm::vec2(0, 0), glm::vec2(scaleFactorX, scaleFactorY));
+		m_playerProjectilePrefab.AddComponent<RigidbodyComponent>();
+		m_playerProjectilePrefab.AddComponent<SpriteComponent>("bullet-image", spriteWidth, spriteHeight, 4);
+		m_playerProjectilePrefab.AddComponent<BoxColliderComponent>(spriteWidth * scaleFactorX, spriteHeight * scaleFactorY);
+		m_playerProjectilePrefab.AddComponent<ProjectileComponent>();
 	}
 
 	void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus)
 	{
-		eventBus->SubscribeToEvent<LeftMouseButtonDownEvent>(this, &ProjectileEmitSystem::StartCountingTimeFireProjectileButtonHeldDown);
-		eventBus->SubscribeToEvent<LeftMouseButtonUpEvent>(this, &ProjectileEmitSystem::FireProjectile);
+		m_mouseButtonDownSubscription = eventBus->SubscribeToEvent<&ProjectileEmitSystem::StartCountingTimeFireProjectileButtonHeldDown>(this);
+		m_mouseButtonUpSubscription = eventBus->SubscribeToEvent<&ProjectileEmitSystem::FireProjectile>(this);
 	}
 
 	void Update(std::unique_ptr<Registry>& registry)
 	{
+		// the emitters that shoot this frame, their projectiles are instantiated together
+		m_emittingEntities.clear();
 		for (auto& entity : GetSystemEntities())
 		{
 			auto& projectileEmitter = entity.GetComponent<ProjectileEmitterComponent>();
@@ -40,31 +61,52 @@ public:
 
 			if (shouldEmitProjectile && !isPlayer)
 			{
-				const auto& transform = entity.GetComponent<TransformComponent>();
-				
-				auto projectile = registry->CreateEntity();
-				projectile.Group("projectiles");
-				glm::vec2 projectileSpawnPosition = transform.m_position;
+				m_emittingEntities.push_back(entity);
+			}
+		}
 
-				if (entity.HasComponent<SpriteComponent>())
-				{
-					const auto& sprite = entity.GetComponent<SpriteComponent>();
-					projectileSpawnPosition.x += (transform.m_scale.x * sprite.m_width * .5f);
-					projectileSpawnPosition.y += (transform.m_scale.y * sprite.m_height * .5f);
-				}
+		if (m_emittingEntities.empty())
+		{
+			return;
+		}
+
+		const std::vector<Entity> projectiles = registry->Instantiate(m_projectilePrefab, m_emittingEntities.size());
+		for (std::size_t i = 0; i < projectiles.size(); i++)
+		{
+			const Entity& entity = m_emittingEntities[i];
+			auto& projectileEmitter = entity.GetComponent<ProjectileEmitterComponent>();
 
-				projectile.AddComponent<TransformComponent>(projectileSpawnPosition);
-				projectile.AddComponent<RigidbodyComponent>(projectileEmitter.m_velocity);
-				projectile.AddComponent<SpriteComponent>("bullet-image", 64, 64, 4);
-				projectile.AddComponent<BoxColliderComponent>();
-				projectile.AddComponent<ProjectileComponent>(projectileEmitter.m_shouldCollideWithPlayer, projectileEmitter.m_damagePercentage);
+			projectiles[i].GetComponent<TransformComponent>().m_position = GetProjectileSpawnPosition(entity);
+			projectiles[i].GetComponent<RigidbodyComponent>() = RigidbodyComponent(projectileEmitter.m_velocity);
+			projectiles[i].GetComponent<ProjectileComponent>() = ProjectileComponent(projectileEmitter.m_shouldCollideWithPlayer, projectileEmitter.m_damagePercentage);
 
-				projectileEmitter.m_lastEmissionTimeInMs = SDL_GetTicks();
-			}
+			projectileEmitter.m_lastEmissionTimeInMs = SDL_GetTicks();
 		}
 	}
 private:
-	void StartCountingTimeFireProjectileButtonHeldDown(LeftMouseButtonDownEvent& eventArgs)
+	EventSubscription m_mouseButtonDownSubscription;
+	EventSubscription m_mouseButtonUpSubscription;
+
+	Prefab m_projectilePrefab;
+	Prefab m_playerProjectilePrefab;
+	std::vector<Entity> m_emittingEntities;
+
+	// the center of the entity's sprite, its position when it has none
+	static glm::vec2 GetProjectileSpawnPosition(const Entity& entity)
+	{
+		const auto& transform = entity.GetComponent<TransformComponent>();
+		glm::vec2 projectileSpawnPosition = transform.m_position;
+
+		if (entity.HasComponent<SpriteComponent>())
+		{
+			const auto& sprite = entity.GetComponent<SpriteComponent>();
+			projectileSpawnPosition.x += (transform.m_scale.x * sprite.m_width * .5f);
+			projectileSpawnPosition.y += (transform.m_scale.y * sprite.m_height * .5f);
+		}
+		return projectileSpawnPosition;
+	}
+
+	void StartCountingTimeFireProjectileButtonHeldDown(const LeftMouseButtonDownEvent&)
 	{
 		for (auto& entity : GetSystemEntities())
 		{
@@ -78,7 +120,7 @@ private:
 		}
 	}
 
-	void FireProjectile(LeftMouseButtonUpEvent& eventArgs)
+	void FireProjectile(const LeftMouseButtonUpEvent& eventArgs)
 	{
 		for (auto& entity : GetSystemEntities())
 		{
@@ -93,16 +135,8 @@ private:
 				{
 
 					auto& projectileEmitter = entity.GetComponent<ProjectileEmitterComponent>();
-					const auto& transform = entity.GetComponent<TransformComponent>();
-					
-					glm::vec2 projectileSpawnPosition = transform.m_position;
 					
-					if (entity.HasComponent<SpriteComponent>())
-					{
-						const auto& sprite = entity.GetComponent<SpriteComponent>();
-						projectileSpawnPosition.x += (transform.m_scale.x * sprite.m_width * .5f);
-						projectileSpawnPosition.y += (transform.m_scale.y * sprite.m_height * .5f);
-					}
+					const glm::vec2 projectileSpawnPosition = GetProjectileSpawnPosition(entity);
 					glm::vec2 projectileVelocity;
 
 					auto GetMousePosition = []() -> glm::vec2
@@ -129,26 +163,15 @@ private:
 						glm::vec2{0,0}
 						;
 
-					auto projectile = entity.m_registry->CreateEntity();
-					projectile.Group("projectiles");
-					
-					const float scaleFactorX = 0.15f;
-					const float scaleFactorY = 0.15f;
-					projectile.AddComponent<TransformComponent>(projectileSpawnPosition, glm::vec2(scaleFactorX, scaleFactorY));
+					const Entity projectile = entity.m_registry->Instantiate(m_playerProjectilePrefab).front();
+					projectile.GetComponent<TransformComponent>().m_position = projectileSpawnPosition;
 					
 					const float timeToStopInSecs = .6f;
-					projectile.AddComponent<RigidbodyComponent>(projectileVelocity, timeToStopInSecs);
-					projectile.GetComponent<RigidbodyComponent>().WasPushed();
-					
-					const int spriteWidth = 64;
-					const int spriteHeight = 64;
-					projectile.AddComponent<SpriteComponent>("bullet-image", spriteWidth, spriteHeight, 4);
-					
-					const auto colliderWidth = spriteWidth * scaleFactorX;
-					const auto colliderHeight = spriteHeight * scaleFactorY;
-					projectile.AddComponent<BoxColliderComponent>(colliderWidth, colliderHeight);
+					auto& rigidbody = projectile.GetComponent<RigidbodyComponent>();
+					rigidbody = RigidbodyComponent(projectileVelocity, timeToStopInSecs);
+					rigidbody.WasPushed();
 					
-					projectile.AddComponent<ProjectileComponent>(projectileEmitter.m_shouldCollideWithPlayer, projectileEmitter.m_damagePercentage);
+					projectile.GetComponent<ProjectileComponent>() = ProjectileComponent(projectileEmitter.m_shouldCollideWithPlayer, projectileEmitter.m_damagePercentage);
 				
 					projectileEmitter.m_lastEmissionTimeInMs = SDL_GetTicks();
 				}
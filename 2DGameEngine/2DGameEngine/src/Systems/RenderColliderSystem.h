@@ -3,6 +3,8 @@
 #include "SDL.h"
 
 #include "ECS/ECS.h"
+#include "Renderer/RenderCommandList.h"
+#include "Renderer/RectBatch.h"
 
 #include "Components/TransformComponent.h"
 #include "Components/BoxColliderComponent.h"
@@ -16,7 +18,7 @@ public:
 		RequireComponent<BoxColliderComponent>();
 	}
 
-	void Update(SDL_Renderer* renderer, const SDL_Rect& camera)
+	void Update(RenderCommandList& commandList, const SDL_Rect& camera)
 	{
 		for (auto& entity : GetSystemEntities())
 		{
@@ -28,22 +30,29 @@ public:
 				static_cast<int>(collider.m_width),
 				static_cast<int>(collider.m_height)};
 			
+			SDL_Color collisionBoxColor;
 			if (collider.m_isActive)
 			{
 				if (collider.m_isColliding)
 				{
-					SDL_SetRenderDrawColor(renderer, 0, 255, 0, 1);
+					collisionBoxColor = { 0, 255, 0, 1 };
 				}
 				else
 				{
-					SDL_SetRenderDrawColor(renderer, 0, 0, 255, 1);
+					collisionBoxColor = { 0, 0, 255, 1 };
 				}
 			}
 			else
 			{
-				SDL_SetRenderDrawColor(renderer, 255, 0, 0, 1);
+				collisionBoxColor = { 255, 0, 0, 1 };
 			}
-			SDL_RenderDrawRect(renderer, &collisionBox);
+			m_collisionBoxes.Add(collisionBox, collisionBoxColor);
 		}
+
+		// one draw call per color instead of one per collider
+		m_collisionBoxes.RecordOutlines(commandList);
 	}
+
+private:
+	RectBatch m_collisionBoxes;
 };
\ No newline at end of file
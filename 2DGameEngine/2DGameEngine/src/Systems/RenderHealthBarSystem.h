@@ -4,6 +4,8 @@
 
 #include "ECS/ECS.h"
 #include "AssetStore/AssetStore.h"
+#include "Renderer/RenderCommandList.h"
+#include "Renderer/RectBatch.h"
 
 #include "Components/TransformComponent.h"
 #include "Components/HealthComponent.h"
@@ -19,7 +21,7 @@ public:
 		RequireComponent<SpriteComponent>();
 	}
 
-	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera)
+	void Update(RenderCommandList& commandList, std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera)
 	{
 		for (auto& entity : GetSystemEntities())
 		{
@@ -35,8 +37,6 @@ public:
 			else if(currentHealth > 20) healthBarColor = { 255, 165, 0, 255 };
 			else										healthBarColor = { 180, 0, 0, 255 };
 
-			SDL_SetRenderDrawColor(renderer, healthBarColor.r, healthBarColor.g, healthBarColor.b, healthBarColor.a);
-			
 
 			const Uint16 healthBarWidth = 30;
 			const Uint16 healthBarHeight = 3;
@@ -53,35 +53,25 @@ public:
 				healthBarHeight
 			};
 
-			SDL_RenderFillRect(renderer, &healthBar);
+			m_healthBars.Add(healthBar, healthBarColor);
 
 			// health text
 			const auto healthAsString = std::to_string(health.m_currentHealthPertcentage) + "%";
-			SDL_Surface* surface = TTF_RenderText_Blended(
-				assetStore->GetFont(CONST::FONT::pico_8),
-				healthAsString.c_str(),
-				healthBarColor
-			);
-
-			SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-			SDL_FreeSurface(surface);
-
-			int labelWidth = 0;
-			int labelHeight = 0;
-			SDL_QueryTexture(texture, NULL, NULL, &labelWidth, &labelHeight);
-
 			const Uint16 healthTextYOffset = 15;
 
-			SDL_Rect dstRect;
-				dstRect = {
-					static_cast<int>(healthBarPosX),
-					static_cast<int>(healthBarPosY - healthTextYOffset),
-					labelWidth,
-					labelHeight
-				};
-
-			SDL_RenderCopy(renderer, texture, NULL, &dstRect);
-			SDL_DestroyTexture(texture);
+			commandList.AddText(
+				assetStore->GetFont(CONST::FONT::pico_8),
+				healthAsString,
+				healthBarColor,
+				static_cast<int>(healthBarPosX),
+				static_cast<int>(healthBarPosY - healthTextYOffset)
+			);
 		}
+
+		// all the bars of the same color are drawn at once
+		m_healthBars.RecordFilled(commandList);
 	}
+
+private:
+	RectBatch m_healthBars;
 };
\ No newline at end of file
@@ -6,80 +6,166 @@
 
 #include "ECS/ECS.h"
 #include "AssetStore/AssetStore.h"
+#include "SpatialGrid/SpatialGrid.h"
+#include "Renderer/RenderCommandList.h"
 
 #include "Components/TransformComponent.h"
 #include "Components/SpriteComponent.h"
+#include "Components/RigidbodyComponent.h"
+#include "Components/ScriptComponent.h"
 
 class RenderSystem : public System
 {
 public:
+	struct RenderableEntity
+	{
+		std::size_t entityId;
+		const TransformComponent* transformComponent;
+		const SpriteComponent* spriteComponent;
+	};
+
 	RenderSystem()
 	{
 		RequireComponent<TransformComponent>();
 		RequireComponent<SpriteComponent>();
 	}
 
-	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera)
+	// static entities (tiles, trees, obstacles...) are kept in a spatial grid so that only the ones
+	// near the camera are tested, everything else is tested one by one every frame
+	void AddEntity(Entity entityToAdd) override
 	{
-		// sort all the entities by their z-index
-		struct RenderableEntity
+		System::AddEntity(entityToAdd);
+
+		if (IsStatic(entityToAdd))
 		{
-			TransformComponent transformComponent;
-			SpriteComponent spriteComponent;
-		};
+			m_staticEntities.Insert(entityToAdd, CalculateWorldBounds(entityToAdd));
+		}
+		else
+		{
+			m_dynamicEntities.push_back(entityToAdd);
+		}
+	}
+
+	void RemoveEntity(Entity entityToRemove) override
+	{
+		System::RemoveEntity(entityToRemove);
+
+		if (m_staticEntities.Contains(entityToRemove))
+		{
+			m_staticEntities.Remove(entityToRemove);
+		}
+		else
+		{
+			m_dynamicEntities.erase(
+				std::remove(m_dynamicEntities.begin(), m_dynamicEntities.end(), entityToRemove),
+				m_dynamicEntities.end());
+		}
+	}
+
+	// entities that the camera sees, sorted by their z-index
+	const std::vector<RenderableEntity>& CollectVisibleEntities(const SDL_Rect& camera)
+	{
+		m_visibleEntities.clear();
+
+		m_staticEntitiesInView.clear();
+		m_staticEntities.Query(camera, m_staticEntitiesInView);
+		for (const auto& entity : m_staticEntitiesInView)
+		{
+			m_visibleEntities.push_back(RenderableEntity{
+				entity.GetId(),
+				&entity.GetComponent<TransformComponent>(),
+				&entity.GetComponent<SpriteComponent>()
+			});
+		}
 
-		std::vector<RenderableEntity> renderableEntities;
-		for (const auto& entity : GetSystemEntities())
+		for (const auto& entity : m_dynamicEntities)
 		{
-			RenderableEntity renderableEntity;
-			renderableEntity.spriteComponent = entity.GetComponent<SpriteComponent>();
-			renderableEntity.transformComponent = entity.GetComponent<TransformComponent>();
-			
+			const auto& transform = entity.GetComponent<TransformComponent>();
+			const auto& sprite = entity.GetComponent<SpriteComponent>();
+
 			// we only want to render entities that the camera sees
-			const auto& transform = renderableEntity.transformComponent;
-			const auto& sprite = renderableEntity.spriteComponent;
 			const bool isEntityOutsideCameraView =
-				transform.m_position.x + transform.m_scale.x * sprite.m_width < camera.x || 
-				transform.m_position.x > camera.x + camera.w || 
+				transform.m_position.x + transform.m_scale.x * sprite.m_width < camera.x ||
+				transform.m_position.x > camera.x + camera.w ||
 				transform.m_position.y + transform.m_scale.y * sprite.m_height < camera.y ||
 				transform.m_position.y > camera.y + camera.h;
 
 			if (isEntityOutsideCameraView && !sprite.m_isInCameraSpace) continue;
-			
-			renderableEntities.emplace_back(renderableEntity);
+
+			m_visibleEntities.push_back(RenderableEntity{ entity.GetId(), &transform, &sprite });
 		}
 
-		std::sort(renderableEntities.begin(), renderableEntities.end(),
+		// the entity id is used to keep the order of entities with the same z-index stable between frames
+		std::sort(m_visibleEntities.begin(), m_visibleEntities.end(),
 			[](const RenderableEntity& first, const RenderableEntity& second)
 			{
-				return first.spriteComponent.m_zIndex < second.spriteComponent.m_zIndex;
+				if (first.spriteComponent->m_zIndex != second.spriteComponent->m_zIndex)
+				{
+					return first.spriteComponent->m_zIndex < second.spriteComponent->m_zIndex;
+				}
+				return first.entityId < second.entityId;
 			}
 		);
 
-		for (auto entity : renderableEntities)
-		{
-			const auto transform = entity.transformComponent;
-			const auto sprite = entity.spriteComponent;
+		return m_visibleEntities;
+	}
 
-			SDL_Rect srcRect = sprite.m_textureRect;
+	void Update(RenderCommandList& commandList, std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera)
+	{
+		for (const auto& entity : CollectVisibleEntities(camera))
+		{
+			const auto& transform = *entity.transformComponent;
+			const auto& sprite = *entity.spriteComponent;
 
-			SDL_Rect dstRect = 
+			SDL_Rect dstRect =
 			{
 				static_cast<int>(transform.m_position.x - (sprite.m_isInCameraSpace ? 0 : camera.x)),
 				static_cast<int>(transform.m_position.y - (sprite.m_isInCameraSpace ? 0 : camera.y)),
 				static_cast<int>(sprite.m_width * transform.m_scale.x),
 				static_cast<int>(sprite.m_height * transform.m_scale.y)
 			};
-			
-			SDL_RenderCopyEx(
-				renderer,
+
+			commandList.AddSprite(
 				assetStore->GetTexture(sprite.m_assetId),
-				&srcRect,
-				&dstRect,
+				sprite.m_textureRect,
+				dstRect,
 				transform.m_rotation,
-				NULL,
-				sprite.m_flip
+				sprite.m_flip,
+				sprite.m_zIndex
 			);
 		}
 	}
-};
\ No newline at end of file
+
+	std::size_t GetNumberOfStaticEntities() const { return m_staticEntities.GetSize(); }
+	std::size_t GetNumberOfDynamicEntities() const { return m_dynamicEntities.size(); }
+
+private:
+	// an entity is static when nothing in the engine is able to move it after it was created
+	bool IsStatic(const Entity& entity) const
+	{
+		const auto& sprite = entity.GetComponent<SpriteComponent>();
+		return
+			!sprite.m_isInCameraSpace &&
+			!entity.HasComponent<RigidbodyComponent>() &&
+			!entity.HasComponent<ScriptComponent>();
+	}
+
+	SDL_FRect CalculateWorldBounds(const Entity& entity) const
+	{
+		const auto& transform = entity.GetComponent<TransformComponent>();
+		const auto& sprite = entity.GetComponent<SpriteComponent>();
+		return SDL_FRect{
+			transform.m_position.x,
+			transform.m_position.y,
+			transform.m_scale.x * sprite.m_width,
+			transform.m_scale.y * sprite.m_height
+		};
+	}
+
+	SpatialGrid m_staticEntities;
+	std::vector<Entity> m_dynamicEntities;
+
+	// kept between frames to avoid reallocating them every frame
+	std::vector<Entity> m_staticEntitiesInView;
+	std::vector<RenderableEntity> m_visibleEntities;
+};
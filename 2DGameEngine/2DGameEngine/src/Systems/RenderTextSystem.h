@@ -5,6 +5,7 @@
 #include "ECS/ECS.h"
 
 #include "AssetStore/AssetStore.h"
+#include "Renderer/RenderCommandList.h"
 
 #include "Components/TextLabelComponent.h"
 
@@ -16,35 +17,19 @@ public:
 		RequireComponent<TextLabelComponent>();
 	}
 
-	void Update(std::unique_ptr<AssetStore>& assetStore, SDL_Renderer* renderer, const SDL_Rect& camera)
+	void Update(std::unique_ptr<AssetStore>& assetStore, RenderCommandList& commandList, const SDL_Rect& camera)
 	{
 		for (auto& entity : GetSystemEntities())
 		{
 			const auto& textLabel = entity.GetComponent<TextLabelComponent>();
 
-			const auto font = assetStore->GetFont(textLabel.m_assetName);
-			SDL_Surface* surface = TTF_RenderText_Blended(
-				font, 
-				textLabel.m_text.c_str(),
-				textLabel.m_textColor
-			);
-		
-			SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-			SDL_FreeSurface(surface);
-			
-			int labelWidth = 0;
-			int labelHeight = 0;
-			SDL_QueryTexture(texture, NULL, NULL, &labelWidth, &labelHeight);
-
-			SDL_Rect dstRect = {
+			commandList.AddText(
+				assetStore->GetFont(textLabel.m_assetName),
+				textLabel.m_text,
+				textLabel.m_textColor,
 				static_cast<int>(textLabel.m_position.x - (textLabel.m_isInCameraSpace ? 0 : camera.x)),
-				static_cast<int>(textLabel.m_position.y - (textLabel.m_isInCameraSpace ? 0 : camera.y)),
-				labelWidth,
-				labelHeight
-			};
-
-			SDL_RenderCopy(renderer, texture, NULL, &dstRect);
-			SDL_DestroyTexture(texture);
+				static_cast<int>(textLabel.m_position.y - (textLabel.m_isInCameraSpace ? 0 : camera.y))
+			);
 		}
 	}
 };
\ No newline at end of file
@@ -1,9 +1,16 @@
 #pragma once
 
 #include <tuple>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <algorithm>
 #include <sol/sol.hpp>
 
 #include "ECS/ECS.h"
+#include "Game/ScriptSandbox.h"
 
 #include "Components/ScriptComponent.h"
 #include "Components/TransformComponent.h"
@@ -11,9 +18,17 @@
 #include "Components/ProjectileEmitterComponent.h"
 #include "Components/AnimationComponent.h"
 
+namespace CONST
+{
+	namespace SCRIPTS
+	{
+		// instructions an update script or a behaviour can run per frame before the rest of it is deferred
+		constexpr int INSTRUCTION_BUDGET = 200000;
+	}
+}
 
 //// declaration of native c++ functions that we will bind with lua functions
-std::tuple<double, double> GetEntityPosition(Entity entity)
+inline std::tuple<double, double> GetEntityPosition(Entity entity)
 {
 	if (entity.HasComponent<TransformComponent>())
 	{
@@ -27,7 +42,7 @@ std::tuple<double, double> GetEntityPosition(Entity entity)
 	}
 }
 
-std::tuple<double, double> GetEntityVelocity(Entity entity)
+inline std::tuple<double, double> GetEntityVelocity(Entity entity)
 {
 	if (entity.HasComponent<RigidbodyComponent>())
 	{
@@ -41,7 +56,7 @@ std::tuple<double, double> GetEntityVelocity(Entity entity)
 	}
 }
 
-void SetEntityPosition(Entity entity, double newX, double newY)
+inline void SetEntityPosition(Entity entity, double newX, double newY)
 {
 	if (entity.HasComponent<TransformComponent>())
 	{
@@ -55,7 +70,7 @@ void SetEntityPosition(Entity entity, double newX, double newY)
 	}
 }
 
-void SetEntityRotation(Entity entity, double newRotation)
+inline void SetEntityRotation(Entity entity, double newRotation)
 {
 	if (entity.HasComponent<TransformComponent>())
 	{
@@ -67,7 +82,7 @@ void SetEntityRotation(Entity entity, double newRotation)
 	}
 }
 
-void SetEntityVelocity(Entity entity, double velocityX, double velocityY)
+inline void SetEntityVelocity(Entity entity, double velocityX, double velocityY)
 {
 	if (entity.HasComponent<RigidbodyComponent>())
 	{
@@ -82,7 +97,7 @@ void SetEntityVelocity(Entity entity, double velocityX, double velocityY)
 	}
 }
 
-void SetProjectileVelocity(Entity entity, double velocityX, double velocityY)
+inline void SetProjectileVelocity(Entity entity, double velocityX, double velocityY)
 {
 	if (entity.HasComponent<ProjectileEmitterComponent>())
 	{
@@ -97,7 +112,7 @@ void SetProjectileVelocity(Entity entity, double velocityX, double velocityY)
 	}
 }
 
-void SetAnimationFrame(Entity entity, int frame)
+inline void SetAnimationFrame(Entity entity, int frame)
 {
 	if (entity.HasComponent<AnimationComponent>())
 	{
@@ -109,6 +124,33 @@ void SetAnimationFrame(Entity entity, int frame)
 	}
 }
 
+// nil in lua when the entity does not have the component
+template <typename TComponent>
+TComponent* GetComponentOrNull(const Entity& entity)
+{
+	return entity.HasComponent<TComponent>() ? &entity.GetComponent<TComponent>() : nullptr;
+}
+
+// Entities can have an update script called once per entity and/or a batch script. Entities sharing the
+// same batch script are updated by a single call receiving the table below, the script changes the arrays
+// in place and the values are written back to the components after the call:
+//   batch.count, batch.id[i], batch.position_x[i], batch.position_y[i], batch.rotation[i],
+//   batch.velocity_x[i], batch.velocity_y[i]   (i from 1 to count)
+// Entities without a transform or a rigidbody get zeros and those values are not written back.
+//
+// A behaviour is a function run as a coroutine, it receives the entity once and can give the control back with
+//   wait(seconds)            resumed once the time has passed
+//   wait_until(function)     resumed once the function returns true, it is called every frame until then. It is called
+//                            on the main Lua state and not within the instruction budget, it should only test a value
+//   coroutine.yield()        resumed next frame
+// Waiting behaviours are not resumed at all, the timed ones wait in a queue sorted by wake time.
+// The components must be read from the entity again after a wait, adding components may have moved them.
+//
+// Sandboxed scripts (see SetSandboxed()) get an environment per entity, per batch script for the batch scripts: the
+// globals they write are their own. With an instruction budget (see SetInstructionBudget()) the update scripts and
+// the behaviours run on threads with a count hook, a script going over the budget is suspended and resumed where it
+// stopped the next frame, so a runaway script cannot stall the frame. The batch scripts and the wait_until conditions
+// have no budget
 class ScriptSystem : public System
 {
 public:
@@ -117,26 +159,189 @@ public:
 		RequireComponent<ScriptComponent>();
 	}
 
+	void AddEntity(Entity entityToAdd) override
+	{
+		System::AddEntity(entityToAdd);
+		m_areBatchesOutdated = true;
+
+		auto& script = entityToAdd.GetComponent<ScriptComponent>();
+		if (m_areScriptsSandboxed)
+		{
+			Sandbox(script);
+		}
+
+		if (script.m_behaviourFunction.valid())
+		{
+			StartBehaviour(entityToAdd, script.m_behaviourFunction);
+		}
+	}
+
+	void RemoveEntity(Entity entityToRemove) override
+	{
+		System::RemoveEntity(entityToRemove);
+		m_areBatchesOutdated = true;
+		// its waits are skipped when they come up
+		m_behaviours.erase(entityToRemove.GetId());
+		m_budgetedScripts.erase(entityToRemove.GetId());
+		m_entitiesOverBudget.erase(entityToRemove.GetId());
+	}
+
 	void Update(double deltaTime, int ellapsedTime)
 	{
-		for (auto& entity : GetSystemEntities())
+		if (m_areBatchesOutdated)
+		{
+			RebuildBatches();
+		}
+
+		for (auto& entity : m_entitiesWithUpdateScript)
+		{
+			const auto& scriptFunction = entity.GetComponent<ScriptComponent>().m_scriptFunction;
+			if (m_instructionBudget > 0)
+			{
+				CallWithinBudget(entity, scriptFunction, deltaTime, ellapsedTime);
+			}
+			else
+			{
+				scriptFunction(entity, deltaTime, ellapsedTime);
+			}
+		}
+
+		for (auto& batch : m_batches)
+		{
+			UpdateBatch(batch, deltaTime, ellapsedTime);
+		}
+
+		UpdateBehaviours(deltaTime);
+	}
+
+	std::size_t GetNumberOfBatches() const { return m_batches.size(); }
+	std::size_t GetNumberOfBehaviours() const { return m_behaviours.size(); }
+
+	// applies to the entities added afterwards
+	void SetSandboxed(bool areScriptsSandboxed) { m_areScriptsSandboxed = areScriptsSandboxed; }
+
+	// 0 removes the budget. The hook is checked at every instruction, the Level2 update scripts run about 1.5x slower with it
+	void SetInstructionBudget(int instructionBudget)
+	{
+		m_instructionBudget = instructionBudget;
+		if (m_instructionBudget <= 0)
+		{
+			for (auto& behaviour : m_behaviours)
+			{
+				ScriptSandbox::RemoveInstructionBudget(behaviour.second.m_thread.state());
+			}
+			m_budgetedScripts.clear();
+		}
+	}
+
+	// which functions of the script given to ReplaceScript() replace the entity's ones
+	struct ReplacedFunctions
+	{
+		bool m_isScriptReplaced = false;
+		bool m_isBatchScriptReplaced = false;
+		bool m_isBehaviourReplaced = false;
+	};
+
+	// the functions of the entity's script are replaced in place (a level script reloaded while the game runs), the
+	// others keep running as they are. The batches are rebuilt next update, a suspended call of the old update script
+	// is dropped and a replaced behaviour starts over with the new function
+	void ReplaceScript(Entity entity, const ScriptComponent& script, const ReplacedFunctions& replacedFunctions)
+	{
+		auto& entityScript = entity.GetComponent<ScriptComponent>();
+		ScriptComponent newScript(
+			replacedFunctions.m_isScriptReplaced ? script.m_scriptFunction : sol::lua_nil,
+			replacedFunctions.m_isBatchScriptReplaced ? script.m_batchScriptFunction : sol::lua_nil,
+			replacedFunctions.m_isBehaviourReplaced ? script.m_behaviourFunction : sol::lua_nil);
+		if (m_areScriptsSandboxed)
+		{
+			// the new functions share the environment of the ones kept
+			sol::table environment;
+			if (!replacedFunctions.m_isScriptReplaced && entityScript.m_scriptFunction.valid())
+			{
+				environment = ScriptSandbox::GetEnvironment(entityScript.m_scriptFunction);
+			}
+			if (!environment.valid() && !replacedFunctions.m_isBehaviourReplaced && entityScript.m_behaviourFunction.valid())
+			{
+				environment = ScriptSandbox::GetEnvironment(entityScript.m_behaviourFunction);
+			}
+			Sandbox(newScript, environment);
+		}
+
+		if (replacedFunctions.m_isScriptReplaced)
+		{
+			entityScript.m_scriptFunction = newScript.m_scriptFunction;
+			m_budgetedScripts.erase(entity.GetId());
+		}
+		if (replacedFunctions.m_isBatchScriptReplaced)
+		{
+			entityScript.m_batchScriptFunction = newScript.m_batchScriptFunction;
+		}
+		if (replacedFunctions.m_isScriptReplaced || replacedFunctions.m_isBatchScriptReplaced)
+		{
+			m_areBatchesOutdated = true;
+		}
+
+		if (replacedFunctions.m_isBehaviourReplaced)
 		{
-			const auto script = entity.GetComponent<ScriptComponent>();
-			script.m_scriptFunction(entity, deltaTime, ellapsedTime);
+			entityScript.m_behaviourFunction = newScript.m_behaviourFunction;
+			m_behaviours.erase(entity.GetId());
+			if (entityScript.m_behaviourFunction.valid())
+			{
+				StartBehaviour(entity, entityScript.m_behaviourFunction);
+			}
 		}
 	}
 
+	// the update scripts that went over the budget and are finished next frame
+	std::size_t GetNumberOfDeferredScripts() const
+	{
+		return std::count_if(m_budgetedScripts.begin(), m_budgetedScripts.end(), [](const auto& script) { return script.second.m_isSuspended; });
+	}
+
 	void CreateLuaFunctionBindings(sol::state& lua)
 	{
+		// components are bound by reference, 'entity.transform.position.x = 10' writes the entity's own component
+		// without copies. The references are only valid during the script call, adding components may move them
+		lua.new_usertype<glm::vec2>(
+			"vec2", sol::no_constructor,
+			"x", &glm::vec2::x,
+			"y", &glm::vec2::y
+		);
+		lua.new_usertype<TransformComponent>(
+			"transform_component", sol::no_constructor,
+			"position", &TransformComponent::m_position,
+			"scale", &TransformComponent::m_scale,
+			"rotation", &TransformComponent::m_rotation
+		);
+		lua.new_usertype<RigidbodyComponent>(
+			"rigidbody_component", sol::no_constructor,
+			"velocity", &RigidbodyComponent::m_velocity
+		);
+		lua.new_usertype<ProjectileEmitterComponent>(
+			"projectile_emitter_component", sol::no_constructor,
+			"velocity", &ProjectileEmitterComponent::m_velocity
+		);
+		lua.new_usertype<AnimationComponent>(
+			"animation_component", sol::no_constructor,
+			"num_frames", sol::readonly(&AnimationComponent::m_numFrames),
+			"current_frame", &AnimationComponent::m_currentFrame
+		);
+
 		// create entity usertype so that Lua knows what an entity is
 		lua.new_usertype<Entity>(
 			"entity",
 			"get_id", &Entity::GetId,
 			"destroy", &Entity::Destroy,
 			"has_tag", &Entity::HasTag,
-			"belongs_to_group", &Entity::BelongsToGroup
+			"belongs_to_group", &Entity::BelongsToGroup,
+			"transform", sol::property(&GetComponentOrNull<TransformComponent>),
+			"rigidbody", sol::property(&GetComponentOrNull<RigidbodyComponent>),
+			"projectile_emitter", sol::property(&GetComponentOrNull<ProjectileEmitterComponent>),
+			"animation", sol::property(&GetComponentOrNull<AnimationComponent>)
 		);
 		
+		// the functions below predate the component bindings. Each usertype field access goes through sol2's lookup,
+		// these are faster for scripts called every frame and the shipped levels use them
 		// transform
 		lua.set_function("get_position", GetEntityPosition);
 		lua.set_function("set_position", SetEntityPosition);		
@@ -151,5 +356,418 @@ public:
 		
 		// sprite renderer
 		lua.set_function("set_animation_frame", SetAnimationFrame);
+
+		// behaviours, the yielded value tells UpdateBehaviours() when to resume them
+		lua.set_function("wait", sol::yielding([](double seconds) { return seconds; }));
+		lua.set_function("wait_until", sol::yielding([](sol::function condition) { return condition; }));
 	}
+
+private:
+	struct ScriptBatch
+	{
+		// the function of the components, the batch is found with it
+		sol::function m_batchScriptFunction;
+		// the function called, its sandboxed copy when the scripts are sandboxed
+		sol::function m_calledFunction;
+		std::vector<Entity> m_entities;
+
+		// created once and reused every frame
+		sol::table m_batchTable;
+		sol::table m_ids;
+		sol::table m_positionsX;
+		sol::table m_positionsY;
+		sol::table m_rotations;
+		sol::table m_velocitiesX;
+		sol::table m_velocitiesY;
+	};
+
+	struct Behaviour
+	{
+		Behaviour(Entity entity) : m_entity(entity) {}
+
+		Entity m_entity;
+		sol::thread m_thread;
+		sol::coroutine m_coroutine;
+		bool m_hasStarted = false;
+		// the wait the behaviour is in, the older waits still queued for this entity are skipped
+		std::size_t m_waitId = 0;
+		sol::protected_function m_wakeCondition;
+	};
+
+	struct BehaviourWait
+	{
+		double m_wakeTime;
+		std::size_t m_entityId;
+		std::size_t m_waitId;
+
+		bool operator>(const BehaviourWait& other) const { return m_wakeTime > other.m_wakeTime; }
+	};
+
+	// an update script run on a thread of its own to be suspended by the budget
+	struct BudgetedScript
+	{
+		sol::thread m_thread;
+		bool m_isSuspended = false;
+	};
+
+	// one environment for the functions of the entity, a new one unless 'environment' is valid
+	void Sandbox(ScriptComponent& script, sol::table environment = sol::table())
+	{
+		const sol::function& anyFunction = script.m_scriptFunction.valid() ? script.m_scriptFunction : script.m_behaviourFunction;
+		if (!anyFunction.valid())
+		{
+			return;
+		}
+
+		if (!environment.valid())
+		{
+			environment = ScriptSandbox::CreateEnvironment(anyFunction.lua_state());
+		}
+		if (script.m_scriptFunction.valid())
+		{
+			script.m_scriptFunction = ScriptSandbox::Isolate(script.m_scriptFunction, environment);
+		}
+		if (script.m_behaviourFunction.valid())
+		{
+			script.m_behaviourFunction = ScriptSandbox::Isolate(script.m_behaviourFunction, environment);
+		}
+	}
+
+	void CallWithinBudget(Entity entity, const sol::function& scriptFunction, double deltaTime, int ellapsedTime)
+	{
+		auto foundScript = m_budgetedScripts.find(entity.GetId());
+		if (foundScript == m_budgetedScripts.end())
+		{
+			BudgetedScript newScript;
+			newScript.m_thread = sol::thread::create(scriptFunction.lua_state());
+			foundScript = m_budgetedScripts.emplace(entity.GetId(), std::move(newScript)).first;
+		}
+		BudgetedScript& script = foundScript->second;
+
+		lua_State* thread = script.m_thread.state();
+		ScriptSandbox::SetInstructionBudget(thread, m_instructionBudget);
+
+		// resumed with the raw lua api, sol::coroutine costs as much as a short script. A suspended call is finished
+		// before the next one starts, it keeps the delta time it was called with
+		int numberOfArguments = 0;
+		if (!script.m_isSuspended)
+		{
+			scriptFunction.push(thread);
+			numberOfArguments = sol::stack::multi_push(thread, entity, deltaTime, ellapsedTime);
+		}
+		const int status = lua_resume(thread, nullptr, numberOfArguments);
+
+		if (status != LUA_OK && status != LUA_YIELD)
+		{
+			// the thread cannot be resumed after an error, the next call gets a new one. error() takes any value
+			const char* errorMessage = lua_tostring(thread, -1);
+			Logger::Error("update script of entity " + std::to_string(entity.GetId()) + " failed: " + (errorMessage ? errorMessage : "(error object is not a string)"));
+			m_budgetedScripts.erase(foundScript);
+			return;
+		}
+		lua_settop(thread, 0);
+
+		script.m_isSuspended = status == LUA_YIELD;
+		if (script.m_isSuspended && !ScriptSandbox::HasSpentInstructionBudget(thread))
+		{
+			Logger::Error("update script of entity " + std::to_string(entity.GetId()) + " yielded, only behaviours can wait");
+			m_budgetedScripts.erase(foundScript);
+			return;
+		}
+		if (script.m_isSuspended)
+		{
+			ReportOverBudget(entity.GetId(), "update script");
+		}
+	}
+
+	// once per entity, a runaway script would fill the log every frame
+	void ReportOverBudget(std::size_t entityId, const std::string& scriptType)
+	{
+		if (m_entitiesOverBudget.insert(entityId).second)
+		{
+			Logger::Error(scriptType + " of entity " + std::to_string(entityId) + " went over its budget of "
+				+ std::to_string(m_instructionBudget) + " instructions, the rest of it is run next frame");
+		}
+	}
+
+	// groups the entities by batch script, batches keep their tables when their script is still used.
+	// The entities with a per entity update script are listed too, the others are not visited every frame
+	void RebuildBatches()
+	{
+		for (auto& batch : m_batches)
+		{
+			batch.m_entities.clear();
+		}
+		m_entitiesWithUpdateScript.clear();
+
+		for (auto& entity : GetSystemEntities())
+		{
+			const auto& script = entity.GetComponent<ScriptComponent>();
+			if (script.m_scriptFunction.valid())
+			{
+				m_entitiesWithUpdateScript.push_back(entity);
+			}
+
+			const auto& batchScriptFunction = script.m_batchScriptFunction;
+			if (!batchScriptFunction.valid()) continue;
+
+			// two references to the same lua function point to the same object
+			auto batch = std::find_if(m_batches.begin(), m_batches.end(), [&batchScriptFunction](const ScriptBatch& existingBatch)
+			{
+				return existingBatch.m_batchScriptFunction.pointer() == batchScriptFunction.pointer();
+			});
+
+			if (batch == m_batches.end())
+			{
+				m_batches.push_back(CreateBatch(batchScriptFunction));
+				if (m_areScriptsSandboxed)
+				{
+					m_batches.back().m_calledFunction = ScriptSandbox::Isolate(batchScriptFunction, ScriptSandbox::CreateEnvironment(batchScriptFunction.lua_state()));
+				}
+				batch = m_batches.end() - 1;
+			}
+			batch->m_entities.push_back(entity);
+		}
+
+		m_batches.erase(
+			std::remove_if(m_batches.begin(), m_batches.end(), [](const ScriptBatch& batch) { return batch.m_entities.empty(); }),
+			m_batches.end());
+		m_areBatchesOutdated = false;
+	}
+
+	ScriptBatch CreateBatch(const sol::function& batchScriptFunction)
+	{
+		sol::state_view lua(batchScriptFunction.lua_state());
+
+		ScriptBatch batch;
+		batch.m_batchScriptFunction = batchScriptFunction;
+		batch.m_calledFunction = batchScriptFunction;
+		batch.m_batchTable = lua.create_table();
+		batch.m_ids = lua.create_table();
+		batch.m_positionsX = lua.create_table();
+		batch.m_positionsY = lua.create_table();
+		batch.m_rotations = lua.create_table();
+		batch.m_velocitiesX = lua.create_table();
+		batch.m_velocitiesY = lua.create_table();
+
+		batch.m_batchTable["id"] = batch.m_ids;
+		batch.m_batchTable["position_x"] = batch.m_positionsX;
+		batch.m_batchTable["position_y"] = batch.m_positionsY;
+		batch.m_batchTable["rotation"] = batch.m_rotations;
+		batch.m_batchTable["velocity_x"] = batch.m_velocitiesX;
+		batch.m_batchTable["velocity_y"] = batch.m_velocitiesY;
+		return batch;
+	}
+
+	void UpdateBatch(ScriptBatch& batch, double deltaTime, int ellapsedTime)
+	{
+		lua_State* luaState = batch.m_batchTable.lua_state();
+		const int numberOfEntities = static_cast<int>(batch.m_entities.size());
+		batch.m_batchTable["count"] = numberOfEntities;
+
+		// the arrays are filled with the raw lua api, going through sol for every value would cost more than the call it saves
+		const int stackTop = lua_gettop(luaState);
+		PushBatchArrays(batch);
+		for (int i = 0; i < numberOfEntities; i++)
+		{
+			const Entity& entity = batch.m_entities[i];
+			const bool hasTransform = entity.HasComponent<TransformComponent>();
+			const bool hasRigidbody = entity.HasComponent<RigidbodyComponent>();
+			const TransformComponent* transform = hasTransform ? &entity.GetComponent<TransformComponent>() : nullptr;
+			const RigidbodyComponent* rigidbody = hasRigidbody ? &entity.GetComponent<RigidbodyComponent>() : nullptr;
+
+			SetArrayValue(luaState, stackTop + 1, i + 1, static_cast<double>(entity.GetId()));
+			SetArrayValue(luaState, stackTop + 2, i + 1, hasTransform ? transform->m_position.x : 0.);
+			SetArrayValue(luaState, stackTop + 3, i + 1, hasTransform ? transform->m_position.y : 0.);
+			SetArrayValue(luaState, stackTop + 4, i + 1, hasTransform ? transform->m_rotation : 0.);
+			SetArrayValue(luaState, stackTop + 5, i + 1, hasRigidbody ? rigidbody->m_velocity.x : 0.);
+			SetArrayValue(luaState, stackTop + 6, i + 1, hasRigidbody ? rigidbody->m_velocity.y : 0.);
+		}
+		lua_settop(luaState, stackTop);
+
+		batch.m_calledFunction(batch.m_batchTable, deltaTime, ellapsedTime);
+
+		PushBatchArrays(batch);
+		for (int i = 0; i < numberOfEntities; i++)
+		{
+			const Entity& entity = batch.m_entities[i];
+			if (entity.HasComponent<TransformComponent>())
+			{
+				auto& transform = entity.GetComponent<TransformComponent>();
+				transform.m_position.x = static_cast<float>(GetArrayValue(luaState, stackTop + 2, i + 1));
+				transform.m_position.y = static_cast<float>(GetArrayValue(luaState, stackTop + 3, i + 1));
+				transform.m_rotation = GetArrayValue(luaState, stackTop + 4, i + 1);
+			}
+			if (entity.HasComponent<RigidbodyComponent>())
+			{
+				auto& rigidbody = entity.GetComponent<RigidbodyComponent>();
+				rigidbody.m_velocity.x = static_cast<float>(GetArrayValue(luaState, stackTop + 5, i + 1));
+				rigidbody.m_velocity.y = static_cast<float>(GetArrayValue(luaState, stackTop + 6, i + 1));
+			}
+		}
+		lua_settop(luaState, stackTop);
+	}
+
+	// in the order UpdateBatch() indexes them
+	static void PushBatchArrays(ScriptBatch& batch)
+	{
+		batch.m_ids.push();
+		batch.m_positionsX.push();
+		batch.m_positionsY.push();
+		batch.m_rotations.push();
+		batch.m_velocitiesX.push();
+		batch.m_velocitiesY.push();
+	}
+
+	static void SetArrayValue(lua_State* luaState, int arrayStackIndex, int index, double value)
+	{
+		lua_pushnumber(luaState, value);
+		lua_rawseti(luaState, arrayStackIndex, index);
+	}
+
+	static double GetArrayValue(lua_State* luaState, int arrayStackIndex, int index)
+	{
+		lua_rawgeti(luaState, arrayStackIndex, index);
+		const double value = lua_tonumber(luaState, -1);
+		lua_pop(luaState, 1);
+		return value;
+	}
+
+	// the behaviour runs on a thread of its own, it is resumed for the first time next frame
+	void StartBehaviour(Entity entity, const sol::function& behaviourFunction)
+	{
+		Behaviour behaviour(entity);
+		behaviour.m_thread = sol::thread::create(behaviourFunction.lua_state());
+		behaviour.m_coroutine = sol::coroutine(behaviour.m_thread.state(), behaviourFunction);
+		behaviour.m_waitId = m_nextWaitId++;
+
+		m_timedWaits.push(BehaviourWait{ m_time, entity.GetId(), behaviour.m_waitId });
+		m_behaviours.insert_or_assign(entity.GetId(), std::move(behaviour));
+	}
+
+	void UpdateBehaviours(double deltaTime)
+	{
+		m_time += deltaTime;
+
+		// collected before being resumed, a behaviour waiting again is not resumed twice in the same frame
+		m_behavioursToResume.clear();
+		while (!m_timedWaits.empty() && m_timedWaits.top().m_wakeTime <= m_time)
+		{
+			const BehaviourWait wait = m_timedWaits.top();
+			m_timedWaits.pop();
+			if (IsWaiting(wait))
+			{
+				m_behavioursToResume.push_back(wait.m_entityId);
+			}
+		}
+
+		m_conditionWaits.erase(
+			std::remove_if(m_conditionWaits.begin(), m_conditionWaits.end(), [this](const BehaviourWait& wait)
+			{
+				if (!IsWaiting(wait))
+				{
+					return true;
+				}
+
+				const sol::protected_function_result isConditionMet = m_behaviours.at(wait.m_entityId).m_wakeCondition();
+				if (!isConditionMet.valid())
+				{
+					const sol::error error = isConditionMet;
+					Logger::Error("behaviour of entity " + std::to_string(wait.m_entityId) + " stopped, its wait_until condition failed: " + error.what());
+					m_behaviours.erase(wait.m_entityId);
+					return true;
+				}
+				if (isConditionMet.get<bool>())
+				{
+					m_behavioursToResume.push_back(wait.m_entityId);
+					return true;
+				}
+				return false;
+			}),
+			m_conditionWaits.end());
+
+		for (const std::size_t entityId : m_behavioursToResume)
+		{
+			ResumeBehaviour(entityId);
+		}
+	}
+
+	bool IsWaiting(const BehaviourWait& wait) const
+	{
+		const auto behaviour = m_behaviours.find(wait.m_entityId);
+		return behaviour != m_behaviours.end() && behaviour->second.m_waitId == wait.m_waitId;
+	}
+
+	void ResumeBehaviour(std::size_t entityId)
+	{
+		const auto foundBehaviour = m_behaviours.find(entityId);
+		if (foundBehaviour == m_behaviours.end())
+		{
+			return;
+		}
+		Behaviour& behaviour = foundBehaviour->second;
+
+		if (m_instructionBudget > 0)
+		{
+			ScriptSandbox::SetInstructionBudget(behaviour.m_thread.state(), m_instructionBudget);
+		}
+
+		// the entity is the argument of the behaviour function, it is only passed when starting it
+		const sol::protected_function_result result = behaviour.m_hasStarted ? behaviour.m_coroutine() : behaviour.m_coroutine(behaviour.m_entity);
+		behaviour.m_hasStarted = true;
+
+		if (!result.valid())
+		{
+			const sol::error error = result;
+			Logger::Error("behaviour of entity " + std::to_string(entityId) + " stopped: " + error.what());
+			m_behaviours.erase(foundBehaviour);
+			return;
+		}
+		if (result.status() != sol::call_status::yielded)
+		{
+			// the function returned, the behaviour is over
+			m_behaviours.erase(foundBehaviour);
+			return;
+		}
+
+		// a behaviour stopped by its budget yields nothing, it is resumed next frame like after coroutine.yield()
+		if (m_instructionBudget > 0 && ScriptSandbox::HasSpentInstructionBudget(behaviour.m_thread.state()))
+		{
+			ReportOverBudget(entityId, "behaviour");
+		}
+
+		behaviour.m_waitId = m_nextWaitId++;
+		const sol::object waitFor = result.return_count() > 0 ? result.get<sol::object>() : sol::object(sol::lua_nil);
+		if (waitFor.is<sol::function>())
+		{
+			// the result belongs to the behaviour's thread, which stays suspended while the condition is called:
+			// the condition is referenced again from the state that created the thread and called there
+			behaviour.m_wakeCondition = sol::protected_function(behaviour.m_thread.lua_state(), waitFor);
+			m_conditionWaits.push_back(BehaviourWait{ 0., entityId, behaviour.m_waitId });
+		}
+		else
+		{
+			const double seconds = waitFor.is<double>() ? waitFor.as<double>() : 0.;
+			m_timedWaits.push(BehaviourWait{ m_time + seconds, entityId, behaviour.m_waitId });
+		}
+	}
+
+	std::vector<ScriptBatch> m_batches;
+	std::vector<Entity> m_entitiesWithUpdateScript;
+	bool m_areBatchesOutdated = false;
+
+	// behaviours by entity id
+	std::unordered_map<std::size_t, Behaviour> m_behaviours;
+	std::priority_queue<BehaviourWait, std::vector<BehaviourWait>, std::greater<BehaviourWait>> m_timedWaits;
+	std::vector<BehaviourWait> m_conditionWaits;
+	std::vector<std::size_t> m_behavioursToResume;
+	std::size_t m_nextWaitId = 0;
+	// seconds since the system was created, what the timed waits are compared with
+	double m_time = 0.;
+
+	bool m_areScriptsSandboxed = false;
+	int m_instructionBudget = 0;
+	// update scripts by entity id, only used with a budget
+	std::unordered_map<std::size_t, BudgetedScript> m_budgetedScripts;
+	std::unordered_set<std::size_t> m_entitiesOverBudget;
 };
\ No newline at end of file
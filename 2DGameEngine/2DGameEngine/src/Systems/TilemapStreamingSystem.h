@@ -0,0 +1,31 @@
+#pragma once
+
+#include <SDL.h>
+
+#include "ECS/ECS.h"
+
+#include "Components/TilemapComponent.h"
+
+// Creates the tiles around the camera and destroys the ones it left behind, see Tilemap::Stream().
+// Runs after the camera moved: the tiles it creates are drawn from the next frame on, the load radius keeps them
+// ahead of the camera
+class TilemapStreamingSystem : public System
+{
+public:
+	TilemapStreamingSystem()
+	{
+		RequireComponent<TilemapComponent>();
+	}
+
+	void Update(std::unique_ptr<Registry>& registry, const SDL_Rect& camera)
+	{
+		for (auto& entity : GetSystemEntities())
+		{
+			const auto& tilemap = entity.GetComponent<TilemapComponent>().m_tilemap;
+			if (tilemap)
+			{
+				tilemap->Stream(*registry, camera);
+			}
+		}
+	}
+};
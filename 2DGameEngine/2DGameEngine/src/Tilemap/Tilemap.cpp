@@ -0,0 +1,238 @@
+#include "pch.h"
+
+#include "Tilemap.h"
+
+#include <cmath>
+
+#include "Logger/Logger.h"
+#include "HelperFunctions.h"
+#include "AssetStore/AssetArchive.h"
+#include "Components/TransformComponent.h"
+#include "Components/SpriteComponent.h"
+
+namespace
+{
+	bool IsDigit(char character)
+	{
+		return static_cast<unsigned char>(character - '0') < 10;
+	}
+
+	bool IsEndOfLine(char character)
+	{
+		return character == '\n' || character == '\r';
+	}
+
+	void SkipSeparators(const char*& cursor, const char* end)
+	{
+		while (cursor < end && (*cursor == ',' || *cursor == ' ' || *cursor == '\t'))
+		{
+			cursor++;
+		}
+	}
+}
+
+Tilemap::Tilemap(const std::string& textureAssetId, int tileSize, double tileScale, int chunkSize)
+	: m_textureAssetId(textureAssetId)
+	, m_tileSize(tileSize)
+	, m_tileScale(tileScale)
+	, m_chunkSize(chunkSize > 0 ? chunkSize : CONST::TILEMAP::CHUNK_SIZE)
+{
+}
+
+bool Tilemap::Load(const std::string& mapPath, int numberOfColumns, int numberOfRows, const AssetArchive* archive)
+{
+	std::string error;
+	const AssetArchive::Blob packedMap = archive ? archive->Find(mapPath) : AssetArchive::Blob();
+	if (packedMap.m_data)
+	{
+		if (Parse(reinterpret_cast<const char*>(packedMap.m_data), packedMap.m_size, numberOfColumns, numberOfRows, error))
+		{
+			return true;
+		}
+		Logger::Error("Tilemap: " + mapPath + ": " + error);
+		return false;
+	}
+
+	std::string data;
+	if (!Helpers::ReadFile(mapPath, data))
+	{
+		Logger::Error("Tilemap: could not open " + mapPath);
+		return false;
+	}
+
+	if (!Parse(data.data(), data.size(), numberOfColumns, numberOfRows, error))
+	{
+		Logger::Error("Tilemap: " + mapPath + ": " + error);
+		return false;
+	}
+	return true;
+}
+
+bool Tilemap::Parse(const char* data, std::size_t size, int numberOfColumns, int numberOfRows, std::string& error)
+{
+	UnloadAllChunks();
+	m_numberOfColumns = std::max(numberOfColumns, 0);
+	m_numberOfRows = std::max(numberOfRows, 0);
+	m_numberOfChunkColumns = (m_numberOfColumns + m_chunkSize - 1) / m_chunkSize;
+	m_numberOfChunkRows = (m_numberOfRows + m_chunkSize - 1) / m_chunkSize;
+	m_tiles.assign(static_cast<std::size_t>(m_numberOfColumns) * m_numberOfRows, 0);
+
+	const char* cursor = data;
+	const char* end = data + size;
+	std::uint16_t* tile = m_tiles.data();
+	for (int row = 0; row < m_numberOfRows; row++)
+	{
+		for (int column = 0; column < m_numberOfColumns; column++)
+		{
+			SkipSeparators(cursor, end);
+			if (cursor == end || !IsDigit(*cursor))
+			{
+				error = "row " + std::to_string(row + 1) + " has " + std::to_string(column) + " tiles instead of " + std::to_string(m_numberOfColumns);
+				return false;
+			}
+
+			unsigned int value = 0;
+			while (cursor < end && IsDigit(*cursor) && value <= UINT16_MAX)
+			{
+				value = value * 10 + static_cast<unsigned int>(*cursor++ - '0');
+			}
+			if (value > UINT16_MAX)
+			{
+				error = "row " + std::to_string(row + 1) + " has a tile out of range";
+				return false;
+			}
+			*tile++ = static_cast<std::uint16_t>(value);
+		}
+
+		SkipSeparators(cursor, end);
+		if (cursor < end && !IsEndOfLine(*cursor))
+		{
+			error = "row " + std::to_string(row + 1) + " has more than " + std::to_string(m_numberOfColumns) + " tiles";
+			return false;
+		}
+		// "\n" or "\r\n"
+		cursor += cursor < end && *cursor == '\r' ? 1 : 0;
+		cursor += cursor < end && *cursor == '\n' ? 1 : 0;
+	}
+	return true;
+}
+
+void Tilemap::SetStreamingRadius(int loadRadius, int unloadRadius)
+{
+	m_loadRadius = std::max(loadRadius, 0);
+	m_unloadRadius = std::max(unloadRadius, m_loadRadius);
+}
+
+void Tilemap::Stream(Registry& registry, const SDL_Rect& camera)
+{
+	const double chunkPixelSize = m_chunkSize * m_tileSize * m_tileScale;
+	if (m_tiles.empty() || chunkPixelSize <= 0)
+	{
+		return;
+	}
+
+	// the chunks the camera sees
+	const int firstVisibleX = static_cast<int>(std::floor(camera.x / chunkPixelSize));
+	const int firstVisibleY = static_cast<int>(std::floor(camera.y / chunkPixelSize));
+	const int lastVisibleX = static_cast<int>(std::floor((camera.x + std::max(camera.w, 1) - 1) / chunkPixelSize));
+	const int lastVisibleY = static_cast<int>(std::floor((camera.y + std::max(camera.h, 1) - 1) / chunkPixelSize));
+
+	for (auto chunk = m_loadedChunks.begin(); chunk != m_loadedChunks.end();)
+	{
+		const int chunkX = chunk->first % m_numberOfChunkColumns;
+		const int chunkY = chunk->first / m_numberOfChunkColumns;
+		const bool isOutsideUnloadRadius = chunkX < firstVisibleX - m_unloadRadius || chunkX > lastVisibleX + m_unloadRadius
+			|| chunkY < firstVisibleY - m_unloadRadius || chunkY > lastVisibleY + m_unloadRadius;
+		if (!isOutsideUnloadRadius)
+		{
+			++chunk;
+			continue;
+		}
+		for (auto& tile : chunk->second)
+		{
+			tile.Destroy();
+		}
+		chunk = m_loadedChunks.erase(chunk);
+	}
+
+	const int lastChunkX = std::min(lastVisibleX + m_loadRadius, m_numberOfChunkColumns - 1);
+	const int lastChunkY = std::min(lastVisibleY + m_loadRadius, m_numberOfChunkRows - 1);
+	for (int chunkY = std::max(firstVisibleY - m_loadRadius, 0); chunkY <= lastChunkY; chunkY++)
+	{
+		for (int chunkX = std::max(firstVisibleX - m_loadRadius, 0); chunkX <= lastChunkX; chunkX++)
+		{
+			if (m_loadedChunks.find(CalculateChunkKey(chunkX, chunkY)) == m_loadedChunks.end())
+			{
+				LoadChunk(registry, chunkX, chunkY);
+			}
+		}
+	}
+}
+
+void Tilemap::LoadAllChunks(Registry& registry)
+{
+	for (int chunkY = 0; chunkY < m_numberOfChunkRows; chunkY++)
+	{
+		for (int chunkX = 0; chunkX < m_numberOfChunkColumns; chunkX++)
+		{
+			if (m_loadedChunks.find(CalculateChunkKey(chunkX, chunkY)) == m_loadedChunks.end())
+			{
+				LoadChunk(registry, chunkX, chunkY);
+			}
+		}
+	}
+}
+
+void Tilemap::UnloadAllChunks()
+{
+	for (auto& chunk : m_loadedChunks)
+	{
+		for (auto& tile : chunk.second)
+		{
+			tile.Destroy();
+		}
+	}
+	m_loadedChunks.clear();
+}
+
+int Tilemap::GetWidth() const
+{
+	return static_cast<int>(m_tileSize * m_tileScale * m_numberOfColumns);
+}
+
+int Tilemap::GetHeight() const
+{
+	return static_cast<int>(m_tileSize * m_tileScale * m_numberOfRows);
+}
+
+std::size_t Tilemap::GetNumberOfLoadedTiles() const
+{
+	std::size_t numberOfTiles = 0;
+	for (const auto& chunk : m_loadedChunks)
+	{
+		numberOfTiles += chunk.second.size();
+	}
+	return numberOfTiles;
+}
+
+void Tilemap::LoadChunk(Registry& registry, int chunkX, int chunkY)
+{
+	std::vector<Entity>& tiles = m_loadedChunks[CalculateChunkKey(chunkX, chunkY)];
+
+	const int lastColumn = std::min((chunkX + 1) * m_chunkSize, m_numberOfColumns);
+	const int lastRow = std::min((chunkY + 1) * m_chunkSize, m_numberOfRows);
+	for (int y = chunkY * m_chunkSize; y < lastRow; y++)
+	{
+		for (int x = chunkX * m_chunkSize; x < lastColumn; x++)
+		{
+			const int tile = GetTile(x, y);
+			const int tilesetXIndex = (tile % 10) * m_tileSize;
+			const int tilesetYIndex = (tile / 10) * m_tileSize;
+
+			Entity tileEntity = registry.CreateEntity();
+			tileEntity.AddComponent<TransformComponent>(glm::vec2(x * (m_tileScale * m_tileSize), y * (m_tileScale * m_tileSize)), glm::vec2(m_tileScale, m_tileScale), 0);
+			tileEntity.AddComponent<SpriteComponent>(m_textureAssetId, m_tileSize, m_tileSize, 0, false, tilesetXIndex, tilesetYIndex);
+			tiles.push_back(tileEntity);
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <SDL.h>
+
+#include "ECS/ECS.h"
+
+class AssetArchive;
+
+namespace CONST
+{
+	namespace TILEMAP
+	{
+		// tiles per side of a chunk
+		constexpr int CHUNK_SIZE = 16;
+		// in chunks around the ones the camera sees: the chunks are created before they get into view and
+		// destroyed a bit further away, so that going back and forth over a chunk border does not reload it
+		constexpr int LOAD_RADIUS = 1;
+		constexpr int UNLOAD_RADIUS = 2;
+	}
+}
+
+// The tiles of a level, created as entities chunk by chunk around the camera (see TilemapStreamingSystem).
+// A .map file has one line per row of tiles, the tiles being separated by commas. The tens of a tile are the row
+// of its image in the tileset and the units its column ("21" is the image in the third row, second column).
+// Only the numbers are kept in memory, 2 bytes per tile: maps far larger than the window only cost entities
+// for the chunks around the camera
+class Tilemap
+{
+public:
+	Tilemap(const std::string& textureAssetId, int tileSize, double tileScale, int chunkSize = CONST::TILEMAP::CHUNK_SIZE);
+
+	// the file is read in one block (or found in the archive when it is packed), false (and logged) on errors
+	bool Load(const std::string& mapPath, int numberOfColumns, int numberOfRows, const AssetArchive* archive = nullptr);
+	// false, with the row and the reason in 'error', when the map does not have numberOfRows rows of numberOfColumns tiles
+	bool Parse(const char* data, std::size_t size, int numberOfColumns, int numberOfRows, std::string& error);
+
+	// the unload radius is at least the load radius
+	void SetStreamingRadius(int loadRadius, int unloadRadius);
+
+	// creates the tiles of the chunks within the load radius of the camera, destroys the ones of the chunks outside
+	// of the unload radius. The new tiles are added to the systems with the next Registry::Update()
+	void Stream(Registry& registry, const SDL_Rect& camera);
+	void LoadAllChunks(Registry& registry);
+	void UnloadAllChunks();
+
+	int GetTile(int column, int row) const { return m_tiles[static_cast<std::size_t>(row) * m_numberOfColumns + column]; }
+	int GetNumberOfColumns() const { return m_numberOfColumns; }
+	int GetNumberOfRows() const { return m_numberOfRows; }
+	// in pixels
+	int GetWidth() const;
+	int GetHeight() const;
+
+	std::size_t GetNumberOfLoadedChunks() const { return m_loadedChunks.size(); }
+	std::size_t GetNumberOfLoadedTiles() const;
+private:
+	void LoadChunk(Registry& registry, int chunkX, int chunkY);
+	int CalculateChunkKey(int chunkX, int chunkY) const { return chunkY * m_numberOfChunkColumns + chunkX; }
+
+	std::string m_textureAssetId;
+	int m_tileSize;
+	double m_tileScale;
+	int m_chunkSize;
+	int m_loadRadius = CONST::TILEMAP::LOAD_RADIUS;
+	int m_unloadRadius = CONST::TILEMAP::UNLOAD_RADIUS;
+
+	int m_numberOfColumns = 0;
+	int m_numberOfRows = 0;
+	int m_numberOfChunkColumns = 0;
+	int m_numberOfChunkRows = 0;
+	std::vector<std::uint16_t> m_tiles;
+
+	// [ key = chunk key, value = the tiles of the chunk ]
+	std::unordered_map<int, std::vector<Entity>> m_loadedChunks;
+};
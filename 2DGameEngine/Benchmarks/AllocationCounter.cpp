@@ -0,0 +1,41 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new/delete of the benchmarks executable to count heap allocations.
+// The array and sized forms end up here too, the aligned ones are not counted
+namespace
+{
+	std::atomic<std::size_t> numberOfAllocations{ 0 };
+}
+
+std::size_t Benchmark::GetNumberOfAllocations()
+{
+	return numberOfAllocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size)
+{
+	numberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* memory = std::malloc(size == 0 ? 1 : size))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+// the compiler calls this one when the size is known, it has to free what the counting operator new allocated
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
@@ -0,0 +1,96 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "AssetStore/AssetArchive.h"
+
+// Reads every file the packer packs, once from the loose files and once from the archive (opened, mapped and indexed
+// on each run), summing their bytes so that both really read them. The files are in the system's cache after the
+// warm up run, what is measured is the cost of opening and reading many small files against one mapping.
+// Has to be run from the engine's directory (where "assets" is), the archive is written to a temporary directory
+namespace
+{
+	const std::size_t NUMBER_OF_READS = 50;
+
+	std::vector<std::string> ListPackedFiles()
+	{
+		std::vector<std::string> filePaths;
+		for (auto entry = std::filesystem::recursive_directory_iterator(CONST::ARCHIVE::ASSETS_DIRECTORY); entry != std::filesystem::recursive_directory_iterator(); ++entry)
+		{
+			if (entry->is_directory() && entry->path().filename() == CONST::ARCHIVE::SKIPPED_DIRECTORY)
+			{
+				entry.disable_recursion_pending();
+			}
+			else if (entry->is_regular_file() && entry->path().extension() != ".pak")
+			{
+				filePaths.push_back(entry->path().generic_string());
+			}
+		}
+		return filePaths;
+	}
+
+	std::size_t SumOfBytes(const unsigned char* data, std::size_t size)
+	{
+		std::size_t sum = 0;
+		for (std::size_t i = 0; i < size; i++)
+		{
+			sum += data[i];
+		}
+		return sum;
+	}
+}
+
+void Benchmark::RunAssetArchiveBenchmark()
+{
+	std::vector<std::string> filePaths = ListPackedFiles();
+	const std::string archivePath = (std::filesystem::temp_directory_path() / "AssetArchiveBenchmark.pak").generic_string();
+	if (!AssetArchive::Pack(CONST::ARCHIVE::ASSETS_DIRECTORY, archivePath))
+	{
+		return;
+	}
+	{
+		// the images replaced by their raw texture are not packed
+		AssetArchive archive;
+		archive.Open(archivePath);
+		filePaths.erase(std::remove_if(filePaths.begin(), filePaths.end(), [&archive](const std::string& filePath) { return !archive.Find(filePath).m_data; }), filePaths.end());
+	}
+	PrintHeader("Asset files reading, " + std::to_string(filePaths.size()) + " files (" + std::to_string(NUMBER_OF_READS) + " reads)");
+
+	std::size_t looseSum = 0;
+	const double looseMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_READS, [&filePaths, &looseSum]()
+	{
+		looseSum = 0;
+		for (const auto& filePath : filePaths)
+		{
+			std::ifstream file(filePath, std::ios::binary);
+			std::ostringstream content;
+			content << file.rdbuf();
+			const std::string bytes = content.str();
+			looseSum += SumOfBytes(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size());
+		}
+	});
+	PrintResult("loose files", looseMicroseconds);
+
+	std::size_t archiveSum = 0;
+	const double archiveMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_READS, [&filePaths, &archivePath, &archiveSum]()
+	{
+		archiveSum = 0;
+		AssetArchive archive;
+		archive.Open(archivePath);
+		for (const auto& filePath : filePaths)
+		{
+			const AssetArchive::Blob blob = archive.Find(filePath);
+			archiveSum += SumOfBytes(blob.m_data, blob.m_size);
+		}
+	});
+	PrintResult("archive", archiveMicroseconds);
+
+	std::cout << std::fixed << std::setprecision(1) << looseMicroseconds / archiveMicroseconds << "x faster, checksums "
+		<< (looseSum == archiveSum ? "match" : "DIFFER") << std::endl;
+	std::filesystem::remove(archivePath);
+}
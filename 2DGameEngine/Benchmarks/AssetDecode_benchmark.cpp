@@ -0,0 +1,60 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <filesystem>
+
+#include "AssetStore/AssetStore.h"
+
+// Loads every image of the assets folder one after the other with AddTexture() and all together with AddTextures(),
+// which decodes them in parallel. The textures are created with a software renderer, they are never drawn.
+// Has to be run from the engine's directory (where "assets" is)
+namespace
+{
+	const std::size_t NUMBER_OF_LOADS = 10;
+	const std::string IMAGES_DIRECTORY = "./assets/images/";
+
+	std::vector<TextureAsset> ListImages()
+	{
+		std::vector<TextureAsset> textures;
+		for (const auto& entry : std::filesystem::directory_iterator(IMAGES_DIRECTORY))
+		{
+			if (entry.path().extension() == ".png" || entry.path().extension() == ".jpg")
+			{
+				textures.push_back(TextureAsset{ entry.path().stem().string(), entry.path().generic_string() });
+			}
+		}
+		return textures;
+	}
+}
+
+void Benchmark::RunAssetDecodeBenchmark()
+{
+	const std::vector<TextureAsset> textures = ListImages();
+	PrintHeader("Texture loading, " + std::to_string(textures.size()) + " images (" + std::to_string(NUMBER_OF_LOADS) + " loads)");
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(surface);
+
+	const double oneByOneMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_LOADS, [renderer, &textures]()
+	{
+		AssetStore assetStore;
+		std::vector<AssetHandle> handles;
+		for (const auto& texture : textures)
+		{
+			handles.push_back(assetStore.AddTexture(renderer, texture.m_name, texture.m_filePath));
+		}
+	});
+	const double parallelMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_LOADS, [renderer, &textures]()
+	{
+		AssetStore assetStore;
+		const std::vector<AssetHandle> handles = assetStore.AddTextures(renderer, textures);
+	});
+
+	PrintResult("one by one", oneByOneMicroseconds);
+	PrintResult("decoded in parallel", parallelMicroseconds);
+	std::cout << std::fixed << std::setprecision(1) << oneByOneMicroseconds / parallelMicroseconds << "x faster" << std::endl;
+
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(surface);
+}
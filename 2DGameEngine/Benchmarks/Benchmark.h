@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <iomanip>
+
+// tiny helpers shared by every benchmark, there is no benchmarking library in the solution
+namespace Benchmark
+{
+	// runs 'function' 'iterations' times and returns the average duration of one run
+	template <typename TFunction>
+	double MeasureAverageMicroseconds(std::size_t iterations, TFunction&& function)
+	{
+		// warm up caches and lazy allocations so they are not measured
+		function();
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (std::size_t i = 0; i < iterations; i++)
+		{
+			function();
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		const double totalMicroseconds = std::chrono::duration<double, std::micro>(end - start).count();
+		return totalMicroseconds / static_cast<double>(iterations);
+	}
+
+	inline void PrintHeader(const std::string& benchmarkName)
+	{
+		std::cout << std::endl << "==== " << benchmarkName << " ====" << std::endl;
+	}
+
+	inline void PrintResult(const std::string& caseName, double averageMicroseconds)
+	{
+		std::cout << std::left << std::setw(48) << caseName
+			<< std::right << std::setw(12) << std::fixed << std::setprecision(2) << averageMicroseconds << " us" << std::endl;
+	}
+
+	// heap allocations made by the whole process so far, counted by the operator new in AllocationCounter.cpp
+	std::size_t GetNumberOfAllocations();
+
+	void RunRenderCullingBenchmark();
+	void RunSoftwareRenderBenchmark();
+	void RunEventBusBenchmark();
+	void RunEventAllocationsBenchmark();
+	void RunScriptBatchBenchmark();
+	void RunLuaBackendBenchmark();
+	void RunScriptCacheBenchmark();
+	void RunScriptBehaviourBenchmark();
+	void RunAssetDecodeBenchmark();
+	void RunAssetArchiveBenchmark();
+	void RunRawTextureBenchmark();
+	void RunTilemapStreamingBenchmark();
+	void RunLevelFormatBenchmark();
+	void RunPrefabBenchmark();
+}
@@ -0,0 +1,312 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <map>
+#include <list>
+#include <typeindex>
+#include <functional>
+#include <memory>
+
+#include "EventBus/EventBus.h"
+
+// Compares EventBus with the bus it replaced: a std::map keyed by type_index of std::list of
+// heap allocated callbacks called through a virtual function. The old bus is copied below
+// (only what emitting needs) so the comparison keeps working after the engine moved on
+namespace
+{
+	namespace Legacy
+	{
+		class IEventCallback
+		{
+		public:
+			virtual ~IEventCallback() = default;
+
+			void Execute(Event& eventToExecute)
+			{
+				Call(eventToExecute);
+			}
+
+		private:
+			virtual void Call(Event& eventToCall) = 0;
+		};
+
+		template<typename TOwner, typename TEvent>
+		class EventCallback : public IEventCallback
+		{
+		private:
+			typedef void (TOwner::*CallbackFunction)(TEvent&);
+		public:
+			EventCallback(TOwner* ownerInstance, CallbackFunction callbackFunction)
+				: m_ownerInstance(ownerInstance)
+				, m_callbackFunction(callbackFunction)
+			{
+			}
+
+		private:
+			virtual void Call(Event& eventToCall) override
+			{
+				std::invoke(m_callbackFunction, m_ownerInstance, static_cast<TEvent&>(eventToCall));
+			}
+
+			TOwner* m_ownerInstance;
+			CallbackFunction m_callbackFunction;
+		};
+
+		typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+
+		class EventBus
+		{
+		public:
+			template <typename TEvent, typename TOwner>
+			void SubscribeToEvent(TOwner* ownerInstance, void(TOwner::*callbackFunction)(TEvent&))
+			{
+				auto& listOfCallbacksForEventType = m_subscribers[typeid(TEvent)];
+				if (listOfCallbacksForEventType.get() == nullptr)
+				{
+					listOfCallbacksForEventType = std::make_unique<HandlerList>();
+				}
+				listOfCallbacksForEventType->push_back(std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction));
+			}
+
+			template <typename TEvent, typename ...TArgs>
+			void EmitEvent(TArgs&& ...args)
+			{
+				auto eventHandlers = m_subscribers[typeid(TEvent)].get();
+				if (eventHandlers != nullptr)
+				{
+					for (auto& eventHandler : *eventHandlers)
+					{
+						TEvent eventParams(std::forward<TArgs>(args)...);
+						eventHandler->Execute(eventParams);
+					}
+				}
+			}
+
+		private:
+			std::map<std::type_index, std::unique_ptr<HandlerList>> m_subscribers;
+		};
+	}
+
+	const std::size_t EMITS_PER_RUN = 10000;
+	const std::size_t ITERATIONS = 200;
+
+	// the game registers a handful of event types, the ones not emitted still sit in the map
+	template <int TIndex>
+	class NumberedEvent : public Event
+	{
+	public:
+		int m_value;
+
+		NumberedEvent(int value = 0)
+			: m_value(value)
+		{}
+	};
+
+	typedef NumberedEvent<0> EmittedEvent;
+
+	class Handler
+	{
+	public:
+		void OnEmittedEvent(const EmittedEvent& emittedEvent) { m_sum += emittedEvent.m_value; }
+		void OnOtherEvent1(const NumberedEvent<1>&) { m_sum++; }
+		void OnOtherEvent2(const NumberedEvent<2>&) { m_sum++; }
+		void OnOtherEvent3(const NumberedEvent<3>&) { m_sum++; }
+		void OnOtherEvent4(const NumberedEvent<4>&) { m_sum++; }
+
+		long long m_sum = 0;
+	};
+
+	void PrintEmitsPerSecond(const std::string& caseName, double averageMicroseconds)
+	{
+		const double emitsPerSecond = EMITS_PER_RUN / (averageMicroseconds * .000001);
+		std::cout << std::left << std::setw(48) << caseName
+			<< std::right << std::setw(12) << std::fixed << std::setprecision(2) << emitsPerSecond / 1000000. << " M emits/s" << std::endl;
+	}
+
+	void RunWithHandlers(std::size_t numberOfHandlers)
+	{
+		std::vector<Handler> handlers(numberOfHandlers);
+		const std::string suffix = " (" + std::to_string(numberOfHandlers) + " handlers)";
+
+		{
+			Legacy::EventBus legacyEventBus;
+			for (auto& handler : handlers)
+			{
+				legacyEventBus.SubscribeToEvent(&handler, &Handler::OnOtherEvent1);
+				legacyEventBus.SubscribeToEvent(&handler, &Handler::OnOtherEvent2);
+				legacyEventBus.SubscribeToEvent(&handler, &Handler::OnEmittedEvent);
+				legacyEventBus.SubscribeToEvent(&handler, &Handler::OnOtherEvent3);
+				legacyEventBus.SubscribeToEvent(&handler, &Handler::OnOtherEvent4);
+			}
+
+			const double averageMicroseconds = Benchmark::MeasureAverageMicroseconds(ITERATIONS, [&]()
+			{
+				for (std::size_t i = 0; i < EMITS_PER_RUN; i++)
+				{
+					legacyEventBus.EmitEvent<EmittedEvent>(static_cast<int>(i));
+				}
+			});
+			PrintEmitsPerSecond("map + list + virtual call" + suffix, averageMicroseconds);
+		}
+
+		{
+			EventBus eventBus;
+			std::vector<EventSubscription> subscriptions;
+			for (auto& handler : handlers)
+			{
+				subscriptions.push_back(eventBus.SubscribeToEvent<&Handler::OnOtherEvent1>(&handler));
+				subscriptions.push_back(eventBus.SubscribeToEvent<&Handler::OnOtherEvent2>(&handler));
+				subscriptions.push_back(eventBus.SubscribeToEvent<&Handler::OnEmittedEvent>(&handler));
+				subscriptions.push_back(eventBus.SubscribeToEvent<&Handler::OnOtherEvent3>(&handler));
+				subscriptions.push_back(eventBus.SubscribeToEvent<&Handler::OnOtherEvent4>(&handler));
+			}
+
+			const double averageMicroseconds = Benchmark::MeasureAverageMicroseconds(ITERATIONS, [&]()
+			{
+				for (std::size_t i = 0; i < EMITS_PER_RUN; i++)
+				{
+					eventBus.EmitEvent<EmittedEvent>(static_cast<int>(i));
+				}
+			});
+			PrintEmitsPerSecond("type id + handler array + delegate" + suffix, averageMicroseconds);
+		}
+
+		// keeps the handlers from being optimized away
+		long long sum = 0;
+		for (const auto& handler : handlers)
+		{
+			sum += handler.m_sum;
+		}
+		if (sum == 42)
+		{
+			std::cout << "unlikely" << std::endl;
+		}
+	}
+
+	const std::size_t PAYLOAD_SIZE = 32;
+	const std::size_t PAYLOAD_HANDLERS = 4;
+
+	// the payload is owned by the event, every copy of the event allocates
+	class VectorPayloadEvent : public Event
+	{
+	public:
+		std::vector<int> m_payload;
+
+		VectorPayloadEvent(const std::vector<int>& payload)
+			: m_payload(payload)
+		{}
+	};
+
+	// the payload lives in the bus' arena
+	class ArenaPayloadEvent : public Event
+	{
+	public:
+		EventSpan<int> m_payload;
+
+		ArenaPayloadEvent(EventSpan<int> payload)
+			: m_payload(payload)
+		{}
+	};
+
+	class PayloadHandler
+	{
+	public:
+		void OnVectorPayloadEvent(const VectorPayloadEvent& payloadEvent) { m_sum += payloadEvent.m_payload.back(); }
+		void OnArenaPayloadEvent(const ArenaPayloadEvent& payloadEvent) { m_sum += payloadEvent.m_payload[PAYLOAD_SIZE - 1]; }
+
+		long long m_sum = 0;
+	};
+
+	// 'emitEvents' sends EMITS_PER_RUN events, the allocations are counted on a run after the measured ones
+	template <typename TEmitEvents>
+	void MeasureAllocations(const std::string& caseName, TEmitEvents&& emitEvents)
+	{
+		const double averageMicroseconds = Benchmark::MeasureAverageMicroseconds(ITERATIONS, emitEvents);
+
+		const std::size_t numberOfAllocationsBefore = Benchmark::GetNumberOfAllocations();
+		emitEvents();
+		const std::size_t numberOfAllocations = Benchmark::GetNumberOfAllocations() - numberOfAllocationsBefore;
+
+		const double emitsPerSecond = EMITS_PER_RUN / (averageMicroseconds * .000001);
+		std::cout << std::left << std::setw(48) << caseName
+			<< std::right << std::setw(12) << std::fixed << std::setprecision(2) << emitsPerSecond / 1000000. << " M emits/s"
+			<< std::setw(10) << static_cast<double>(numberOfAllocations) / EMITS_PER_RUN << " allocations per emit" << std::endl;
+	}
+}
+
+void Benchmark::RunEventBusBenchmark()
+{
+	PrintHeader("EventBus emits (" + std::to_string(EMITS_PER_RUN) + " emits per run, 5 event types)");
+
+	RunWithHandlers(1);
+	RunWithHandlers(4);
+	RunWithHandlers(16);
+}
+
+void Benchmark::RunEventAllocationsBenchmark()
+{
+	PrintHeader("EventBus allocations (" + std::to_string(PAYLOAD_SIZE) + " ints of payload, " + std::to_string(PAYLOAD_HANDLERS) + " handlers)");
+
+	std::vector<PayloadHandler> handlers(PAYLOAD_HANDLERS);
+	const std::vector<int> payload(PAYLOAD_SIZE, 1);
+
+	{
+		Legacy::EventBus legacyEventBus;
+		for (auto& handler : handlers)
+		{
+			legacyEventBus.SubscribeToEvent(&handler, &PayloadHandler::OnVectorPayloadEvent);
+		}
+
+		MeasureAllocations("previous bus, built per handler", [&]()
+		{
+			for (std::size_t i = 0; i < EMITS_PER_RUN; i++)
+			{
+				legacyEventBus.EmitEvent<VectorPayloadEvent>(payload);
+			}
+		});
+	}
+
+	EventBus eventBus;
+	std::vector<EventSubscription> subscriptions;
+	for (auto& handler : handlers)
+	{
+		subscriptions.push_back(eventBus.SubscribeToEvent<&PayloadHandler::OnVectorPayloadEvent>(&handler));
+		subscriptions.push_back(eventBus.SubscribeToEvent<&PayloadHandler::OnArenaPayloadEvent>(&handler));
+	}
+
+	MeasureAllocations("emit, built once", [&]()
+	{
+		for (std::size_t i = 0; i < EMITS_PER_RUN; i++)
+		{
+			eventBus.EmitEvent<VectorPayloadEvent>(payload);
+		}
+	});
+
+	const VectorPayloadEvent prebuiltEvent(payload);
+	MeasureAllocations("emit, prebuilt event", [&]()
+	{
+		for (std::size_t i = 0; i < EMITS_PER_RUN; i++)
+		{
+			eventBus.EmitEvent(prebuiltEvent);
+		}
+	});
+
+	MeasureAllocations("enqueue + dispatch, vector payload", [&]()
+	{
+		for (std::size_t i = 0; i < EMITS_PER_RUN; i++)
+		{
+			eventBus.EnqueueEvent<VectorPayloadEvent>(payload);
+		}
+		eventBus.DispatchQueuedEvents();
+	});
+
+	MeasureAllocations("enqueue + dispatch, arena payload", [&]()
+	{
+		for (std::size_t i = 0; i < EMITS_PER_RUN; i++)
+		{
+			eventBus.EnqueueEvent<ArenaPayloadEvent>(eventBus.GetArena().Copy(payload.data(), payload.size()));
+		}
+		eventBus.DispatchQueuedEvents();
+	});
+}
@@ -0,0 +1,76 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <filesystem>
+
+#include <sol/sol.hpp>
+
+#include "ECS/ECS.h"
+#include "AssetStore/AssetStore.h"
+#include "Game/LevelLoader.h"
+#include "Game/LuaBackend.h"
+
+// Loads the levels from their script (bytecode cached) and from their compiled file, each time into a new registry.
+// The assets are loaded by the warm up run and kept, both times include reading the map of the level.
+// Has to be run from the engine's directory (where "assets" is), the levels are compiled to a temporary directory
+namespace
+{
+	const std::size_t NUMBER_OF_LOADS = 50;
+
+	void LoadLevel(const std::string& levelName, const std::string& compiledLevelsDirectory)
+	{
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_ARGB8888);
+		SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(surface);
+		auto assetStore = std::make_unique<AssetStore>();
+
+		sol::state lua;
+		LuaBackend::OpenLibraries(lua);
+
+		{
+			sol::state compilerLua;
+			LuaBackend::OpenLibraries(compilerLua);
+			if (!LevelLoader(CONST::SCRIPTS::SCRIPTS_DIRECTORY, compiledLevelsDirectory).CompileLevel(levelName, compilerLua))
+			{
+				std::cout << levelName << " could not be compiled" << std::endl;
+				return;
+			}
+		}
+
+		const auto measureLoad = [&](const std::string& levelsDirectory)
+		{
+			LevelLoader levelLoader(CONST::SCRIPTS::SCRIPTS_DIRECTORY, levelsDirectory);
+			return Benchmark::MeasureAverageMicroseconds(NUMBER_OF_LOADS, [&]()
+			{
+				auto registry = std::make_unique<Registry>();
+				levelLoader.LoadLevel(levelName, registry, assetStore, renderer, lua);
+				registry->Update();
+			});
+		};
+
+		// no compiled level in the scripts directory, the script is run
+		const double scriptMicroseconds = measureLoad(CONST::SCRIPTS::SCRIPTS_DIRECTORY);
+		Benchmark::PrintResult(levelName + " from the script", scriptMicroseconds);
+		const double compiledMicroseconds = measureLoad(compiledLevelsDirectory);
+		Benchmark::PrintResult(levelName + " compiled", compiledMicroseconds);
+
+		const auto scriptSize = std::filesystem::file_size(CONST::SCRIPTS::SCRIPTS_DIRECTORY + levelName + ".lua");
+		const auto compiledSize = std::filesystem::file_size(compiledLevelsDirectory + levelName + CONST::COMPILED_LEVELS::EXTENSION);
+		std::cout << std::fixed << std::setprecision(1) << scriptMicroseconds / compiledMicroseconds << "x faster, "
+			<< scriptSize << " bytes of script, " << compiledSize << " bytes compiled" << std::endl;
+
+		assetStore->ClearAssets();
+		SDL_DestroyRenderer(renderer);
+		SDL_FreeSurface(surface);
+	}
+}
+
+void Benchmark::RunLevelFormatBenchmark()
+{
+	PrintHeader("Level load, script vs compiled (" + std::to_string(NUMBER_OF_LOADS) + " loads)");
+
+	const std::filesystem::path compiledLevelsDirectory = std::filesystem::temp_directory_path() / "LevelFormatBenchmark";
+	LoadLevel("Level1", compiledLevelsDirectory.generic_string() + "/");
+	LoadLevel("Level2", compiledLevelsDirectory.generic_string() + "/");
+	std::filesystem::remove_all(compiledLevelsDirectory);
+}
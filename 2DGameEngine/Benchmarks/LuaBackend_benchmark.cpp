@@ -0,0 +1,96 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <sol/sol.hpp>
+
+#include "ECS/ECS.h"
+#include "AssetStore/AssetStore.h"
+#include "Game/LevelLoader.h"
+#include "Game/LuaBackend.h"
+#include "Systems/ScriptSystem.h"
+#include "Components/TransformComponent.h"
+#include "Components/RigidbodyComponent.h"
+#include "Components/ScriptComponent.h"
+
+// Runs the update scripts of Level2 (flight paths, patrols...) on the interpreter the benchmarks were built with.
+// The level only has a couple of scripted entities, each of them is copied so that the scripts cost more than the timer.
+// Build once with Lua 5.3 and once with UseLuaJIT=true (see Lua.props) to compare them, the checksum of the
+// final positions is the same for both when they move the entities the same way.
+// Has to be run from the engine's directory (where "assets" is)
+namespace
+{
+	const std::size_t NUMBER_OF_FRAMES = 1000;
+	const double DELTA_TIME = 1. / 60.;
+	const std::size_t NUMBER_OF_COPIES = 500;
+
+	void CopyScriptedEntities(Registry& registry, std::vector<Entity> scriptedEntities)
+	{
+		for (const auto& entity : scriptedEntities)
+		{
+			// copied out of the pools, adding components to the copies can move them
+			const TransformComponent transform = entity.GetComponent<TransformComponent>();
+			const ScriptComponent script = entity.GetComponent<ScriptComponent>();
+			const bool hasRigidbody = entity.HasComponent<RigidbodyComponent>();
+			const RigidbodyComponent rigidbody = hasRigidbody ? entity.GetComponent<RigidbodyComponent>() : RigidbodyComponent();
+
+			for (std::size_t i = 0; i < NUMBER_OF_COPIES; i++)
+			{
+				Entity copy = registry.CreateEntity();
+				copy.AddComponent<TransformComponent>(transform);
+				copy.AddComponent<ScriptComponent>(script);
+				if (hasRigidbody)
+				{
+					copy.AddComponent<RigidbodyComponent>(rigidbody);
+				}
+			}
+		}
+		registry.Update();
+	}
+}
+
+void Benchmark::RunLuaBackendBenchmark()
+{
+	PrintHeader(std::string("Level2 scripts per frame on ") + LuaBackend::GetName() + " (" + std::to_string(NUMBER_OF_FRAMES) + " frames)");
+
+	auto registry = std::make_unique<Registry>();
+	registry->AddSystem<ScriptSystem>();
+	auto assetStore = std::make_unique<AssetStore>();
+
+	// the textures are loaded but never drawn
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(surface);
+
+	sol::state lua;
+	LuaBackend::OpenLibraries(lua);
+	registry->GetSystem<ScriptSystem>().CreateLuaFunctionBindings(lua);
+
+	LevelLoader levelLoader;
+	levelLoader.LoadLevel(2, registry, assetStore, renderer, lua);
+	registry->Update();
+
+	auto& scriptSystem = registry->GetSystem<ScriptSystem>();
+	CopyScriptedEntities(*registry, scriptSystem.GetSystemEntities());
+	int ellapsedTime = 0;
+	const double averageMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_FRAMES, [&scriptSystem, &ellapsedTime]()
+	{
+		ellapsedTime += static_cast<int>(DELTA_TIME * 1000);
+		scriptSystem.Update(DELTA_TIME, ellapsedTime);
+	});
+	PrintResult(std::to_string(scriptSystem.GetSystemEntities().size()) + " scripted entities", averageMicroseconds);
+
+	double sumOfPositions = 0;
+	for (auto& entity : scriptSystem.GetSystemEntities())
+	{
+		if (entity.HasComponent<TransformComponent>())
+		{
+			const auto& transform = entity.GetComponent<TransformComponent>();
+			sumOfPositions += transform.m_position.x + transform.m_position.y + transform.m_rotation;
+		}
+	}
+	std::cout << "checksum " << std::fixed << std::setprecision(3) << sumOfPositions << std::endl;
+
+	assetStore->ClearAssets();
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(surface);
+}
@@ -0,0 +1,45 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <functional>
+#include <utility>
+
+// usage: Benchmarks.exe [benchmark name]...
+// with no arguments every benchmark is run
+int main(int argc, char* argv[])
+{
+	const std::vector<std::pair<std::string, std::function<void()>>> benchmarks =
+	{
+		{ "RenderCulling", Benchmark::RunRenderCullingBenchmark },
+		{ "SoftwareRender", Benchmark::RunSoftwareRenderBenchmark },
+		{ "EventBus", Benchmark::RunEventBusBenchmark },
+		{ "EventAllocations", Benchmark::RunEventAllocationsBenchmark },
+		{ "ScriptBatch", Benchmark::RunScriptBatchBenchmark },
+		{ "LuaBackend", Benchmark::RunLuaBackendBenchmark },
+		{ "ScriptCache", Benchmark::RunScriptCacheBenchmark },
+		{ "ScriptBehaviour", Benchmark::RunScriptBehaviourBenchmark },
+		{ "AssetDecode", Benchmark::RunAssetDecodeBenchmark },
+		{ "AssetArchive", Benchmark::RunAssetArchiveBenchmark },
+		{ "RawTexture", Benchmark::RunRawTextureBenchmark },
+		{ "TilemapStreaming", Benchmark::RunTilemapStreamingBenchmark },
+		{ "LevelFormat", Benchmark::RunLevelFormatBenchmark },
+		{ "Prefab", Benchmark::RunPrefabBenchmark },
+	};
+
+	for (const auto& [name, runBenchmark] : benchmarks)
+	{
+		bool shouldRun = argc <= 1;
+		for (int i = 1; i < argc; i++)
+		{
+			shouldRun = shouldRun || name == argv[i];
+		}
+
+		if (shouldRun)
+		{
+			runBenchmark();
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include "ECS/ECS.h"
+#include "Systems/MovementSystem.h"
+#include "Systems/ProjectileLifeCycleSystem.h"
+#include "Systems/CollisionSystem.h"
+#include "Components/TransformComponent.h"
+#include "Components/RigidbodyComponent.h"
+#include "Components/SpriteComponent.h"
+#include "Components/BoxColliderComponent.h"
+#include "Components/ProjectileComponent.h"
+
+// Creates a wave of projectiles, as ProjectileEmitSystem does, and adds them to the systems.
+// Each run uses a new registry so that the pools grow from their default size every time
+namespace
+{
+	const std::size_t NUMBER_OF_RUNS = 200;
+
+	std::unique_ptr<Registry> CreateRegistry()
+	{
+		auto registry = std::make_unique<Registry>();
+		registry->AddSystem<MovementSystem>();
+		registry->AddSystem<ProjectileLifeCycleSystem>();
+		registry->AddSystem<CollisionSystem>();
+		return registry;
+	}
+
+	// what ProjectileEmitSystem did before the prefab: one entity and five components at a time
+	void CreateProjectilesOneByOne(std::size_t numberOfProjectiles)
+	{
+		auto registry = CreateRegistry();
+		for (std::size_t i = 0; i < numberOfProjectiles; i++)
+		{
+			auto projectile = registry->CreateEntity();
+			projectile.Group("projectiles");
+			projectile.AddComponent<TransformComponent>(glm::vec2(i, i));
+			projectile.AddComponent<RigidbodyComponent>(glm::vec2(100, 0));
+			projectile.AddComponent<SpriteComponent>("bullet-image", 64, 64, 4);
+			projectile.AddComponent<BoxColliderComponent>();
+			projectile.AddComponent<ProjectileComponent>(true, 10);
+		}
+		registry->Update();
+	}
+
+	void InstantiateProjectiles(const Prefab& projectilePrefab, std::size_t numberOfProjectiles)
+	{
+		auto registry = CreateRegistry();
+		const std::vector<Entity> projectiles = registry->Instantiate(projectilePrefab, numberOfProjectiles);
+		for (std::size_t i = 0; i < projectiles.size(); i++)
+		{
+			projectiles[i].GetComponent<TransformComponent>().m_position = glm::vec2(i, i);
+		}
+		registry->Update();
+	}
+}
+
+void Benchmark::RunPrefabBenchmark()
+{
+	PrintHeader("Projectile creation, one by one vs prefab (" + std::to_string(NUMBER_OF_RUNS) + " runs)");
+
+	Prefab projectilePrefab;
+	projectilePrefab.Group("projectiles");
+	projectilePrefab.AddComponent<TransformComponent>();
+	projectilePrefab.AddComponent<RigidbodyComponent>(glm::vec2(100, 0));
+	projectilePrefab.AddComponent<SpriteComponent>("bullet-image", 64, 64, 4);
+	projectilePrefab.AddComponent<BoxColliderComponent>();
+	projectilePrefab.AddComponent<ProjectileComponent>(true, 10);
+
+	for (const std::size_t numberOfProjectiles : { 10, 100, 1000 })
+	{
+		const std::string projectiles = std::to_string(numberOfProjectiles) + " projectiles";
+		PrintResult(projectiles + ", one by one", MeasureAverageMicroseconds(NUMBER_OF_RUNS, [&]() { CreateProjectilesOneByOne(numberOfProjectiles); }));
+		PrintResult(projectiles + ", instantiated", MeasureAverageMicroseconds(NUMBER_OF_RUNS, [&]() { InstantiateProjectiles(projectilePrefab, numberOfProjectiles); }));
+	}
+}
@@ -0,0 +1,115 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include <SDL_image.h>
+
+#include "AssetStore/RawTexture.h"
+
+// Decodes every image of the assets folder with IMG_Load() and loads the same images converted to raw textures,
+// uncompressed and LZ4 compressed, as they would be uploaded. Nothing is uploaded, the renderer is not part of this.
+// Has to be run from the engine's directory (where "assets" is), the raw textures are written to a temporary directory
+namespace
+{
+	const std::size_t NUMBER_OF_LOADS = 10;
+
+	struct ConvertedImage
+	{
+		std::string m_imagePath;
+		std::string m_rawPath;
+		std::string m_compressedRawPath;
+	};
+
+	std::size_t FileSize(const std::string& filePath)
+	{
+		std::error_code error;
+		return static_cast<std::size_t>(std::filesystem::file_size(filePath, error));
+	}
+
+	void WriteFile(const std::string& filePath, const std::vector<unsigned char>& data)
+	{
+		std::ofstream file(filePath, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	}
+
+	std::vector<ConvertedImage> ConvertImages(const std::filesystem::path& directory)
+	{
+		std::vector<ConvertedImage> images;
+		for (const auto& entry : std::filesystem::directory_iterator(CONST::RAW_TEXTURES::IMAGES_DIRECTORY))
+		{
+			if (entry.path().extension() != ".png" && entry.path().extension() != ".jpg")
+			{
+				continue;
+			}
+
+			ConvertedImage image;
+			image.m_imagePath = entry.path().generic_string();
+			image.m_rawPath = (directory / entry.path().stem()).generic_string() + CONST::RAW_TEXTURES::EXTENSION;
+			image.m_compressedRawPath = (directory / entry.path().stem()).generic_string() + ".lz4" + CONST::RAW_TEXTURES::EXTENSION;
+
+			SDL_Surface* surface = IMG_Load(image.m_imagePath.c_str());
+			if (!surface)
+			{
+				continue;
+			}
+			WriteFile(image.m_rawPath, RawTexture::Encode(surface, CONST::RAW_TEXTURES::PIXEL_FORMAT, RawTexture::Compression::NONE));
+			WriteFile(image.m_compressedRawPath, RawTexture::Encode(surface, CONST::RAW_TEXTURES::PIXEL_FORMAT, RawTexture::Compression::LZ4));
+			SDL_FreeSurface(surface);
+			images.push_back(image);
+		}
+		return images;
+	}
+}
+
+void Benchmark::RunRawTextureBenchmark()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "RawTextureBenchmark";
+	std::filesystem::create_directories(directory);
+
+	IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+	const std::vector<ConvertedImage> images = ConvertImages(directory);
+	PrintHeader("Image loading, " + std::to_string(images.size()) + " images (" + std::to_string(NUMBER_OF_LOADS) + " loads)");
+
+	std::size_t imageBytes = 0;
+	std::size_t rawBytes = 0;
+	std::size_t compressedRawBytes = 0;
+	for (const auto& image : images)
+	{
+		imageBytes += FileSize(image.m_imagePath);
+		rawBytes += FileSize(image.m_rawPath);
+		compressedRawBytes += FileSize(image.m_compressedRawPath);
+	}
+
+	const double imageMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_LOADS, [&images]()
+	{
+		for (const auto& image : images)
+		{
+			SDL_FreeSurface(IMG_Load(image.m_imagePath.c_str()));
+		}
+	});
+	const auto measureRawTextures = [&images](std::string ConvertedImage::* rawPath)
+	{
+		return MeasureAverageMicroseconds(NUMBER_OF_LOADS, [&images, rawPath]()
+		{
+			for (const auto& image : images)
+			{
+				RawTexture::Image rawImage;
+				std::string error;
+				RawTexture::Load(image.*rawPath, rawImage, error);
+			}
+		});
+	};
+	const double rawMicroseconds = measureRawTextures(&ConvertedImage::m_rawPath);
+	const double compressedRawMicroseconds = measureRawTextures(&ConvertedImage::m_compressedRawPath);
+
+	PrintResult("decoded images (" + std::to_string(imageBytes / 1024) + " KB)", imageMicroseconds);
+	PrintResult("raw textures (" + std::to_string(rawBytes / 1024) + " KB)", rawMicroseconds);
+	PrintResult("LZ4 raw textures (" + std::to_string(compressedRawBytes / 1024) + " KB)", compressedRawMicroseconds);
+	std::cout << std::fixed << std::setprecision(1) << imageMicroseconds / rawMicroseconds << "x and "
+		<< imageMicroseconds / compressedRawMicroseconds << "x faster" << std::endl;
+
+	std::filesystem::remove_all(directory);
+}
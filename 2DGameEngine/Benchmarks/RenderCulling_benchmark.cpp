@@ -0,0 +1,134 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ECS/ECS.h"
+#include "Systems/RenderSystem.h"
+#include "Components/TransformComponent.h"
+#include "Components/SpriteComponent.h"
+#include "Components/RigidbodyComponent.h"
+
+namespace
+{
+	const std::size_t NUMBER_OF_FRAMES = 200;
+	const std::size_t NUMBER_OF_DYNAMIC_ENTITIES = 100;
+	const int TILE_SIZE = 32;
+	const SDL_Rect CAMERA_SIZE{ 0, 0, 800, 600 };
+
+	// the culling RenderSystem did before the spatial grid: test every entity and copy the visible ones
+	std::size_t CollectVisibleEntitiesLinearly(std::vector<Entity>& entities, const SDL_Rect& camera)
+	{
+		struct RenderableEntity
+		{
+			TransformComponent transformComponent;
+			SpriteComponent spriteComponent;
+		};
+
+		std::vector<RenderableEntity> renderableEntities;
+		for (const auto& entity : entities)
+		{
+			RenderableEntity renderableEntity;
+			renderableEntity.spriteComponent = entity.GetComponent<SpriteComponent>();
+			renderableEntity.transformComponent = entity.GetComponent<TransformComponent>();
+
+			const auto& transform = renderableEntity.transformComponent;
+			const auto& sprite = renderableEntity.spriteComponent;
+			const bool isEntityOutsideCameraView =
+				transform.m_position.x + transform.m_scale.x * sprite.m_width < camera.x ||
+				transform.m_position.x > camera.x + camera.w ||
+				transform.m_position.y + transform.m_scale.y * sprite.m_height < camera.y ||
+				transform.m_position.y > camera.y + camera.h;
+
+			if (isEntityOutsideCameraView && !sprite.m_isInCameraSpace) continue;
+
+			renderableEntities.emplace_back(renderableEntity);
+		}
+
+		std::sort(renderableEntities.begin(), renderableEntities.end(),
+			[](const RenderableEntity& first, const RenderableEntity& second)
+			{
+				return first.spriteComponent.m_zIndex < second.spriteComponent.m_zIndex;
+			}
+		);
+
+		return renderableEntities.size();
+	}
+
+	// a square tilemap with 'numberOfTiles' tiles plus some moving entities on top of it
+	void CreateLevel(Registry& registry, std::size_t numberOfTiles, int& mapSize)
+	{
+		const int tilesPerRow = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numberOfTiles))));
+		mapSize = tilesPerRow * TILE_SIZE;
+
+		for (std::size_t i = 0; i < numberOfTiles; i++)
+		{
+			const float x = static_cast<float>((i % tilesPerRow) * TILE_SIZE);
+			const float y = static_cast<float>((i / tilesPerRow) * TILE_SIZE);
+
+			Entity tile = registry.CreateEntity();
+			tile.AddComponent<TransformComponent>(glm::vec2(x, y));
+			tile.AddComponent<SpriteComponent>("tilemap-image", TILE_SIZE, TILE_SIZE, 0);
+		}
+
+		for (std::size_t i = 0; i < NUMBER_OF_DYNAMIC_ENTITIES; i++)
+		{
+			const float position = static_cast<float>((i * 97) % mapSize);
+
+			Entity enemy = registry.CreateEntity();
+			enemy.AddComponent<TransformComponent>(glm::vec2(position, position));
+			enemy.AddComponent<RigidbodyComponent>(glm::vec2(10, 0));
+			enemy.AddComponent<SpriteComponent>("tank-image", TILE_SIZE, TILE_SIZE, 1);
+		}
+
+		registry.Update();
+	}
+
+	// the camera travels along the diagonal of the map, one step per frame
+	SDL_Rect CalculateCamera(std::size_t frame, int mapSize)
+	{
+		const int travel = std::max(mapSize - CAMERA_SIZE.w, 1);
+		const int offset = static_cast<int>((frame * 37) % travel);
+		return SDL_Rect{ offset, offset, CAMERA_SIZE.w, CAMERA_SIZE.h };
+	}
+}
+
+void Benchmark::RunRenderCullingBenchmark()
+{
+	PrintHeader("RenderSystem culling (average per frame)");
+
+	for (const std::size_t numberOfTiles : { 1000, 10000, 100000 })
+	{
+		Registry registry;
+		registry.AddSystem<RenderSystem>();
+		int mapSize = 0;
+		CreateLevel(registry, numberOfTiles, mapSize);
+
+		auto& renderSystem = registry.GetSystem<RenderSystem>();
+
+		std::size_t frame = 0;
+		std::size_t visibleEntities = 0;
+		const double linearMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_FRAMES, [&]()
+			{
+				visibleEntities += CollectVisibleEntitiesLinearly(renderSystem.GetSystemEntities(), CalculateCamera(frame++, mapSize));
+			});
+
+		frame = 0;
+		std::size_t visibleEntitiesWithGrid = 0;
+		const double gridMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_FRAMES, [&]()
+			{
+				visibleEntitiesWithGrid += renderSystem.CollectVisibleEntities(CalculateCamera(frame++, mapSize)).size();
+			});
+
+		const std::string entities = std::to_string(numberOfTiles) + " tiles";
+		PrintResult(entities + ", linear scan", linearMicroseconds);
+		PrintResult(entities + ", spatial grid", gridMicroseconds);
+
+		if (visibleEntities != visibleEntitiesWithGrid)
+		{
+			std::cout << "  visible entities differ: " << visibleEntities << " vs " << visibleEntitiesWithGrid << std::endl;
+		}
+	}
+}
@@ -0,0 +1,162 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <cstdint>
+
+#include <SDL_ttf.h>
+#include <sol/sol.hpp>
+
+#include "ECS/ECS.h"
+#include "AssetStore/AssetStore.h"
+#include "Game/Game.h"
+#include "Game/LevelLoader.h"
+#include "Renderer/RenderThread.h"
+
+#include "Systems/RenderSystem.h"
+#include "Systems/RenderTextSystem.h"
+#include "Systems/RenderHealthBarSystem.h"
+#include "Systems/RenderColliderSystem.h"
+#include "Systems/TilemapStreamingSystem.h"
+
+// Renders levels with SDL's software renderer into an offscreen surface, so it runs on machines without a GPU.
+// Has to be run from the engine's directory (where "assets" is).
+// Besides the speed it writes the checksum of every frame to "software_render_Level<N>.txt",
+// two builds render the exact same pixels when their files are identical
+namespace
+{
+	const int NUMBER_OF_FRAMES = 300;
+	const int SCREEN_WIDTH = 1024;
+	const int SCREEN_HEIGHT = 768;
+
+	// FNV-1a over the visible pixels, the padding at the end of the rows is ignored
+	std::uint64_t CalculateChecksum(SDL_Surface* surface)
+	{
+		std::uint64_t checksum = 14695981039346656037ull;
+
+		SDL_LockSurface(surface);
+		const int bytesPerRow = surface->w * surface->format->BytesPerPixel;
+		for (int y = 0; y < surface->h; y++)
+		{
+			const Uint8* row = static_cast<const Uint8*>(surface->pixels) + y * surface->pitch;
+			for (int x = 0; x < bytesPerRow; x++)
+			{
+				checksum ^= row[x];
+				checksum *= 1099511628211ull;
+			}
+		}
+		SDL_UnlockSurface(surface);
+
+		return checksum;
+	}
+
+	// the camera goes once around the map following a figure eight, always the same path for the same map
+	SDL_Rect CalculateCamera(int frame, int cameraWidth, int cameraHeight)
+	{
+		const double pi = 3.14159265358979323846;
+		const double progress = static_cast<double>(frame) / NUMBER_OF_FRAMES;
+
+		const int maxX = std::max(Game::m_mapWidth - cameraWidth, 0);
+		const int maxY = std::max(Game::m_mapHeight - cameraHeight, 0);
+
+		return SDL_Rect{
+			static_cast<int>(maxX * (.5 + .5 * std::sin(2 * pi * progress))),
+			static_cast<int>(maxY * (.5 + .5 * std::sin(4 * pi * progress))),
+			cameraWidth,
+			cameraHeight
+		};
+	}
+
+	void RunLevel(unsigned int levelNumber)
+	{
+		const std::string levelName = "Level" + std::to_string(levelNumber);
+
+		auto registry = std::make_unique<Registry>();
+		registry->AddSystem<RenderSystem>();
+		registry->AddSystem<RenderTextSystem>();
+		registry->AddSystem<RenderHealthBarSystem>();
+		registry->AddSystem<RenderColliderSystem>();
+		registry->AddSystem<TilemapStreamingSystem>();
+		auto assetStore = std::make_unique<AssetStore>();
+
+		// same size for every level so that the numbers can be compared between levels
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+		// no render thread, SubmitFrame() executes the frame right away
+		RenderThread renderThread([surface]() { return SDL_CreateSoftwareRenderer(surface); });
+		renderThread.Start(false);
+
+		sol::state lua;
+		lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::os);
+		// Level1 picks its tilemap from the time of day, pin it so that the checksums do not depend on it
+		lua.script("os.date = function() return { hour = 12 } end");
+
+		LevelLoader levelLoader;
+		renderThread.Run([&](SDL_Renderer* renderer)
+		{
+			levelLoader.LoadLevel(levelNumber, registry, assetStore, renderer, lua);
+		});
+		registry->Update();
+
+		const SDL_Color backgroundColor{ 200, 200, 200, 255 };
+
+		std::ofstream checksumFile("software_render_" + levelName + ".txt");
+		std::uint64_t levelChecksum = 14695981039346656037ull;
+		std::size_t numberOfDrawCalls = 0;
+		double renderMicroseconds = 0;
+
+		for (int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+		{
+			const SDL_Rect camera = CalculateCamera(frame, SCREEN_WIDTH, SCREEN_HEIGHT);
+			// the tiles around the camera are not part of the rendering time
+			registry->GetSystem<TilemapStreamingSystem>().Update(registry, camera);
+			registry->Update();
+
+			const auto start = std::chrono::high_resolution_clock::now();
+
+			auto& commandList = renderThread.GetRecordingList();
+			commandList.AddClear(backgroundColor);
+			registry->GetSystem<RenderSystem>().Update(commandList, assetStore, camera);
+			registry->GetSystem<RenderTextSystem>().Update(assetStore, commandList, camera);
+			registry->GetSystem<RenderHealthBarSystem>().Update(commandList, assetStore, camera);
+			registry->GetSystem<RenderColliderSystem>().Update(commandList, camera);
+			renderThread.SubmitFrame();
+
+			const auto end = std::chrono::high_resolution_clock::now();
+			renderMicroseconds += std::chrono::duration<double, std::micro>(end - start).count();
+			numberOfDrawCalls += renderThread.GetNumberOfDrawCalls();
+
+			const std::uint64_t frameChecksum = CalculateChecksum(surface);
+			checksumFile << frame << " " << std::hex << frameChecksum << std::dec << std::endl;
+			levelChecksum = (levelChecksum ^ frameChecksum) * 1099511628211ull;
+		}
+
+		const double framesPerSecond = NUMBER_OF_FRAMES / (renderMicroseconds * .000001);
+		std::cout << std::left << std::setw(12) << levelName
+			<< std::fixed << std::setprecision(1) << framesPerSecond << " fps, "
+			<< numberOfDrawCalls / NUMBER_OF_FRAMES << " draw calls per frame, "
+			<< "checksum " << std::hex << levelChecksum << std::dec << std::endl;
+
+		assetStore->ClearAssets();
+		renderThread.Stop();
+		SDL_FreeSurface(surface);
+	}
+}
+
+void Benchmark::RunSoftwareRenderBenchmark()
+{
+	PrintHeader("Software renderer (" + std::to_string(NUMBER_OF_FRAMES) + " frames, debug overlay on)");
+
+	if (TTF_Init() != 0)
+	{
+		std::cout << "could not initialize SDL_ttf: " << TTF_GetError() << std::endl;
+		return;
+	}
+
+	RunLevel(1);
+	RunLevel(2);
+
+	TTF_Quit();
+}
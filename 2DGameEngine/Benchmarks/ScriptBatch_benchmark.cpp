@@ -0,0 +1,146 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <cmath>
+
+#include <sol/sol.hpp>
+
+#include "ECS/ECS.h"
+#include "Systems/ScriptSystem.h"
+#include "Components/TransformComponent.h"
+#include "Components/RigidbodyComponent.h"
+#include "Components/ScriptComponent.h"
+
+// Updates the same number of scripted entities with one script call per entity (through the get_/set_ functions
+// and through the component bindings) and with one batch call for all of them.
+// The scripts move the entities the same way, the positions are compared at the end
+namespace
+{
+	const std::size_t NUMBER_OF_FRAMES = 100;
+	const double DELTA_TIME = 1. / 60.;
+
+	const char* PER_ENTITY_SCRIPT = R"(
+		return function(entity, delta_time, ellapsed_time)
+			local x, y = get_position(entity)
+			local velocity_x, velocity_y = get_velocity(entity)
+			if y < 10 or y > 1000 then
+				velocity_y = -velocity_y
+			end
+			set_velocity(entity, velocity_x, velocity_y)
+			set_position(entity, x + velocity_x * delta_time, y + velocity_y * delta_time)
+		end
+	)";
+
+	const char* COMPONENT_BINDINGS_SCRIPT = R"(
+		return function(entity, delta_time, ellapsed_time)
+			local position = entity.transform.position
+			local velocity = entity.rigidbody.velocity
+			local y = position.y
+			if y < 10 or y > 1000 then
+				velocity.y = -velocity.y
+			end
+			position.x = position.x + velocity.x * delta_time
+			position.y = y + velocity.y * delta_time
+		end
+	)";
+
+	const char* BATCH_SCRIPT = R"(
+		return function(batch, delta_time, ellapsed_time)
+			local position_x, position_y = batch.position_x, batch.position_y
+			local velocity_x, velocity_y = batch.velocity_x, batch.velocity_y
+			for i = 1, batch.count do
+				local y = position_y[i]
+				local vy = velocity_y[i]
+				if y < 10 or y > 1000 then
+					vy = -vy
+					velocity_y[i] = vy
+				end
+				position_x[i] = position_x[i] + velocity_x[i] * delta_time
+				position_y[i] = y + vy * delta_time
+			end
+		end
+	)";
+
+	enum class ScriptMode
+	{
+		PerEntityFunctions,
+		PerEntityComponentBindings,
+		Batched
+	};
+
+	// returns the sum of the final positions so that the modes can be compared
+	double RunScripts(std::size_t numberOfEntities, ScriptMode scriptMode, double& averageMicroseconds)
+	{
+		sol::state lua;
+		lua.open_libraries(sol::lib::base, sol::lib::math);
+
+		auto registry = std::make_unique<Registry>();
+		registry->AddSystem<ScriptSystem>();
+		registry->GetSystem<ScriptSystem>().CreateLuaFunctionBindings(lua);
+
+		const char* scripts[] = { PER_ENTITY_SCRIPT, COMPONENT_BINDINGS_SCRIPT, BATCH_SCRIPT };
+		const sol::function script = lua.script(scripts[static_cast<int>(scriptMode)]);
+		for (std::size_t i = 0; i < numberOfEntities; i++)
+		{
+			Entity entity = registry->CreateEntity();
+			entity.AddComponent<TransformComponent>(glm::vec2(static_cast<float>(i % 1000), static_cast<float>((i * 37) % 1000)));
+			entity.AddComponent<RigidbodyComponent>(glm::vec2(10.f, 50.f + static_cast<float>(i % 7) * 10.f));
+			if (scriptMode == ScriptMode::Batched)
+			{
+				entity.AddComponent<ScriptComponent>(sol::lua_nil, script);
+			}
+			else
+			{
+				entity.AddComponent<ScriptComponent>(script);
+			}
+		}
+		registry->Update();
+
+		auto& scriptSystem = registry->GetSystem<ScriptSystem>();
+		averageMicroseconds = Benchmark::MeasureAverageMicroseconds(NUMBER_OF_FRAMES, [&scriptSystem]()
+		{
+			scriptSystem.Update(DELTA_TIME, 0);
+		});
+
+		double sumOfPositions = 0;
+		for (auto& entity : scriptSystem.GetSystemEntities())
+		{
+			const auto& position = entity.GetComponent<TransformComponent>().m_position;
+			sumOfPositions += position.x + position.y;
+		}
+		return sumOfPositions;
+	}
+
+	void RunWithEntities(std::size_t numberOfEntities)
+	{
+		const std::string suffix = " (" + std::to_string(numberOfEntities) + " entities)";
+
+		double perEntityMicroseconds = 0;
+		const double perEntitySum = RunScripts(numberOfEntities, ScriptMode::PerEntityFunctions, perEntityMicroseconds);
+		Benchmark::PrintResult("one call per entity" + suffix, perEntityMicroseconds);
+
+		double componentBindingsMicroseconds = 0;
+		const double componentBindingsSum = RunScripts(numberOfEntities, ScriptMode::PerEntityComponentBindings, componentBindingsMicroseconds);
+		Benchmark::PrintResult("one call per entity, component bindings" + suffix, componentBindingsMicroseconds);
+
+		double batchedMicroseconds = 0;
+		const double batchedSum = RunScripts(numberOfEntities, ScriptMode::Batched, batchedMicroseconds);
+		Benchmark::PrintResult("one batch call" + suffix, batchedMicroseconds);
+
+		// positions are floats in the components, the modes round at the same places
+		const auto matches = [perEntitySum](double sum) { return std::abs(perEntitySum - sum) <= 1e-6 * std::abs(perEntitySum); };
+		const bool doResultsMatch = matches(componentBindingsSum) && matches(batchedSum);
+		std::cout << "results " << (doResultsMatch ? "match" : "DIFFER") << ", "
+			<< std::fixed << std::setprecision(1) << perEntityMicroseconds / componentBindingsMicroseconds << "x faster with component bindings, "
+			<< perEntityMicroseconds / batchedMicroseconds << "x faster batched" << std::endl;
+	}
+}
+
+void Benchmark::RunScriptBatchBenchmark()
+{
+	PrintHeader("Script update per frame (" + std::to_string(NUMBER_OF_FRAMES) + " frames)");
+
+	RunWithEntities(1000);
+	RunWithEntities(10000);
+}
@@ -0,0 +1,105 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <sol/sol.hpp>
+
+#include "ECS/ECS.h"
+#include "Systems/ScriptSystem.h"
+#include "Components/TransformComponent.h"
+#include "Components/ScriptComponent.h"
+
+// Entities that only act from time to time (here every few seconds): with an update script they check the time
+// every frame, with a behaviour they sleep in the scheduler until their wait is over.
+// Both scripts count the same number of actions, the counts are compared at the end
+namespace
+{
+	const std::size_t NUMBER_OF_FRAMES = 600;
+	const double DELTA_TIME = 1. / 60.;
+
+	const char* POLLING_SCRIPT = R"(
+		number_of_actions = 0
+		local next_action_times = {}
+		return function(entity, delta_time, ellapsed_time)
+			local id = entity:get_id()
+			local next_action_time = next_action_times[id] or (2000 + id % 3000)
+			if ellapsed_time >= next_action_time then
+				number_of_actions = number_of_actions + 1
+				next_action_time = next_action_time + 5000
+			end
+			next_action_times[id] = next_action_time
+		end
+	)";
+
+	const char* BEHAVIOUR_SCRIPT = R"(
+		number_of_actions = 0
+		return function(entity)
+			wait((2000 + entity:get_id() % 3000) / 1000)
+			while true do
+				number_of_actions = number_of_actions + 1
+				wait(5)
+			end
+		end
+	)";
+
+	int RunScripts(std::size_t numberOfEntities, bool useBehaviours, double& averageMicroseconds)
+	{
+		sol::state lua;
+		lua.open_libraries(sol::lib::base, sol::lib::math);
+
+		auto registry = std::make_unique<Registry>();
+		registry->AddSystem<ScriptSystem>();
+		registry->GetSystem<ScriptSystem>().CreateLuaFunctionBindings(lua);
+
+		const sol::function script = lua.script(useBehaviours ? BEHAVIOUR_SCRIPT : POLLING_SCRIPT);
+		for (std::size_t i = 0; i < numberOfEntities; i++)
+		{
+			Entity entity = registry->CreateEntity();
+			entity.AddComponent<TransformComponent>();
+			if (useBehaviours)
+			{
+				entity.AddComponent<ScriptComponent>(sol::lua_nil, sol::lua_nil, script);
+			}
+			else
+			{
+				entity.AddComponent<ScriptComponent>(script);
+			}
+		}
+		registry->Update();
+
+		// the ellapsed time is in milliseconds, the same frames are seen by both scripts
+		auto& scriptSystem = registry->GetSystem<ScriptSystem>();
+		std::size_t frame = 0;
+		averageMicroseconds = Benchmark::MeasureAverageMicroseconds(NUMBER_OF_FRAMES, [&scriptSystem, &frame]()
+		{
+			frame++;
+			scriptSystem.Update(DELTA_TIME, static_cast<int>(frame * 1000 / 60));
+		});
+
+		return lua["number_of_actions"];
+	}
+
+	void RunWithEntities(std::size_t numberOfEntities)
+	{
+		const std::string suffix = " (" + std::to_string(numberOfEntities) + " entities)";
+
+		double pollingMicroseconds = 0;
+		const int pollingActions = RunScripts(numberOfEntities, false, pollingMicroseconds);
+		Benchmark::PrintResult("update script checking the time" + suffix, pollingMicroseconds);
+
+		double behaviourMicroseconds = 0;
+		const int behaviourActions = RunScripts(numberOfEntities, true, behaviourMicroseconds);
+		Benchmark::PrintResult("behaviour waiting" + suffix, behaviourMicroseconds);
+
+		std::cout << pollingActions << " / " << behaviourActions << " actions, "
+			<< std::fixed << std::setprecision(1) << pollingMicroseconds / behaviourMicroseconds << "x faster with behaviours" << std::endl;
+	}
+}
+
+void Benchmark::RunScriptBehaviourBenchmark()
+{
+	PrintHeader("Mostly idle scripts per frame (" + std::to_string(NUMBER_OF_FRAMES) + " frames)");
+
+	RunWithEntities(1000);
+	RunWithEntities(10000);
+}
@@ -0,0 +1,49 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include <filesystem>
+
+#include <sol/sol.hpp>
+
+#include "Game/ScriptCache.h"
+
+// Compiles the level scripts from their source and loads them from the bytecode cache, nothing is executed.
+// Has to be run from the engine's directory (where "assets" is), the cache is written to a temporary directory
+namespace
+{
+	const std::size_t NUMBER_OF_LOADS = 50;
+
+	void RunScript(const std::string& scriptName, const std::string& cacheDirectory)
+	{
+		const std::string scriptPath = CONST::SCRIPTS::SCRIPTS_DIRECTORY + scriptName + ".lua";
+		sol::state lua;
+
+		const double sourceMicroseconds = Benchmark::MeasureAverageMicroseconds(NUMBER_OF_LOADS, [&lua, &scriptPath]()
+		{
+			sol::load_result script = lua.load_file(scriptPath);
+		});
+		Benchmark::PrintResult(scriptName + " from source", sourceMicroseconds);
+
+		// the warm up run fills the cache
+		ScriptCache scriptCache(cacheDirectory);
+		const double cachedMicroseconds = Benchmark::MeasureAverageMicroseconds(NUMBER_OF_LOADS, [&lua, &scriptPath, &scriptCache]()
+		{
+			sol::load_result script = scriptCache.Load(lua, scriptPath);
+		});
+		Benchmark::PrintResult(scriptName + " from the cache", cachedMicroseconds);
+
+		std::cout << std::fixed << std::setprecision(1) << sourceMicroseconds / cachedMicroseconds << "x faster, "
+			<< scriptCache.GetNumberOfHits() << " hits " << scriptCache.GetNumberOfMisses() << " miss" << std::endl;
+	}
+}
+
+void Benchmark::RunScriptCacheBenchmark()
+{
+	PrintHeader("Level script load (" + std::to_string(NUMBER_OF_LOADS) + " loads)");
+
+	const std::filesystem::path cacheDirectory = std::filesystem::temp_directory_path() / "ScriptCacheBenchmark";
+	RunScript("Level1", cacheDirectory.generic_string() + "/");
+	RunScript("Level2", cacheDirectory.generic_string() + "/");
+	std::filesystem::remove_all(cacheDirectory);
+}
@@ -0,0 +1,66 @@
+#include "pch.h"
+
+#include "Benchmark.h"
+
+#include "ECS/ECS.h"
+#include "Tilemap/Tilemap.h"
+
+// Parses a generated map far larger than the window and moves a window sized camera across it, streaming the chunks
+// around the camera as the game does. The tiles are created and destroyed but never drawn
+namespace
+{
+	const int MAP_SIZE = 1000;
+	const int TILE_SIZE = 32;
+	const double TILE_SCALE = 2.;
+	const SDL_Rect CAMERA{ 0, 0, 1024, 768 };
+	const std::size_t NUMBER_OF_PARSES = 10;
+	const std::size_t NUMBER_OF_FRAMES = 2000;
+
+	std::string CreateMap()
+	{
+		std::string map;
+		map.reserve(static_cast<std::size_t>(MAP_SIZE) * MAP_SIZE * 3);
+		for (int row = 0; row < MAP_SIZE; row++)
+		{
+			for (int column = 0; column < MAP_SIZE; column++)
+			{
+				const int tile = (row * 7 + column * 13) % 27;
+				map += column == 0 ? "" : ",";
+				map += static_cast<char>('0' + tile / 10);
+				map += static_cast<char>('0' + tile % 10);
+			}
+			map += "\n";
+		}
+		return map;
+	}
+}
+
+void Benchmark::RunTilemapStreamingBenchmark()
+{
+	PrintHeader("Tilemap of " + std::to_string(MAP_SIZE) + "x" + std::to_string(MAP_SIZE) + " tiles (" + std::to_string(NUMBER_OF_FRAMES) + " frames)");
+
+	const std::string map = CreateMap();
+	Tilemap tilemap("tilemap-texture", TILE_SIZE, TILE_SCALE);
+	std::string error;
+	const double parseMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_PARSES, [&map, &tilemap, &error]()
+	{
+		tilemap.Parse(map.data(), map.size(), MAP_SIZE, MAP_SIZE, error);
+	});
+	PrintResult("parse (" + std::to_string(map.size() / 1024) + " KB)", parseMicroseconds);
+
+	// diagonally across the map, 8 pixels per frame
+	auto registry = std::make_unique<Registry>();
+	std::size_t maxNumberOfTiles = 0;
+	int frame = 0;
+	const double streamMicroseconds = MeasureAverageMicroseconds(NUMBER_OF_FRAMES, [&registry, &tilemap, &maxNumberOfTiles, &frame]()
+	{
+		SDL_Rect camera = CAMERA;
+		camera.x = camera.y = 8 * frame++;
+		tilemap.Stream(*registry, camera);
+		registry->Update();
+		maxNumberOfTiles = std::max(maxNumberOfTiles, tilemap.GetNumberOfLoadedTiles());
+	});
+	PrintResult("stream one frame", streamMicroseconds);
+
+	std::cout << "at most " << maxNumberOfTiles << " tiles loaded instead of " << MAP_SIZE * MAP_SIZE << std::endl;
+}
@@ -0,0 +1,13 @@
+//
+// pch.h
+//
+
+#pragma once
+
+#include <SDL.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <iostream>
@@ -0,0 +1,139 @@
+#include "pch.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "AssetStore/AssetArchive.h"
+#include "AssetStore/AssetStore.h"
+#include "TemporaryDirectorySetup.h"
+
+namespace AssetArchiveTests
+{
+	class AssetArchiveSetup : public TemporaryDirectorySetup
+	{
+	public:
+		AssetArchiveSetup()
+			: TemporaryDirectorySetup("AssetArchiveTests")
+			, m_assetsDirectory((m_directory / "assets").generic_string())
+			, m_archivePath((m_directory / "assets.pak").generic_string())
+		{
+			std::filesystem::create_directories(m_directory / "assets");
+		}
+
+		std::string WriteAsset(const std::string& name, const std::string& content)
+		{
+			return WriteFile("assets/" + name, content);
+		}
+
+		std::string Read(const std::string& filePath) const
+		{
+			const AssetArchive::Blob blob = m_archive.Find(filePath);
+			return std::string(reinterpret_cast<const char*>(blob.m_data), blob.m_size);
+		}
+
+		std::string m_assetsDirectory;
+		std::string m_archivePath;
+		AssetArchive m_archive;
+	};
+
+	TEST_F(AssetArchiveSetup, GivenADirectoryOfAssets_WhenPacked_ThenEveryFileIsReadFromTheArchiveExceptTheScripts)
+	{
+		const std::string tank = WriteAsset("images/tank.png", "tank pixels");
+		const std::string font = WriteAsset("fonts/pico8.ttf", std::string("\0glyphs\0", 8));
+		const std::string empty = WriteAsset("tilemaps/empty.map", "");
+		const std::string script = WriteAsset("scripts/Level1.lua", "return 1");
+
+		ASSERT_TRUE(AssetArchive::Pack(m_assetsDirectory, m_archivePath));
+		ASSERT_TRUE(m_archive.Open(m_archivePath));
+
+		EXPECT_EQ(3, m_archive.GetNumberOfFiles());
+		EXPECT_EQ("tank pixels", Read(tank));
+		EXPECT_EQ(std::string("\0glyphs\0", 8), Read(font));
+		EXPECT_NE(nullptr, m_archive.Find(empty).m_data);
+		EXPECT_EQ(0, m_archive.Find(empty).m_size);
+		EXPECT_EQ(nullptr, m_archive.Find(script).m_data);
+	}
+
+	TEST_F(AssetArchiveSetup, GivenAPackedFile_WhenFound_ThenItIsAlignedAndFoundWhateverTheSpellingOfItsPath)
+	{
+		WriteAsset("images/a.png", "a");
+		WriteAsset("images/b.png", "bbb");
+		ASSERT_TRUE(AssetArchive::Pack(m_assetsDirectory, m_archivePath));
+		ASSERT_TRUE(m_archive.Open(m_archivePath));
+
+		const AssetArchive::Blob blob = m_archive.Find(m_assetsDirectory + "/images/../images/b.png");
+		EXPECT_EQ(3, blob.m_size);
+		EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(blob.m_data) % AssetArchive::BLOB_ALIGNMENT);
+		EXPECT_EQ(nullptr, m_archive.Find(m_assetsDirectory + "/images/c.png").m_data);
+		EXPECT_EQ(nullptr, m_archive.OpenFile(m_assetsDirectory + "/images/c.png"));
+		// the paths of the levels
+		EXPECT_EQ("assets/images/tank.png", AssetArchive::NormalizePath("./assets/images/../images/tank.png"));
+	}
+
+	TEST_F(AssetArchiveSetup, GivenATruncatedArchive_WhenOpened_ThenItIsRejected)
+	{
+		WriteAsset("images/tank.png", std::string(1000, 't'));
+		ASSERT_TRUE(AssetArchive::Pack(m_assetsDirectory, m_archivePath));
+		std::filesystem::resize_file(m_archivePath, std::filesystem::file_size(m_archivePath) - 100);
+
+		EXPECT_FALSE(m_archive.Open(m_archivePath));
+		EXPECT_FALSE(m_archive.IsOpen());
+		EXPECT_FALSE(m_archive.Open((m_directory / "missing.pak").generic_string()));
+	}
+
+	TEST_F(AssetArchiveSetup, GivenAnIndexWithTooManyOrUnsortedEntries_WhenOpened_ThenItIsRejected)
+	{
+		WriteAsset("images/a.png", "a");
+		WriteAsset("images/b.png", "b");
+		ASSERT_TRUE(AssetArchive::Pack(m_assetsDirectory, m_archivePath));
+		std::string archive;
+		{
+			std::ifstream file(m_archivePath, std::ios::binary);
+			archive.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+		const auto writeArchive = [this](const std::string& content) { std::ofstream(m_archivePath, std::ios::binary | std::ios::trunc) << content; };
+
+		// the number of entries follows the magic and the version
+		std::string tooManyEntries = archive;
+		tooManyEntries.replace(8, 4, "\xff\xff\xff\x7f");
+		writeArchive(tooManyEntries);
+		EXPECT_FALSE(m_archive.Open(m_archivePath));
+
+		// the first path now comes after the second one, it could not be found
+		std::string unsorted = archive;
+		unsorted[unsorted.find("a.png")] = 'c';
+		writeArchive(unsorted);
+		EXPECT_FALSE(m_archive.Open(m_archivePath));
+
+		writeArchive(archive);
+		EXPECT_TRUE(m_archive.Open(m_archivePath));
+	}
+
+	TEST_F(AssetArchiveSetup, GivenAMountedArchive_WhenATextureIsAdded_ThenItIsDecodedFromTheArchive)
+	{
+		const std::string filePath = (m_directory / "assets" / "bullet.bmp").generic_string();
+		SDL_Surface* image = SDL_CreateRGBSurfaceWithFormat(0, 4, 2, 32, SDL_PIXELFORMAT_ARGB8888);
+		SDL_SaveBMP(image, filePath.c_str());
+		SDL_FreeSurface(image);
+		ASSERT_TRUE(AssetArchive::Pack(m_assetsDirectory, m_archivePath));
+		// only the archive has it now
+		std::filesystem::remove(filePath);
+
+		SDL_Surface* targetSurface = SDL_CreateRGBSurfaceWithFormat(0, 16, 16, 32, SDL_PIXELFORMAT_ARGB8888);
+		SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(targetSurface);
+		{
+			AssetStore assetStore;
+			ASSERT_TRUE(assetStore.MountArchive(m_archivePath));
+			const std::vector<AssetHandle> bullet = assetStore.AddTextures(renderer, { { "bullet", filePath } });
+
+			int width = 0;
+			int height = 0;
+			ASSERT_EQ(1, assetStore.GetTextureReferenceCount("bullet"));
+			SDL_QueryTexture(assetStore.GetTexture("bullet"), nullptr, nullptr, &width, &height);
+			EXPECT_EQ(4, width);
+			EXPECT_EQ(2, height);
+		}
+		SDL_DestroyRenderer(renderer);
+		SDL_FreeSurface(targetSurface);
+	}
+}
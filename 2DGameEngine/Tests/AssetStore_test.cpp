@@ -0,0 +1,143 @@
+#include "pch.h"
+
+#include <filesystem>
+
+#include "AssetStore/AssetStore.h"
+#include "TemporaryDirectorySetup.h"
+
+namespace AssetStoreTests
+{
+	// the images are small bitmaps written to a temporary directory, the textures are created by a software renderer
+	class AssetStoreSetup : public TemporaryDirectorySetup
+	{
+	public:
+		AssetStoreSetup()
+			: TemporaryDirectorySetup("AssetStoreTests")
+		{
+			m_targetSurface = SDL_CreateRGBSurfaceWithFormat(0, 16, 16, 32, SDL_PIXELFORMAT_ARGB8888);
+			m_renderer = SDL_CreateSoftwareRenderer(m_targetSurface);
+		}
+
+		~AssetStoreSetup()
+		{
+			m_assetStore.ClearAssets();
+			SDL_DestroyRenderer(m_renderer);
+			SDL_FreeSurface(m_targetSurface);
+		}
+
+		std::string WriteImage(const std::string& name, int width, int height)
+		{
+			const std::string filePath = (m_directory / (name + ".bmp")).generic_string();
+			SDL_Surface* image = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+			SDL_SaveBMP(image, filePath.c_str());
+			SDL_FreeSurface(image);
+			return filePath;
+		}
+
+		// as LevelLoader does, the handles of the previous level are destroyed once the new level took its references
+		void LoadLevel(const std::vector<TextureAsset>& textures)
+		{
+			m_levelAssets = m_assetStore.AddTextures(m_renderer, textures);
+		}
+
+		SDL_Surface* m_targetSurface;
+		SDL_Renderer* m_renderer;
+		AssetStore m_assetStore;
+		std::vector<AssetHandle> m_levelAssets;
+	};
+
+	TEST_F(AssetStoreSetup, GivenTwoLevelsSharingATexture_WhenTheSecondIsLoaded_ThenOnlyTheTexturesThatChangedAreLoadedAndUnloaded)
+	{
+		const std::string bulletPath = WriteImage("bullet", 4, 4);
+		LoadLevel({ { "bullet", bulletPath }, { "tank", WriteImage("tank", 8, 8) } });
+		SDL_Texture* bullet = m_assetStore.GetTexture("bullet");
+
+		LoadLevel({ { "bullet", bulletPath }, { "truck", WriteImage("truck", 8, 8) } });
+
+		EXPECT_EQ(bullet, m_assetStore.GetTexture("bullet"));
+		EXPECT_EQ(1, m_assetStore.GetTextureReferenceCount("bullet"));
+		EXPECT_EQ(0, m_assetStore.GetTextureReferenceCount("tank"));
+		EXPECT_EQ(1, m_assetStore.GetTextureReferenceCount("truck"));
+	}
+
+	TEST_F(AssetStoreSetup, GivenATextureAddedTwice_WhenItsHandlesAreDestroyed_ThenItIsUnloadedWithTheLastOne)
+	{
+		const std::string filePath = WriteImage("bullet", 4, 4);
+		AssetHandle firstHandle = m_assetStore.AddTexture(m_renderer, "bullet", filePath);
+		{
+			const AssetHandle secondHandle = m_assetStore.AddTexture(m_renderer, "bullet", filePath);
+			EXPECT_EQ(2, m_assetStore.GetTextureReferenceCount("bullet"));
+		}
+		EXPECT_EQ(1, m_assetStore.GetTextureReferenceCount("bullet"));
+
+		// moved, only the new owner gives the reference back
+		AssetHandle movedHandle = std::move(firstHandle);
+		firstHandle.Release();
+		EXPECT_EQ(1, m_assetStore.GetTextureReferenceCount("bullet"));
+
+		movedHandle.Release();
+		EXPECT_FALSE(movedHandle.IsValid());
+		EXPECT_EQ(0, m_assetStore.GetTextureReferenceCount("bullet"));
+		EXPECT_EQ(0, m_assetStore.GetMemoryUsage().m_numberOfTextures);
+	}
+
+	TEST_F(AssetStoreSetup, GivenAHandleKeptAfterTheAssetsAreCleared_WhenDestroyed_ThenTheTextureLoadedAgainStaysLoaded)
+	{
+		const std::string filePath = WriteImage("bullet", 4, 4);
+		AssetHandle oldHandle = m_assetStore.AddTexture(m_renderer, "bullet", filePath);
+		m_assetStore.ClearAssets();
+		const AssetHandle newHandle = m_assetStore.AddTexture(m_renderer, "bullet", filePath);
+
+		EXPECT_FALSE(oldHandle.IsValid());
+		oldHandle.Release();
+
+		EXPECT_EQ(1, m_assetStore.GetTextureReferenceCount("bullet"));
+	}
+
+	TEST_F(AssetStoreSetup, GivenAMissingImage_WhenAdded_ThenTheHandleIsNotValid)
+	{
+		const AssetHandle handle = m_assetStore.AddTexture(m_renderer, "missing", (m_directory / "missing.bmp").generic_string());
+
+		EXPECT_FALSE(handle.IsValid());
+		EXPECT_TRUE(m_assetStore.AddTextures(m_renderer, { { "missing", (m_directory / "missing.bmp").generic_string() } }).empty());
+	}
+
+	TEST_F(AssetStoreSetup, GivenANameGivenToAnotherFile_WhenAdded_ThenTheTextureIsReplacedAndKeepsItsReferences)
+	{
+		const AssetHandle smallTree = m_assetStore.AddTexture(m_renderer, "tree", WriteImage("small-tree", 4, 4));
+		const AssetHandle bigTree = m_assetStore.AddTexture(m_renderer, "tree", WriteImage("big-tree", 16, 16));
+
+		EXPECT_EQ(2, m_assetStore.GetTextureReferenceCount("tree"));
+		EXPECT_EQ(16 * 16 * 4, m_assetStore.GetMemoryUsage().m_textureBytes);
+	}
+
+	TEST_F(AssetStoreSetup, GivenLoadedTextures_WhenTheMemoryUsageIsRead_ThenItCountsTheirPixels)
+	{
+		LoadLevel({ { "bullet", WriteImage("bullet", 4, 4) }, { "tank", WriteImage("tank", 8, 2) } });
+
+		const AssetMemoryUsage memoryUsage = m_assetStore.GetMemoryUsage();
+
+		EXPECT_EQ(2, memoryUsage.m_numberOfTextures);
+		EXPECT_EQ((4 * 4 + 8 * 2) * 4, memoryUsage.m_textureBytes);
+		EXPECT_EQ(0, memoryUsage.m_numberOfFonts);
+	}
+
+	TEST_F(AssetStoreSetup, GivenAnImageWrittenAgain_WhenItsTexturesAreReloaded_ThenTheyHaveItsNewPixelsAndKeepTheirReferences)
+	{
+		const std::string tankPath = WriteImage("tank", 4, 4);
+		LoadLevel({ { "tank", tankPath }, { "enemy-tank", tankPath }, { "bullet", WriteImage("bullet", 4, 4) } });
+		const AssetHandle tank = m_assetStore.AddTexture(m_renderer, "tank", tankPath);
+		SDL_Texture* bullet = m_assetStore.GetTexture("bullet");
+
+		WriteImage("tank", 8, 8);
+		// the path as the file watcher gives it
+		EXPECT_EQ(2, m_assetStore.ReloadTextures(m_renderer, (m_directory / "." / "tank.bmp").generic_string()));
+
+		int width = 0;
+		SDL_QueryTexture(m_assetStore.GetTexture("enemy-tank"), nullptr, nullptr, &width, nullptr);
+		EXPECT_EQ(8, width);
+		EXPECT_EQ(2, m_assetStore.GetTextureReferenceCount("tank"));
+		EXPECT_EQ(bullet, m_assetStore.GetTexture("bullet"));
+		EXPECT_EQ((8 * 8 * 2 + 4 * 4) * 4, m_assetStore.GetMemoryUsage().m_textureBytes);
+	}
+}
@@ -0,0 +1,378 @@
+#include "pch.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include <sol/sol.hpp>
+
+#include "ECS/ECS.h"
+#include "AssetStore/AssetStore.h"
+#include "Game/LevelLoader.h"
+#include "Game/CompiledLevel.h"
+#include "Game/LuaBackend.h"
+#include "HelperFunctions.h"
+#include "Components/TransformComponent.h"
+#include "Components/SpriteComponent.h"
+#include "Components/BoxColliderComponent.h"
+#include "Components/HealthComponent.h"
+#include "Components/ScriptComponent.h"
+#include "Systems/ScriptSystem.h"
+#include "TemporaryDirectorySetup.h"
+
+namespace CompiledLevelTests
+{
+	const std::string LEVEL_SCRIPT = R"(
+		local colors = { dark_grey = { r = 60, g = 60, b = 60, a = 255 } }
+		level_setup = { background_color = colors.dark_grey }
+		speed = 25
+
+		local step = 5
+
+		Level = {
+			assets = {},
+			entities = {
+				[0] =
+				{
+					tag = "player",
+					components = {
+						transform = { position = { x = 10, y = 20 }, scale = { x = 2.0, y = 2.0 } },
+						sprite = { texture_asset_id = "player-texture", width = 16, height = 8, z_index = 3 },
+						box_collider = {},
+						health = { health_percentage = 70 }
+					}
+				},
+				{
+					group = "enemies",
+					components = {
+						transform = { position = { x = 30, y = 40 }, scale = { x = 1.0, y = 1.0 } },
+						on_update_script = { [0] = function(entity) entity.transform.position.x = speed end }
+					}
+				}
+			}
+		}
+	)";
+
+	const std::string PREFAB_LEVEL_SCRIPT = R"(
+		Level = {
+			assets = {},
+			prefabs = {
+				tree = {
+					group = "trees",
+					components = {
+						transform = { scale = { x = 2.0, y = 2.0 } },
+						sprite = { texture_asset_id = "tree-texture", width = 16, height = 32 }
+					}
+				}
+			},
+			entities = {
+				[0] =
+				{ prefab = "tree", count = 3 },
+				{ prefab = "tree", group = "palms", components = { sprite = { texture_asset_id = "palm-texture", width = 16, height = 32 } } },
+				{ prefab = "bush", group = "bushes" }
+			}
+		}
+	)";
+
+	const std::string BEHAVIOUR_LEVEL_SCRIPT = R"(
+		Level = {
+			assets = {},
+			entities = {
+				[0] =
+				{
+					group = "walkers",
+					components = {
+						transform = { position = { x = 0, y = 0 }, scale = { x = 1.0, y = 1.0 } },
+						on_update_script = { [0] = function(entity) entity.transform.position.y = 1 end },
+						behaviour_script = { [0] = function(entity)
+							local steps = 0
+							while true do
+								steps = steps + 1
+								entity.transform.position.x = steps
+								wait(0)
+							end
+						end }
+					}
+				}
+			}
+		}
+	)";
+
+	class CompiledLevelSetup : public TemporaryDirectorySetup
+	{
+	public:
+		CompiledLevelSetup()
+			: TemporaryDirectorySetup("CompiledLevelTests")
+			, m_scriptsDirectory((m_directory / "scripts").generic_string() + "/")
+			, m_compiledLevelsDirectory((m_directory / "levels").generic_string() + "/")
+			, m_assetStore(std::make_unique<AssetStore>())
+		{
+			LuaBackend::OpenLibraries(m_lua);
+		}
+
+		void WriteScript(const std::string& source)
+		{
+			WriteFile("scripts/Level.lua", source);
+		}
+
+		bool Compile()
+		{
+			sol::state lua;
+			LuaBackend::OpenLibraries(lua);
+			return LevelLoader(m_scriptsDirectory, m_compiledLevelsDirectory).CompileLevel("Level", lua);
+		}
+
+		// the level loaded into a new registry, from its compiled file when there is an up to date one
+		std::unique_ptr<Registry> Load(LevelLoader& levelLoader)
+		{
+			auto registry = std::make_unique<Registry>();
+			levelLoader.LoadLevel("Level", registry, m_assetStore, nullptr, m_lua);
+			registry->Update();
+			return registry;
+		}
+
+		// the level loaded from its script into a new registry whose ScriptSystem can run the update scripts
+		std::unique_ptr<Registry> LoadWithScriptSystem(LevelLoader& levelLoader)
+		{
+			auto registry = std::make_unique<Registry>();
+			registry->AddSystem<ScriptSystem>();
+			registry->GetSystem<ScriptSystem>().CreateLuaFunctionBindings(m_lua);
+			levelLoader.LoadLevel("Level", registry, m_assetStore, nullptr, m_lua);
+			registry->Update();
+			return registry;
+		}
+
+		std::string m_scriptsDirectory;
+		std::string m_compiledLevelsDirectory;
+		std::unique_ptr<AssetStore> m_assetStore;
+		sol::state m_lua;
+	};
+
+	TEST_F(CompiledLevelSetup, GivenACompiledLevel_WhenLoaded_ThenItCreatesTheEntitiesAndGlobalsOfTheScript)
+	{
+		WriteScript(LEVEL_SCRIPT);
+		ASSERT_TRUE(Compile());
+
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		const auto registry = Load(levelLoader);
+		ASSERT_TRUE(levelLoader.WasCompiledLevelLoaded());
+
+		// the box collider size was calculated from the sprite and the scale when the level was compiled
+		const Entity player = registry->GetEntityByTag("player");
+		EXPECT_EQ(glm::vec2(10, 20), player.GetComponent<TransformComponent>().m_position);
+		EXPECT_EQ("player-texture", player.GetComponent<SpriteComponent>().m_assetId);
+		EXPECT_EQ(3u, player.GetComponent<SpriteComponent>().m_zIndex);
+		EXPECT_EQ(32u, player.GetComponent<BoxColliderComponent>().m_width);
+		EXPECT_EQ(16u, player.GetComponent<BoxColliderComponent>().m_height);
+		EXPECT_EQ(70, player.GetComponent<HealthComponent>().m_currentHealthPertcentage);
+
+		const std::vector<Entity> enemies = registry->GetEntitiesByGroup("enemies");
+		ASSERT_EQ(1u, enemies.size());
+		EXPECT_FALSE(enemies[0].HasComponent<SpriteComponent>());
+
+		// the tables the script left in the globals are rebuilt
+		EXPECT_EQ(60, m_lua["level_setup"]["background_color"]["g"].get<int>());
+		EXPECT_EQ(25, m_lua["speed"].get<int>());
+	}
+
+	TEST_F(CompiledLevelSetup, GivenACompiledLevel_WhenItsUpdateScriptRuns_ThenItReadsTheGlobalsOfTheLevel)
+	{
+		WriteScript(LEVEL_SCRIPT);
+		ASSERT_TRUE(Compile());
+
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		const auto registry = Load(levelLoader);
+		ASSERT_TRUE(levelLoader.WasCompiledLevelLoaded());
+
+		// the function was loaded from its bytecode, the entity table stands in for the bindings
+		const Entity enemy = registry->GetEntitiesByGroup("enemies").front();
+		sol::table entity = m_lua.create_table_with("transform", m_lua.create_table_with("position", m_lua.create_table_with("x", 0)));
+		enemy.GetComponent<ScriptComponent>().m_scriptFunction(entity);
+		EXPECT_EQ(25, entity["transform"]["position"]["x"].get<int>());
+	}
+
+	TEST_F(CompiledLevelSetup, GivenAScriptChangedAfterItsLevelWasCompiled_WhenLoaded_ThenTheScriptIsRun)
+	{
+		WriteScript(LEVEL_SCRIPT);
+		ASSERT_TRUE(Compile());
+
+		std::string changedScript = LEVEL_SCRIPT;
+		changedScript.replace(changedScript.find("health_percentage = 70"), 22, "health_percentage = 40");
+		WriteScript(changedScript);
+
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		const auto registry = Load(levelLoader);
+		EXPECT_FALSE(levelLoader.WasCompiledLevelLoaded());
+		EXPECT_EQ(40, registry->GetEntityByTag("player").GetComponent<HealthComponent>().m_currentHealthPertcentage);
+	}
+
+	TEST_F(CompiledLevelSetup, GivenAnUpdateScriptUsingALocalOfTheLevelScript_WhenCompiled_ThenNoLevelIsWritten)
+	{
+		std::string script = LEVEL_SCRIPT;
+		const std::string usesGlobal = "position.x = speed end";
+		script.replace(script.find(usesGlobal), usesGlobal.size(), "position.x = step end");
+		WriteScript(script);
+
+		EXPECT_FALSE(Compile());
+		EXPECT_FALSE(std::filesystem::exists(m_compiledLevelsDirectory + "Level" + CONST::COMPILED_LEVELS::EXTENSION));
+
+		// the script still loads
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		const auto registry = Load(levelLoader);
+		EXPECT_EQ(1u, registry->GetEntitiesByGroup("enemies").size());
+	}
+
+	TEST_F(CompiledLevelSetup, GivenALevelWithPrefabs_WhenLoadedFromItsScriptAndCompiled_ThenTheirEntitiesHaveTheirComponents)
+	{
+		WriteScript(PREFAB_LEVEL_SCRIPT);
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		const auto scriptRegistry = Load(levelLoader);
+		ASSERT_FALSE(levelLoader.WasCompiledLevelLoaded());
+		ASSERT_TRUE(Compile());
+		const auto compiledRegistry = Load(levelLoader);
+		ASSERT_TRUE(levelLoader.WasCompiledLevelLoaded());
+
+		for (const auto* registry : { &scriptRegistry, &compiledRegistry })
+		{
+			const std::vector<Entity> trees = (*registry)->GetEntitiesByGroup("trees");
+			ASSERT_EQ(3u, trees.size());
+			for (const Entity& tree : trees)
+			{
+				EXPECT_EQ(glm::vec2(2, 2), tree.GetComponent<TransformComponent>().m_scale);
+				EXPECT_EQ("tree-texture", tree.GetComponent<SpriteComponent>().m_assetId);
+			}
+
+			// its own sprite replaces the prefab's one
+			const std::vector<Entity> palms = (*registry)->GetEntitiesByGroup("palms");
+			ASSERT_EQ(1u, palms.size());
+			EXPECT_EQ(glm::vec2(2, 2), palms[0].GetComponent<TransformComponent>().m_scale);
+			EXPECT_EQ("palm-texture", palms[0].GetComponent<SpriteComponent>().m_assetId);
+
+			// made from a prefab the level does not have
+			const std::vector<Entity> bushes = (*registry)->GetEntitiesByGroup("bushes");
+			ASSERT_EQ(1u, bushes.size());
+			EXPECT_FALSE(bushes[0].HasComponent<SpriteComponent>());
+		}
+	}
+
+	TEST_F(CompiledLevelSetup, GivenALoadedLevel_WhenItsChangedScriptIsReloaded_ThenItsEntitiesRunTheNewUpdateScript)
+	{
+		WriteScript(LEVEL_SCRIPT);
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		const auto registry = LoadWithScriptSystem(levelLoader);
+		const Entity enemy = registry->GetEntitiesByGroup("enemies").front();
+
+		std::string changedScript = LEVEL_SCRIPT;
+		changedScript.replace(changedScript.find("speed = 25"), 10, "speed = 30");
+		changedScript.replace(changedScript.find("= speed end"), 11, "= speed * 2 end");
+		WriteScript(changedScript);
+		ASSERT_TRUE(levelLoader.ReloadLevelScripts(registry, m_lua));
+		registry->GetSystem<ScriptSystem>().Update(0.01, 0);
+
+		// the entity was not created again
+		EXPECT_EQ(std::vector<Entity>{ enemy }, registry->GetEntitiesByGroup("enemies"));
+		EXPECT_EQ(60, enemy.GetComponent<TransformComponent>().m_position.x);
+	}
+
+	TEST_F(CompiledLevelSetup, GivenALoadedLevel_WhenItsScriptWithOtherEntitiesIsReloaded_ThenTheEntitiesKeepTheirScripts)
+	{
+		WriteScript(LEVEL_SCRIPT);
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		const auto registry = LoadWithScriptSystem(levelLoader);
+
+		std::string changedScript = LEVEL_SCRIPT;
+		changedScript.replace(changedScript.find("group = \"enemies\","), 18, "group = \"enemies\", count = 2,");
+		changedScript.replace(changedScript.find("= speed end"), 11, "= speed * 2 end");
+		WriteScript(changedScript);
+		EXPECT_FALSE(levelLoader.ReloadLevelScripts(registry, m_lua));
+		registry->GetSystem<ScriptSystem>().Update(0.01, 0);
+
+		EXPECT_EQ(25, registry->GetEntitiesByGroup("enemies").front().GetComponent<TransformComponent>().m_position.x);
+	}
+
+	TEST_F(CompiledLevelSetup, GivenALoadedLevel_WhenOnlyItsUpdateScriptChanged_ThenTheBehaviourKeepsRunningWhereItWas)
+	{
+		WriteScript(BEHAVIOUR_LEVEL_SCRIPT);
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		const auto registry = LoadWithScriptSystem(levelLoader);
+		const Entity walker = registry->GetEntitiesByGroup("walkers").front();
+		for (int frame = 0; frame < 3; frame++)
+		{
+			registry->GetSystem<ScriptSystem>().Update(0.01, 0);
+		}
+
+		std::string changedScript = BEHAVIOUR_LEVEL_SCRIPT;
+		changedScript.replace(changedScript.find("position.y = 1"), 14, "position.y = 2");
+		WriteScript(changedScript);
+		ASSERT_TRUE(levelLoader.ReloadLevelScripts(registry, m_lua));
+		registry->GetSystem<ScriptSystem>().Update(0.01, 0);
+
+		EXPECT_EQ(2, walker.GetComponent<TransformComponent>().m_position.y);
+		// started over it would be at its first step
+		EXPECT_EQ(4, walker.GetComponent<TransformComponent>().m_position.x);
+	}
+
+	TEST_F(CompiledLevelSetup, GivenADestroyedLevelEntity_WhenItsIdIsReusedAndTheLevelScriptReloaded_ThenTheNewEntityKeepsItsScript)
+	{
+		WriteScript(LEVEL_SCRIPT);
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		const auto registry = LoadWithScriptSystem(levelLoader);
+		Entity enemy = registry->GetEntitiesByGroup("enemies").front();
+		enemy.Destroy();
+		registry->Update();
+
+		Entity newEntity = registry->CreateEntity();
+		newEntity.AddComponent<TransformComponent>(glm::vec2(0, 0));
+		newEntity.AddComponent<ScriptComponent>(m_lua.script("return function(entity) entity.transform.position.x = 99 end").get<sol::function>());
+		registry->Update();
+		ASSERT_EQ(enemy.GetId(), newEntity.GetId());
+
+		std::string changedScript = LEVEL_SCRIPT;
+		changedScript.replace(changedScript.find("= speed end"), 11, "= speed * 2 end");
+		WriteScript(changedScript);
+		ASSERT_TRUE(levelLoader.ReloadLevelScripts(registry, m_lua));
+		registry->GetSystem<ScriptSystem>().Update(0.01, 0);
+
+		EXPECT_EQ(99, newEntity.GetComponent<TransformComponent>().m_position.x);
+	}
+
+	TEST_F(CompiledLevelSetup, GivenALoadedLevel_WhenAScriptIsChecked_ThenOnlyTheLevelScriptIsTheLoadedOne)
+	{
+		WriteScript(LEVEL_SCRIPT);
+		LevelLoader levelLoader(m_scriptsDirectory, m_compiledLevelsDirectory);
+		EXPECT_FALSE(levelLoader.IsLoadedLevelScript(m_scriptsDirectory + "Level.lua"));
+		const auto registry = Load(levelLoader);
+
+		EXPECT_TRUE(levelLoader.IsLoadedLevelScript(m_scriptsDirectory + "./Level.lua"));
+		EXPECT_FALSE(levelLoader.IsLoadedLevelScript(m_scriptsDirectory + "Level2.lua"));
+	}
+
+	TEST_F(CompiledLevelSetup, GivenADamagedCompiledLevel_WhenRead_ThenItIsRejected)
+	{
+		WriteScript(LEVEL_SCRIPT);
+		ASSERT_TRUE(Compile());
+
+		std::ifstream file(m_compiledLevelsDirectory + "Level" + CONST::COMPILED_LEVELS::EXTENSION, std::ios::binary);
+		std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		CompiledLevel level;
+		std::string error;
+		ASSERT_TRUE(level.Read(data.data(), data.size(), m_lua, error));
+		EXPECT_EQ(2u, level.m_entities.size());
+
+		EXPECT_FALSE(level.Read(data.data(), data.size() - 1, m_lua, error));
+
+		// the bytecode is not loaded when a byte of the file changed
+		const std::size_t checksumOffset = 8;
+		std::string damagedData = data;
+		damagedData[damagedData.size() / 2] ^= 0x20;
+		EXPECT_FALSE(level.Read(damagedData.data(), damagedData.size(), m_lua, error));
+		EXPECT_NE(std::string::npos, error.find("damaged"));
+
+		// the last record is the script of the second entity, it now refers to an entity the level does not have
+		data[data.size() - 16] = 7;
+		const std::uint64_t checksum = Helpers::CalculateChecksum(data.data() + checksumOffset + sizeof(checksum), data.size() - checksumOffset - sizeof(checksum));
+		std::memcpy(&data[checksumOffset], &checksum, sizeof(checksum));
+		EXPECT_FALSE(level.Read(data.data(), data.size(), m_lua, error));
+		EXPECT_EQ(std::string::npos, error.find("damaged"));
+	}
+}
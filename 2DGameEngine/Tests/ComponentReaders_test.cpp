@@ -0,0 +1,110 @@
+#include "pch.h"
+
+#include <sol/sol.hpp>
+
+#include "Game/ComponentReaders.h"
+#include "Game/CompiledLevel.h"
+
+namespace ComponentReadersTests
+{
+	class ComponentReadersSetup : public ::testing::Test
+	{
+	public:
+		// the components table of an entity, as a level script would give it
+		sol::table Components(const std::string& components)
+		{
+			return m_lua.script("return " + components);
+		}
+
+		// a record of 'count' entities made from 'prefab' (a prefab itself has a count of 0), with the components given
+		void ReadEntity(std::uint32_t prefab, std::uint32_t count, const std::string& components)
+		{
+			const std::uint32_t entity = static_cast<std::uint32_t>(m_level.m_entities.size());
+			m_level.m_entities.push_back(CompiledLevel::EntityRecord{ CompiledLevel::NONE, CompiledLevel::NONE, prefab, count });
+			m_componentReaders.Read(Components(components), entity, m_level);
+		}
+
+		// the box collider the entity ends up with, its own one or the one of its prefab
+		const CompiledLevel::BoxColliderRecord* FindBoxCollider(std::uint32_t entity) const
+		{
+			for (const std::uint32_t owner : { entity, m_level.m_entities[entity].m_prefab })
+			{
+				for (const auto& boxCollider : m_level.m_boxColliders)
+				{
+					if (boxCollider.m_entity == owner) return &boxCollider;
+				}
+			}
+			return nullptr;
+		}
+
+		sol::state m_lua;
+		ComponentReaders m_componentReaders;
+		CompiledLevel m_level;
+	};
+
+	TEST_F(ComponentReadersSetup, GivenComponentsOfAnEntity_WhenRead_ThenTheirRecordsAreAddedWithTheirFractionalValues)
+	{
+		m_componentReaders.Read(Components("{ rigidbody = { velocity = { x = -5.5, y = 2 } }, transform = { position = { x = 1, y = 2 }, rotation = 0.5 } }"), 3, m_level);
+
+		ASSERT_EQ(1u, m_level.m_transforms.size());
+		EXPECT_EQ(3u, m_level.m_transforms[0].m_entity);
+		EXPECT_EQ(0, m_level.m_transforms[0].m_isPositionRandom);
+		EXPECT_EQ(glm::vec2(1, 1), m_level.m_transforms[0].m_scale);
+		EXPECT_DOUBLE_EQ(0.5, m_level.m_transforms[0].m_rotation);
+		ASSERT_EQ(1u, m_level.m_rigidbodies.size());
+		EXPECT_EQ(glm::vec2(-5.5f, 2), m_level.m_rigidbodies[0].m_velocity);
+	}
+
+	TEST_F(ComponentReadersSetup, GivenABoxColliderWithoutSize_WhenRead_ThenItsSizeIsTheOneOfTheScaledSprite)
+	{
+		ReadEntity(CompiledLevel::NONE, 1, "{ box_collider = { height = 5 }, sprite = { width = 16, height = 8 }, transform = { scale = { x = 2, y = 3 } } }");
+		m_componentReaders.CompleteRecords(m_level);
+
+		ASSERT_EQ(1u, m_level.m_boxColliders.size());
+		EXPECT_EQ(32u, m_level.m_boxColliders[0].m_width);
+		EXPECT_EQ(5u, m_level.m_boxColliders[0].m_height);
+	}
+
+	TEST_F(ComponentReadersSetup, GivenAPrefabBoxColliderWithoutSize_WhenItsInstancesHaveTheirOwnTransform_ThenEachOneIsSizedWithItsOwnScale)
+	{
+		ReadEntity(CompiledLevel::NONE, 0, "{ box_collider = {}, sprite = { width = 16, height = 8 } }");
+		ReadEntity(0, 3, "{ transform = { scale = { x = 2, y = 3 } } }");
+		ReadEntity(0, 1, "{ transform = { scale = { x = 1, y = 1 } }, sprite = { width = 4, height = 4 } }");
+		ReadEntity(0, 1, "{ transform = {}, box_collider = { width = 7 } }");
+		m_componentReaders.CompleteRecords(m_level);
+
+		EXPECT_EQ(32u, FindBoxCollider(1)->m_width);
+		EXPECT_EQ(24u, FindBoxCollider(1)->m_height);
+		EXPECT_EQ(4u, FindBoxCollider(2)->m_width);
+		EXPECT_EQ(4u, FindBoxCollider(2)->m_height);
+		// its own box collider, with the sprite of the prefab
+		EXPECT_EQ(7u, FindBoxCollider(3)->m_width);
+		EXPECT_EQ(8u, FindBoxCollider(3)->m_height);
+	}
+
+	TEST_F(ComponentReadersSetup, GivenAnUnknownComponent_WhenRead_ThenItIsIgnored)
+	{
+		m_componentReaders.Read(Components("{ teleporter = { x = 1 }, health = 50, camera_follow = {} }"), 0, m_level);
+
+		EXPECT_TRUE(m_level.m_healths.empty());
+		EXPECT_EQ(std::vector<std::uint32_t>{ 0 }, m_level.m_cameraFollowEntities);
+	}
+
+	TEST_F(ComponentReadersSetup, GivenAnAddedReader_WhenItsComponentIsRead_ThenItIsUsed)
+	{
+		m_componentReaders.Add("teleporter", [](const sol::table& component, std::uint32_t entity, CompiledLevel& level)
+		{
+			level.m_dummyCharacterEntities.push_back(entity + component.get<std::uint32_t>("offset"));
+		});
+		m_componentReaders.Add("health", [](const sol::table&, std::uint32_t entity, CompiledLevel& level)
+		{
+			level.m_healths.push_back(CompiledLevel::HealthRecord{ entity, 1 });
+		});
+
+		m_componentReaders.Read(Components("{ teleporter = { offset = 10 }, health = { health_percentage = 50 } }"), 2, m_level);
+
+		EXPECT_EQ(std::vector<std::uint32_t>{ 12 }, m_level.m_dummyCharacterEntities);
+		ASSERT_EQ(1u, m_level.m_healths.size());
+		EXPECT_EQ(1, m_level.m_healths[0].m_healthPercentage);
+	}
+}
@@ -0,0 +1,45 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "EventBus/EventArena.h"
+
+namespace EventArenaTests
+{
+	TEST(EventArena, GivenData_WhenCopied_ThenCopyHoldsTheSameValuesElsewhere)
+	{
+		EventArena arena;
+		const std::vector<int> values = { 1, 2, 3, 4 };
+
+		const auto copy = arena.Copy(values.data(), values.size());
+
+		ASSERT_EQ(values.size(), copy.size());
+		ASSERT_NE(values.data(), copy.begin());
+		ASSERT_TRUE(std::equal(values.begin(), values.end(), copy.begin()));
+	}
+
+	TEST(EventArena, GivenArenaReset_WhenAllocatingAgain_ThenSameMemoryIsReused)
+	{
+		EventArena arena(1024);
+
+		void* first = arena.Allocate(100, alignof(double));
+		arena.Reset();
+		void* second = arena.Allocate(100, alignof(double));
+
+		ASSERT_EQ(first, second);
+		ASSERT_EQ(1, arena.GetNumberOfBlocks());
+	}
+
+	TEST(EventArena, GivenAllocationsBiggerThanABlock_WhenAllocated_ThenTheyAreAlignedAndDoNotOverlap)
+	{
+		EventArena arena(64);
+
+		auto* small = static_cast<unsigned char*>(arena.Allocate(40, 1));
+		auto* big = static_cast<unsigned char*>(arena.Allocate(500, 16));
+
+		ASSERT_EQ(0, reinterpret_cast<std::uintptr_t>(big) % 16);
+		ASSERT_TRUE(big + 500 <= small || small + 40 <= big);
+		ASSERT_EQ(2, arena.GetNumberOfBlocks());
+	}
+}
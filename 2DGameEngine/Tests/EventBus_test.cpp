@@ -0,0 +1,508 @@
+#include "pch.h"
+
+#include <thread>
+
+#include "EventBus/EventBus.h"
+
+namespace EventBusTests
+{
+	class CounterEvent : public Event
+	{
+	public:
+		int m_value;
+
+		CounterEvent(int value = 0)
+			: m_value(value)
+		{}
+	};
+
+	class OtherEvent : public Event
+	{
+	public:
+		OtherEvent() = default;
+	};
+
+	// counts how many times it is built, copies and moves included
+	class CountedEvent : public Event
+	{
+	public:
+		std::string m_name;
+		EventSpan<int> m_payload;
+
+		inline static int m_numberOfConstructions = 0;
+
+		CountedEvent(std::string name, EventSpan<int> payload = EventSpan<int>(nullptr, 0))
+			: m_name(std::move(name))
+			, m_payload(payload)
+		{
+			m_numberOfConstructions++;
+		}
+
+		CountedEvent(const CountedEvent& other)
+			: m_name(other.m_name)
+			, m_payload(other.m_payload)
+		{
+			m_numberOfConstructions++;
+		}
+
+		CountedEvent(CountedEvent&& other) noexcept
+			: m_name(std::move(other.m_name))
+			, m_payload(other.m_payload)
+		{
+			m_numberOfConstructions++;
+		}
+	};
+
+	// keeps what every call received
+	class Recorder
+	{
+	public:
+		void OnCountedEvent(const CountedEvent& countedEvent)
+		{
+			m_addresses.push_back(&countedEvent);
+			m_names.push_back(countedEvent.m_name);
+			m_payloads.emplace_back(countedEvent.m_payload.begin(), countedEvent.m_payload.end());
+		}
+
+		std::vector<const CountedEvent*> m_addresses;
+		std::vector<std::string> m_names;
+		std::vector<std::vector<int>> m_payloads;
+	};
+
+	class ProducedEvent : public Event
+	{
+	public:
+		std::size_t m_producerIndex;
+		int m_sequence;
+
+		ProducedEvent(std::size_t producerIndex, int sequence)
+			: m_producerIndex(producerIndex)
+			, m_sequence(sequence)
+		{}
+	};
+
+	class ProducedEventRecorder
+	{
+	public:
+		void OnProducedEvents(EventSpan<ProducedEvent> producedEvents)
+		{
+			for (const auto& producedEvent : producedEvents)
+			{
+				m_received.emplace_back(producedEvent.m_producerIndex, producedEvent.m_sequence);
+			}
+		}
+
+		std::vector<std::pair<std::size_t, int>> m_received;
+	};
+
+	// types of their own, so that the test decides in which order they get their ids
+	template <int TNumber>
+	class NumberedEvent : public Event
+	{
+	};
+
+	class NumberedEventRecorder
+	{
+	public:
+		template <int TNumber>
+		void OnNumberedEvent(const NumberedEvent<TNumber>&)
+		{
+			m_received.push_back(TNumber);
+		}
+
+		std::vector<int> m_received;
+	};
+
+	class Counter
+	{
+	public:
+		void OnCounterEvent(const CounterEvent& counterEvent)
+		{
+			m_numberOfCalls++;
+			m_lastValue = counterEvent.m_value;
+		}
+
+		void OnOtherEvent(const OtherEvent&)
+		{
+			m_numberOfOtherCalls++;
+		}
+
+		void OnCounterEvents(EventSpan<CounterEvent> counterEvents)
+		{
+			m_numberOfBatches++;
+			for (const auto& counterEvent : counterEvents)
+			{
+				m_batchValues.push_back(counterEvent.m_value);
+			}
+		}
+
+		int m_numberOfCalls = 0;
+		int m_numberOfBatches = 0;
+		std::vector<int> m_batchValues;
+		int m_numberOfOtherCalls = 0;
+		int m_lastValue = 0;
+	};
+
+	// unsubscribes another counter, or subscribes it, from inside its handler
+	class SubscriptionChanger
+	{
+	public:
+		void UnsubscribeOther(const CounterEvent&)
+		{
+			m_otherSubscription->Unsubscribe();
+		}
+
+		void SubscribeOther(const CounterEvent&)
+		{
+			if (!m_newSubscription.IsSubscribed())
+			{
+				m_newSubscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvent>(m_other);
+			}
+		}
+
+		void EnqueueAnother(const CounterEvent& counterEvent)
+		{
+			m_eventBus->EnqueueEvent<CounterEvent>(counterEvent.m_value + 100);
+		}
+
+		EventBus* m_eventBus = nullptr;
+		Counter* m_other = nullptr;
+		EventSubscription* m_otherSubscription = nullptr;
+		EventSubscription m_newSubscription;
+	};
+
+	class EventBusSetup : public ::testing::Test
+	{
+	public:
+		EventBusSetup()
+			: m_eventBus(std::make_unique<EventBus>())
+		{
+		}
+
+		std::unique_ptr<EventBus> m_eventBus;
+		Counter m_counter;
+	};
+
+	TEST_F(EventBusSetup, GivenSubscription_WhenEventEmitted_ThenHandlerIsCalledWithTheEvent)
+	{
+		auto subscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvent>(&m_counter);
+
+		m_eventBus->EmitEvent<CounterEvent>(7);
+
+		ASSERT_EQ(1, m_counter.m_numberOfCalls);
+		ASSERT_EQ(7, m_counter.m_lastValue);
+		ASSERT_EQ(0, m_counter.m_numberOfOtherCalls);
+	}
+
+	TEST_F(EventBusSetup, GivenSubscription_WhenSeveralFramesPass_ThenHandlerIsStillSubscribed)
+	{
+		auto subscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvent>(&m_counter);
+
+		for (int frame = 0; frame < 10; frame++)
+		{
+			m_eventBus->EmitEvent<CounterEvent>(frame);
+		}
+
+		ASSERT_EQ(10, m_counter.m_numberOfCalls);
+		ASSERT_EQ(1, m_eventBus->GetNumberOfHandlers());
+	}
+
+	TEST_F(EventBusSetup, GivenSubscriptionHandleDestroyed_WhenEventEmitted_ThenHandlerIsNotCalled)
+	{
+		{
+			auto subscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvent>(&m_counter);
+		}
+
+		m_eventBus->EmitEvent<CounterEvent>(1);
+
+		ASSERT_EQ(0, m_counter.m_numberOfCalls);
+		ASSERT_EQ(0, m_eventBus->GetNumberOfHandlers());
+	}
+
+	TEST_F(EventBusSetup, GivenSubscriptionHandleMoved_WhenEventEmitted_ThenHandlerIsStillCalled)
+	{
+		EventSubscription movedSubscription;
+		{
+			auto subscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvent>(&m_counter);
+			movedSubscription = std::move(subscription);
+		}
+
+		m_eventBus->EmitEvent<CounterEvent>(1);
+
+		ASSERT_TRUE(movedSubscription.IsSubscribed());
+		ASSERT_EQ(1, m_counter.m_numberOfCalls);
+	}
+
+	TEST_F(EventBusSetup, GivenHandlerUnsubscribedDuringDispatch_WhenEventEmitted_ThenItIsNotCalledAnymore)
+	{
+		// the changer is called first and unsubscribes the counter before its turn
+		SubscriptionChanger changer;
+		auto changerSubscription = m_eventBus->SubscribeToEvent<&SubscriptionChanger::UnsubscribeOther>(&changer);
+		auto counterSubscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvent>(&m_counter);
+		changer.m_otherSubscription = &counterSubscription;
+
+		m_eventBus->EmitEvent<CounterEvent>(1);
+		m_eventBus->EmitEvent<CounterEvent>(2);
+
+		ASSERT_EQ(0, m_counter.m_numberOfCalls);
+		ASSERT_EQ(1, m_eventBus->GetNumberOfHandlers());
+	}
+
+	TEST_F(EventBusSetup, GivenHandlerSubscribedDuringDispatch_WhenEventEmitted_ThenItOnlyReceivesTheNextEvents)
+	{
+		SubscriptionChanger changer;
+		changer.m_eventBus = m_eventBus.get();
+		changer.m_other = &m_counter;
+		auto changerSubscription = m_eventBus->SubscribeToEvent<&SubscriptionChanger::SubscribeOther>(&changer);
+
+		m_eventBus->EmitEvent<CounterEvent>(1);
+		ASSERT_EQ(0, m_counter.m_numberOfCalls);
+
+		m_eventBus->EmitEvent<CounterEvent>(2);
+		ASSERT_EQ(1, m_counter.m_numberOfCalls);
+		ASSERT_EQ(2, m_counter.m_lastValue);
+	}
+
+	TEST_F(EventBusSetup, GivenSubscriptionHandle_WhenEventBusIsDestroyedFirst_ThenHandleCanStillBeDestroyed)
+	{
+		auto subscription = m_eventBus->SubscribeToEvent<&Counter::OnOtherEvent>(&m_counter);
+
+		m_eventBus.reset();
+
+		ASSERT_FALSE(subscription.IsSubscribed());
+		subscription.Unsubscribe();
+	}
+
+	TEST_F(EventBusSetup, GivenSubscriptionHandle_WhenEventBusIsReset_ThenHandleIsEmptyAndDoesNotTouchNewSubscriptions)
+	{
+		auto oldSubscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvent>(&m_counter);
+
+		m_eventBus->Reset();
+		auto newSubscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvent>(&m_counter);
+
+		ASSERT_FALSE(oldSubscription.IsSubscribed());
+		ASSERT_TRUE(newSubscription.IsSubscribed());
+		oldSubscription.Unsubscribe();
+		m_eventBus->EmitEvent<CounterEvent>(1);
+		ASSERT_EQ(1, m_counter.m_numberOfCalls);
+	}
+
+	TEST_F(EventBusSetup, GivenBatchSubscription_WhenEventsEnqueued_ThenHandlerReceivesThemInOrderOnlyOnDispatch)
+	{
+		auto subscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvents>(&m_counter);
+
+		m_eventBus->EnqueueEvent<CounterEvent>(1);
+		m_eventBus->EnqueueEvent<CounterEvent>(2);
+		m_eventBus->EnqueueEvent<CounterEvent>(3);
+		ASSERT_EQ(0, m_counter.m_numberOfBatches);
+		ASSERT_EQ(3, m_eventBus->GetNumberOfQueuedEvents());
+
+		m_eventBus->DispatchQueuedEvents();
+
+		ASSERT_EQ(1, m_counter.m_numberOfBatches);
+		ASSERT_EQ(std::vector<int>({ 1, 2, 3 }), m_counter.m_batchValues);
+		ASSERT_EQ(0, m_eventBus->GetNumberOfQueuedEvents());
+	}
+
+	TEST_F(EventBusSetup, GivenSingleEventSubscription_WhenQueuedEventsDispatched_ThenHandlerIsCalledForEachEvent)
+	{
+		auto subscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvent>(&m_counter);
+
+		m_eventBus->EnqueueEvent<CounterEvent>(1);
+		m_eventBus->EnqueueEvent<CounterEvent>(2);
+		m_eventBus->DispatchQueuedEvents();
+
+		ASSERT_EQ(2, m_counter.m_numberOfCalls);
+		ASSERT_EQ(2, m_counter.m_lastValue);
+	}
+
+	TEST_F(EventBusSetup, GivenHandlerEnqueuingDuringDispatch_WhenDispatched_ThenNewEventWaitsForTheNextDispatch)
+	{
+		SubscriptionChanger changer;
+		changer.m_eventBus = m_eventBus.get();
+		auto changerSubscription = m_eventBus->SubscribeToEvent<&SubscriptionChanger::EnqueueAnother>(&changer);
+		auto counterSubscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvents>(&m_counter);
+
+		m_eventBus->EnqueueEvent<CounterEvent>(1);
+		m_eventBus->DispatchQueuedEvents();
+		ASSERT_EQ(std::vector<int>({ 1 }), m_counter.m_batchValues);
+		ASSERT_EQ(1, m_eventBus->GetNumberOfQueuedEvents());
+
+		changerSubscription.Unsubscribe();
+		m_eventBus->DispatchQueuedEvents();
+		ASSERT_EQ(std::vector<int>({ 1, 101 }), m_counter.m_batchValues);
+	}
+
+	TEST_F(EventBusSetup, GivenBatchSubscription_WhenEventEmitted_ThenHandlerReceivesABatchOfOne)
+	{
+		auto subscription = m_eventBus->SubscribeToEvent<&Counter::OnCounterEvents>(&m_counter);
+
+		m_eventBus->EmitEvent<CounterEvent>(5);
+
+		ASSERT_EQ(1, m_counter.m_numberOfBatches);
+		ASSERT_EQ(std::vector<int>({ 5 }), m_counter.m_batchValues);
+	}
+
+	TEST_F(EventBusSetup, GivenSeveralHandlers_WhenEventEmittedWithArguments_ThenEventIsBuiltOnceAndEveryHandlerSeesIt)
+	{
+		Recorder recorders[3];
+		auto firstSubscription = m_eventBus->SubscribeToEvent<&Recorder::OnCountedEvent>(&recorders[0]);
+		auto secondSubscription = m_eventBus->SubscribeToEvent<&Recorder::OnCountedEvent>(&recorders[1]);
+		auto thirdSubscription = m_eventBus->SubscribeToEvent<&Recorder::OnCountedEvent>(&recorders[2]);
+		CountedEvent::m_numberOfConstructions = 0;
+
+		// moved into the event, forwarding it once per handler would leave the later handlers an empty string
+		std::string name = "a name long enough to not fit in the small string buffer";
+		m_eventBus->EmitEvent<CountedEvent>(std::move(name));
+
+		ASSERT_EQ(1, CountedEvent::m_numberOfConstructions);
+		for (const auto& recorder : recorders)
+		{
+			ASSERT_EQ(1, recorder.m_addresses.size());
+			ASSERT_EQ(recorders[0].m_addresses[0], recorder.m_addresses[0]);
+			ASSERT_EQ("a name long enough to not fit in the small string buffer", recorder.m_names[0]);
+		}
+	}
+
+	TEST_F(EventBusSetup, GivenPrebuiltEvent_WhenEmitted_ThenHandlersGetThatInstanceWithoutCopies)
+	{
+		Recorder recorders[2];
+		auto firstSubscription = m_eventBus->SubscribeToEvent<&Recorder::OnCountedEvent>(&recorders[0]);
+		auto secondSubscription = m_eventBus->SubscribeToEvent<&Recorder::OnCountedEvent>(&recorders[1]);
+		const CountedEvent prebuiltEvent("prebuilt");
+		CountedEvent::m_numberOfConstructions = 0;
+
+		m_eventBus->EmitEvent(prebuiltEvent);
+
+		ASSERT_EQ(0, CountedEvent::m_numberOfConstructions);
+		ASSERT_EQ(&prebuiltEvent, recorders[0].m_addresses[0]);
+		ASSERT_EQ(&prebuiltEvent, recorders[1].m_addresses[0]);
+	}
+
+	TEST_F(EventBusSetup, GivenNonConstPrebuiltEvent_WhenEmittedWithItsType_ThenHandlersGetThatInstanceWithoutCopies)
+	{
+		Recorder recorders[2];
+		auto firstSubscription = m_eventBus->SubscribeToEvent<&Recorder::OnCountedEvent>(&recorders[0]);
+		auto secondSubscription = m_eventBus->SubscribeToEvent<&Recorder::OnCountedEvent>(&recorders[1]);
+		CountedEvent prebuiltEvent("prebuilt");
+		CountedEvent::m_numberOfConstructions = 0;
+
+		m_eventBus->EmitEvent<CountedEvent>(prebuiltEvent);
+		m_eventBus->EmitEvent<CountedEvent>(std::move(prebuiltEvent));
+
+		ASSERT_EQ(0, CountedEvent::m_numberOfConstructions);
+		ASSERT_EQ(&prebuiltEvent, recorders[0].m_addresses[0]);
+		ASSERT_EQ(&prebuiltEvent, recorders[1].m_addresses[1]);
+	}
+
+	TEST_F(EventBusSetup, GivenNoHandler_WhenEventEmitted_ThenEventIsNotBuilt)
+	{
+		CountedEvent::m_numberOfConstructions = 0;
+
+		m_eventBus->EmitEvent<CountedEvent>("nobody listens");
+
+		ASSERT_EQ(0, CountedEvent::m_numberOfConstructions);
+	}
+
+	TEST_F(EventBusSetup, GivenQueuedEventWithArenaPayload_WhenDispatched_ThenEveryHandlerSeesTheSamePayload)
+	{
+		Recorder recorders[2];
+		auto firstSubscription = m_eventBus->SubscribeToEvent<&Recorder::OnCountedEvent>(&recorders[0]);
+		auto secondSubscription = m_eventBus->SubscribeToEvent<&Recorder::OnCountedEvent>(&recorders[1]);
+
+		{
+			const std::vector<int> values = { 4, 8, 15, 16, 23, 42 };
+			m_eventBus->EnqueueEvent<CountedEvent>("payload", m_eventBus->GetArena().Copy(values.data(), values.size()));
+		}
+		m_eventBus->DispatchQueuedEvents();
+
+		const std::vector<int> expectedPayload = { 4, 8, 15, 16, 23, 42 };
+		ASSERT_EQ(expectedPayload, recorders[0].m_payloads[0]);
+		ASSERT_EQ(expectedPayload, recorders[1].m_payloads[0]);
+		ASSERT_EQ(recorders[0].m_addresses[0], recorders[1].m_addresses[0]);
+	}
+
+	TEST_F(EventBusSetup, GivenProducersOnSeveralThreads_WhenDispatched_ThenEventsAreOrderedByProducerThenSequence)
+	{
+		const std::size_t numberOfProducers = 4;
+		const int eventsPerProducer = 1000;
+
+		ProducedEventRecorder recorder;
+		auto subscription = m_eventBus->SubscribeToEvent<&ProducedEventRecorder::OnProducedEvents>(&recorder);
+		m_eventBus->SetNumberOfProducers(numberOfProducers);
+
+		// enqueued on the bus itself, these come before the producers' events
+		m_eventBus->EnqueueEvent<ProducedEvent>(numberOfProducers, -1);
+
+		std::vector<std::thread> workers;
+		for (std::size_t producerIndex = 0; producerIndex < numberOfProducers; producerIndex++)
+		{
+			workers.emplace_back([this, producerIndex, eventsPerProducer]()
+			{
+				auto& producer = m_eventBus->GetProducer(producerIndex);
+				for (int sequence = 0; sequence < eventsPerProducer; sequence++)
+				{
+					producer.EnqueueEvent<ProducedEvent>(producerIndex, sequence);
+				}
+			});
+		}
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		ASSERT_EQ(numberOfProducers * eventsPerProducer + 1, m_eventBus->GetNumberOfQueuedEvents());
+		m_eventBus->DispatchQueuedEvents();
+
+		std::vector<std::pair<std::size_t, int>> expected = { { numberOfProducers, -1 } };
+		for (std::size_t producerIndex = 0; producerIndex < numberOfProducers; producerIndex++)
+		{
+			for (int sequence = 0; sequence < eventsPerProducer; sequence++)
+			{
+				expected.emplace_back(producerIndex, sequence);
+			}
+		}
+		ASSERT_EQ(expected, recorder.m_received);
+		ASSERT_EQ(0, m_eventBus->GetNumberOfQueuedEvents());
+	}
+
+	TEST_F(EventBusSetup, GivenProducersRemoved_WhenDispatched_ThenTheirEventsAreStillDelivered)
+	{
+		ProducedEventRecorder recorder;
+		auto subscription = m_eventBus->SubscribeToEvent<&ProducedEventRecorder::OnProducedEvents>(&recorder);
+		m_eventBus->SetNumberOfProducers(2);
+		m_eventBus->GetProducer(1).EnqueueEvent<ProducedEvent>(1, 0);
+
+		m_eventBus->SetNumberOfProducers(1);
+		m_eventBus->DispatchQueuedEvents();
+
+		ASSERT_EQ(1, recorder.m_received.size());
+	}
+
+	TEST_F(EventBusSetup, GivenEventTypesWhoseIdsAreInAnotherOrder_WhenDispatched_ThenTheTypesAreDeliveredInTheOrderTheyWereQueued)
+	{
+		// as if a worker thread had used the last type first
+		EventType<NumberedEvent<3>>::GetId();
+		EventType<NumberedEvent<2>>::GetId();
+		EventType<NumberedEvent<1>>::GetId();
+
+		NumberedEventRecorder recorder;
+		auto firstSubscription = m_eventBus->SubscribeToEvent<&NumberedEventRecorder::OnNumberedEvent<1>>(&recorder);
+		auto secondSubscription = m_eventBus->SubscribeToEvent<&NumberedEventRecorder::OnNumberedEvent<2>>(&recorder);
+		auto thirdSubscription = m_eventBus->SubscribeToEvent<&NumberedEventRecorder::OnNumberedEvent<3>>(&recorder);
+		m_eventBus->SetNumberOfProducers(1);
+
+		m_eventBus->EnqueueEvent<NumberedEvent<1>>();
+		m_eventBus->GetProducer(0).EnqueueEvent<NumberedEvent<2>>();
+		m_eventBus->GetProducer(0).EnqueueEvent<NumberedEvent<3>>();
+		m_eventBus->GetProducer(0).EnqueueEvent<NumberedEvent<1>>();
+		m_eventBus->DispatchQueuedEvents();
+		ASSERT_EQ(std::vector<int>({ 1, 1, 2, 3 }), recorder.m_received);
+
+		recorder.m_received.clear();
+		m_eventBus->EnqueueEvent<NumberedEvent<3>>();
+		m_eventBus->EnqueueEvent<NumberedEvent<1>>();
+		m_eventBus->DispatchQueuedEvents();
+		ASSERT_EQ(std::vector<int>({ 3, 1 }), recorder.m_received);
+	}
+}
\ No newline at end of file
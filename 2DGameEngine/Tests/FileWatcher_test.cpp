@@ -0,0 +1,53 @@
+#include "pch.h"
+
+#include <filesystem>
+
+#include "FileWatcher/FileWatcher.h"
+#include "TemporaryDirectorySetup.h"
+
+namespace FileWatcherTests
+{
+	class FileWatcherSetup : public TemporaryDirectorySetup
+	{
+	public:
+		FileWatcherSetup()
+			: TemporaryDirectorySetup("FileWatcherTests")
+		{
+		}
+	};
+
+	TEST_F(FileWatcherSetup, GivenAPolledDirectory_WhenAFileIsWritten_ThenItIsReportedOnce)
+	{
+		const std::string levelPath = WriteFile("Level.lua", "speed = 1");
+		FileWatcher fileWatcher(false, 0);
+		ASSERT_TRUE(fileWatcher.Watch(m_directory.generic_string(), { ".lua" }));
+		EXPECT_FALSE(fileWatcher.IsUsingNotifications());
+		EXPECT_TRUE(fileWatcher.PollChanges().empty());
+
+		WriteFile("Level.lua", "speed = 2");
+		// the file system may keep the write times to the second
+		std::filesystem::last_write_time(levelPath, std::filesystem::last_write_time(levelPath) + std::chrono::seconds(1));
+
+		EXPECT_EQ(std::vector<std::string>{ levelPath }, fileWatcher.PollChanges());
+		EXPECT_TRUE(fileWatcher.PollChanges().empty());
+	}
+
+	TEST_F(FileWatcherSetup, GivenAWatchedDirectory_WhenFilesAreWritten_ThenOnlyTheOnesWithAWatchedExtensionAreReported)
+	{
+		// notified on Linux, polled elsewhere
+		FileWatcher fileWatcher(true, 0);
+		ASSERT_TRUE(fileWatcher.Watch(m_directory.generic_string(), { ".png", ".jpg" }));
+
+		const std::string tankPath = WriteFile("tank.png", "pixels");
+		WriteFile("tank.txt", "notes");
+
+		EXPECT_EQ(std::vector<std::string>{ tankPath }, fileWatcher.PollChanges());
+	}
+
+	TEST_F(FileWatcherSetup, GivenAMissingDirectory_WhenWatched_ThenItIsRefused)
+	{
+		FileWatcher fileWatcher;
+
+		EXPECT_FALSE(fileWatcher.Watch((m_directory / "missing").generic_string(), { ".lua" }));
+	}
+}
@@ -0,0 +1,70 @@
+#include "pch.h"
+
+#include "ECS/ECS.h"
+#include "Game/Game.h"
+
+#include "Systems/MovementSystem.h"
+#include "Components/SpriteComponent.h"
+
+namespace PrefabTests
+{
+	class TreePrefabSetup : public ::testing::Test
+	{
+	public:
+		TreePrefabSetup()
+		{
+			m_registry = std::make_unique<Registry>();
+			m_registry->AddSystem<MovementSystem>();
+
+			m_treePrefab.Group("trees");
+			m_treePrefab.AddComponent<TransformComponent>(glm::vec2(10, 20), glm::vec2(2, 2));
+			m_treePrefab.AddComponent<SpriteComponent>("tree-texture", 16, 32);
+		}
+
+		std::unique_ptr<Registry> m_registry;
+		Prefab m_treePrefab;
+	};
+
+	TEST_F(TreePrefabSetup, GivenAPrefab_WhenInstantiated_ThenEachEntityHasACopyOfItsComponentsAndItsGroup)
+	{
+		const std::vector<Entity> trees = m_registry->Instantiate(m_treePrefab, 3);
+		m_registry->Update();
+
+		ASSERT_EQ(3u, trees.size());
+		trees[0].GetComponent<TransformComponent>().m_position.x = 0;
+		for (std::size_t i = 1; i < trees.size(); i++)
+		{
+			EXPECT_EQ(glm::vec2(10, 20), trees[i].GetComponent<TransformComponent>().m_position);
+			EXPECT_EQ("tree-texture", trees[i].GetComponent<SpriteComponent>().m_assetId);
+			EXPECT_FALSE(trees[i].HasComponent<RigidbodyComponent>());
+		}
+		EXPECT_EQ(10, m_treePrefab.GetComponent<TransformComponent>().m_position.x);
+		EXPECT_EQ(3u, m_registry->GetEntitiesByGroup("trees").size());
+	}
+
+	TEST_F(TreePrefabSetup, GivenAComponentAddedToTheInstances_WhenTheRegistryIsUpdated_ThenTheyAreAddedToTheSystemsRequiringIt)
+	{
+		m_treePrefab.AddComponent<RigidbodyComponent>(glm::vec2(1, 0));
+		const std::vector<Entity> movingTrees = m_registry->Instantiate(m_treePrefab, 2);
+		m_treePrefab.RemoveComponent<RigidbodyComponent>();
+		std::vector<Entity> trees = m_registry->Instantiate(m_treePrefab, 2);
+
+		// one of the trees is given a rigidbody after being instantiated
+		trees[1].AddComponent<RigidbodyComponent>();
+		m_registry->Update();
+
+		const auto& movingEntities = m_registry->GetSystem<MovementSystem>().GetSystemEntities();
+		ASSERT_EQ(3u, movingEntities.size());
+		EXPECT_NE(movingEntities.end(), std::find(movingEntities.begin(), movingEntities.end(), trees[1]));
+		EXPECT_EQ(movingEntities.end(), std::find(movingEntities.begin(), movingEntities.end(), trees[0]));
+	}
+
+	TEST_F(TreePrefabSetup, GivenAComponentAddedAgainToThePrefab_WhenInstantiated_ThenTheInstancesHaveTheNewOne)
+	{
+		m_treePrefab.AddComponent<SpriteComponent>("palm-texture", 16, 32);
+
+		const Entity tree = m_registry->Instantiate(m_treePrefab).front();
+
+		EXPECT_EQ("palm-texture", tree.GetComponent<SpriteComponent>().m_assetId);
+	}
+}
@@ -0,0 +1,135 @@
+#include "pch.h"
+
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+#include "AssetStore/RawTexture.h"
+#include "AssetStore/AssetStore.h"
+
+namespace RawTextureTests
+{
+	std::vector<unsigned char> RoundTrip(const std::vector<unsigned char>& data)
+	{
+		const std::vector<unsigned char> compressedData = RawTexture::CompressLz4(data.data(), data.size());
+		std::vector<unsigned char> decompressedData(data.size());
+		EXPECT_TRUE(RawTexture::DecompressLz4(compressedData.data(), compressedData.size(), decompressedData.data(), decompressedData.size()));
+		return decompressedData;
+	}
+
+	TEST(RawTextureTests, GivenPixels_WhenCompressedWithLz4_ThenTheyDecompressToTheSamePixels)
+	{
+		// a transparent border around noise, the runs are longer than what fits in a token
+		std::vector<unsigned char> pixels(64 * 64 * 4, 0);
+		unsigned int seed = 7;
+		for (std::size_t i = 4096; i < 8192; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			pixels[i] = static_cast<unsigned char>(seed >> 16);
+		}
+
+		EXPECT_EQ(pixels, RoundTrip(pixels));
+		EXPECT_LT(RawTexture::CompressLz4(pixels.data(), pixels.size()).size(), pixels.size() / 2);
+		EXPECT_EQ(std::vector<unsigned char>({ 1, 2, 3 }), RoundTrip({ 1, 2, 3 }));
+		EXPECT_EQ(std::vector<unsigned char>(), RoundTrip({}));
+	}
+
+	TEST(RawTextureTests, GivenATruncatedLz4Block_WhenDecompressed_ThenItFails)
+	{
+		const std::vector<unsigned char> pixels(1024, 9);
+		const std::vector<unsigned char> compressedData = RawTexture::CompressLz4(pixels.data(), pixels.size());
+		std::vector<unsigned char> decompressedData(pixels.size());
+
+		EXPECT_FALSE(RawTexture::DecompressLz4(compressedData.data(), compressedData.size() - 1, decompressedData.data(), decompressedData.size()));
+		EXPECT_FALSE(RawTexture::DecompressLz4(compressedData.data(), compressedData.size(), decompressedData.data(), decompressedData.size() - 1));
+	}
+
+	TEST(RawTextureTests, GivenASurface_WhenEncodedAndDecoded_ThenThePixelsAreInTheRequestedFormat)
+	{
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 8, 4, 32, SDL_PIXELFORMAT_ABGR8888);
+		SDL_FillRect(surface, nullptr, SDL_MapRGBA(surface->format, 10, 20, 30, 255));
+
+		for (const auto compression : { RawTexture::Compression::NONE, RawTexture::Compression::LZ4 })
+		{
+			const std::vector<unsigned char> data = RawTexture::Encode(surface, SDL_PIXELFORMAT_ARGB8888, compression);
+			RawTexture::Image image;
+			std::string error;
+			ASSERT_TRUE(RawTexture::Decode(data.data(), data.size(), image, error)) << error;
+
+			EXPECT_EQ(SDL_PIXELFORMAT_ARGB8888, image.m_pixelFormat);
+			EXPECT_EQ(8, image.m_width);
+			EXPECT_EQ(4, image.m_height);
+			Uint32 pixel;
+			std::memcpy(&pixel, image.m_pixels + image.m_pitch * 3 + 7 * 4, sizeof(pixel));
+			EXPECT_EQ(0xFF0A141Eu, pixel);
+
+			std::vector<unsigned char> truncatedData(data.begin(), data.end() - 1);
+			EXPECT_FALSE(RawTexture::Decode(truncatedData.data(), truncatedData.size(), image, error));
+		}
+		SDL_FreeSurface(surface);
+	}
+
+	TEST(RawTextureTests, GivenAHeaderWithAnUnknownFormatOrSize_WhenDecoded_ThenItIsRejectedBeforeAllocatingThePixels)
+	{
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 8, 4, 32, SDL_PIXELFORMAT_ARGB8888);
+		const std::vector<unsigned char> data = RawTexture::Encode(surface, SDL_PIXELFORMAT_ARGB8888, RawTexture::Compression::LZ4);
+		SDL_FreeSurface(surface);
+
+		// pixel format, width, height and pitch follow the magic and the version
+		const auto decodeWith = [&data](std::size_t offset, std::uint32_t value)
+		{
+			std::vector<unsigned char> changedData = data;
+			std::memcpy(changedData.data() + offset, &value, sizeof(value));
+			RawTexture::Image image;
+			std::string error;
+			return RawTexture::Decode(changedData.data(), changedData.size(), image, error);
+		};
+
+		EXPECT_FALSE(decodeWith(8, SDL_PIXELFORMAT_UNKNOWN));
+		EXPECT_FALSE(decodeWith(8, SDL_PIXELFORMAT_YV12));
+		// its pitch times 4 wraps around an int
+		EXPECT_FALSE(decodeWith(12, 0x40000000));
+		EXPECT_FALSE(decodeWith(16, CONST::RAW_TEXTURES::MAX_DIMENSION + 1));
+		// more than the compressed pixels could ever give
+		EXPECT_FALSE(decodeWith(16, CONST::RAW_TEXTURES::MAX_DIMENSION));
+		EXPECT_FALSE(decodeWith(20, 0xFFFFFFFF));
+		EXPECT_TRUE(decodeWith(20, 8 * 4));
+	}
+
+	TEST(RawTextureTests, GivenAConvertedImage_WhenAddedToTheAssetStore_ThenTheRawTextureIsUploadedUntilTheImageChanges)
+	{
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "RawTextureTests";
+		std::filesystem::create_directories(directory);
+		const std::string imagePath = (directory / "tank.bmp").generic_string();
+		const std::string rawPath = RawTexture::GetRawPath(imagePath);
+
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 6, 3, 32, SDL_PIXELFORMAT_ARGB8888);
+		SDL_SaveBMP(surface, imagePath.c_str());
+		// a raw texture of another size, to tell which one is loaded
+		SDL_Surface* rawSurface = SDL_CreateRGBSurfaceWithFormat(0, 2, 2, 32, SDL_PIXELFORMAT_ARGB8888);
+		const std::vector<unsigned char> data = RawTexture::Encode(rawSurface, SDL_PIXELFORMAT_ARGB8888, RawTexture::Compression::LZ4);
+		std::ofstream(rawPath, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+		std::filesystem::last_write_time(rawPath, std::filesystem::last_write_time(imagePath) + std::chrono::seconds(1));
+
+		SDL_Surface* targetSurface = SDL_CreateRGBSurfaceWithFormat(0, 16, 16, 32, SDL_PIXELFORMAT_ARGB8888);
+		SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(targetSurface);
+		{
+			AssetStore assetStore;
+			int width = 0;
+			const AssetHandle tank = assetStore.AddTexture(renderer, "tank", imagePath);
+			SDL_QueryTexture(assetStore.GetTexture("tank"), nullptr, nullptr, &width, nullptr);
+			EXPECT_EQ(2, width);
+
+			// edited after the conversion
+			std::filesystem::last_write_time(imagePath, std::filesystem::last_write_time(rawPath) + std::chrono::seconds(1));
+			const std::vector<AssetHandle> tank2 = assetStore.AddTextures(renderer, { { "tank2", imagePath } });
+			SDL_QueryTexture(assetStore.GetTexture("tank2"), nullptr, nullptr, &width, nullptr);
+			EXPECT_EQ(6, width);
+		}
+		SDL_DestroyRenderer(renderer);
+		SDL_FreeSurface(targetSurface);
+		SDL_FreeSurface(rawSurface);
+		SDL_FreeSurface(surface);
+		std::filesystem::remove_all(directory);
+	}
+}
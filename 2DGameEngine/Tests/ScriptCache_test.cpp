@@ -0,0 +1,162 @@
+#include "pch.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include <sol/sol.hpp>
+
+#include "Game/ScriptCache.h"
+#include "TemporaryDirectorySetup.h"
+
+namespace ScriptCacheTests
+{
+	class ScriptCacheSetup : public TemporaryDirectorySetup
+	{
+	public:
+		ScriptCacheSetup()
+			: TemporaryDirectorySetup("ScriptCacheTests")
+			, m_scriptPath((m_directory / "Script.lua").generic_string())
+			, m_cacheDirectory((m_directory / "cache").generic_string() + "/")
+		{
+		}
+
+		void WriteScript(const std::string& source)
+		{
+			WriteFile("Script.lua", source);
+		}
+
+		int LoadAndRun(ScriptCache& scriptCache)
+		{
+			sol::load_result script = scriptCache.Load(m_lua, m_scriptPath);
+			EXPECT_TRUE(script.valid());
+			return script.valid() ? script.call<int>() : -1;
+		}
+
+		std::size_t GetNumberOfCachedScripts() const
+		{
+			std::size_t numberOfCachedScripts = 0;
+			for (const auto& entry : std::filesystem::directory_iterator(m_cacheDirectory))
+			{
+				numberOfCachedScripts += entry.path().extension() == ".luac" ? 1 : 0;
+			}
+			return numberOfCachedScripts;
+		}
+
+		sol::state m_lua;
+		std::string m_scriptPath;
+		std::string m_cacheDirectory;
+	};
+
+	TEST_F(ScriptCacheSetup, GivenACompiledScript_WhenLoadedAgain_ThenTheBytecodeComesFromTheCache)
+	{
+		WriteScript("local a = 20 return a + 22");
+
+		ScriptCache firstRun(m_cacheDirectory);
+		EXPECT_EQ(LoadAndRun(firstRun), 42);
+		EXPECT_EQ(firstRun.GetNumberOfMisses(), 1);
+
+		ScriptCache secondRun(m_cacheDirectory);
+		EXPECT_EQ(LoadAndRun(secondRun), 42);
+		EXPECT_EQ(secondRun.GetNumberOfHits(), 1);
+		EXPECT_EQ(secondRun.GetNumberOfMisses(), 0);
+	}
+
+	TEST_F(ScriptCacheSetup, GivenACachedScript_WhenTheSourceChanges_ThenItIsCompiledAgainAndTheOldBytecodeDeleted)
+	{
+		ScriptCache scriptCache(m_cacheDirectory);
+		WriteScript("return 1");
+		EXPECT_EQ(LoadAndRun(scriptCache), 1);
+
+		WriteScript("return 2");
+		EXPECT_EQ(LoadAndRun(scriptCache), 2);
+
+		EXPECT_EQ(scriptCache.GetNumberOfMisses(), 2);
+		EXPECT_EQ(GetNumberOfCachedScripts(), 1);
+	}
+
+	TEST_F(ScriptCacheSetup, GivenScriptsOfTheSameNameInTwoDirectories_WhenLoadedInTurn_ThenBothStayCached)
+	{
+		const std::string firstScriptPath = WriteFile("a/enemy.lua", "return 1");
+		const std::string secondScriptPath = WriteFile("b/enemy.lua", "return 2");
+
+		ScriptCache firstRun(m_cacheDirectory);
+		EXPECT_TRUE(firstRun.Load(m_lua, firstScriptPath).valid());
+		EXPECT_TRUE(firstRun.Load(m_lua, secondScriptPath).valid());
+		EXPECT_EQ(GetNumberOfCachedScripts(), 2);
+
+		ScriptCache nextRun(m_cacheDirectory);
+		EXPECT_EQ(nextRun.Load(m_lua, firstScriptPath).call<int>(), 1);
+		EXPECT_EQ(nextRun.Load(m_lua, secondScriptPath).call<int>(), 2);
+		EXPECT_EQ(nextRun.GetNumberOfHits(), 2);
+	}
+
+	TEST_F(ScriptCacheSetup, GivenCorruptedBytecode_WhenLoaded_ThenTheSourceIsCompiledAgain)
+	{
+		WriteScript("return 3");
+		ScriptCache firstRun(m_cacheDirectory);
+		LoadAndRun(firstRun);
+
+		for (const auto& entry : std::filesystem::directory_iterator(m_cacheDirectory))
+		{
+			std::ofstream file(entry.path(), std::ios::binary | std::ios::trunc);
+			file << "\x1bLua garbage";
+		}
+
+		ScriptCache secondRun(m_cacheDirectory);
+		EXPECT_EQ(LoadAndRun(secondRun), 3);
+		EXPECT_EQ(secondRun.GetNumberOfMisses(), 1);
+
+		ScriptCache thirdRun(m_cacheDirectory);
+		EXPECT_EQ(LoadAndRun(thirdRun), 3);
+		EXPECT_EQ(thirdRun.GetNumberOfHits(), 1);
+	}
+
+	TEST_F(ScriptCacheSetup, GivenCachedBytecodeWithAChangedByte_WhenLoaded_ThenTheSourceIsCompiledAgain)
+	{
+		WriteScript("local a = 3 return a + 4");
+		ScriptCache firstRun(m_cacheDirectory);
+		LoadAndRun(firstRun);
+
+		// still starts like bytecode, only the checksum tells it apart
+		for (const auto& entry : std::filesystem::directory_iterator(m_cacheDirectory))
+		{
+			std::fstream file(entry.path(), std::ios::binary | std::ios::in | std::ios::out);
+			file.seekg(0, std::ios::end);
+			const std::streamoff middle = file.tellg() / 2;
+			file.seekg(middle);
+			const char byte = static_cast<char>(file.get());
+			file.seekp(middle);
+			file.put(static_cast<char>(byte ^ 0x20));
+		}
+
+		ScriptCache secondRun(m_cacheDirectory);
+		EXPECT_EQ(LoadAndRun(secondRun), 7);
+		EXPECT_EQ(secondRun.GetNumberOfMisses(), 1);
+	}
+
+	TEST_F(ScriptCacheSetup, GivenASyntaxError_WhenLoaded_ThenTheResultIsNotValidAndNothingIsCached)
+	{
+		WriteScript("return = 4");
+
+		ScriptCache scriptCache(m_cacheDirectory);
+		sol::load_result script = scriptCache.Load(m_lua, m_scriptPath);
+
+		EXPECT_FALSE(script.valid());
+		EXPECT_FALSE(std::filesystem::exists(m_cacheDirectory));
+	}
+
+	TEST_F(ScriptCacheSetup, GivenADirectoryOfScripts_WhenPrecompiled_ThenEveryScriptIsCached)
+	{
+		WriteScript("return 5");
+		WriteFile("Other.lua", "return 6");
+		WriteFile("NotAScript.txt", "return =");
+
+		ScriptCache scriptCache(m_cacheDirectory);
+		EXPECT_EQ(scriptCache.Precompile(m_lua, m_directory.generic_string()), 0);
+		EXPECT_EQ(GetNumberOfCachedScripts(), 2);
+
+		ScriptCache nextRun(m_cacheDirectory);
+		EXPECT_EQ(LoadAndRun(nextRun), 5);
+		EXPECT_EQ(nextRun.GetNumberOfHits(), 1);
+	}
+}
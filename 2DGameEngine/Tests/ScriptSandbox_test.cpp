@@ -0,0 +1,88 @@
+#include "pch.h"
+
+#include <sol/sol.hpp>
+
+#include "Game/ScriptSandbox.h"
+
+namespace ScriptSandboxTests
+{
+	class ScriptSandboxSetup : public ::testing::Test
+	{
+	public:
+		ScriptSandboxSetup()
+		{
+			m_lua.open_libraries(sol::lib::base, sol::lib::coroutine);
+		}
+
+		sol::state m_lua;
+	};
+
+	TEST_F(ScriptSandboxSetup, GivenTwoCopiesOfAFunction_WhenTheyWriteAGlobal_ThenEachWritesItsOwnEnvironment)
+	{
+		sol::function function = m_lua.script(R"(
+			greeting = "hello"
+			return function(value)
+				counter = value
+				return greeting
+			end
+		)");
+		const sol::table firstEnvironment = ScriptSandbox::CreateEnvironment(m_lua);
+		const sol::table secondEnvironment = ScriptSandbox::CreateEnvironment(m_lua);
+		sol::function first = ScriptSandbox::Isolate(function, firstEnvironment);
+		sol::function second = ScriptSandbox::Isolate(function, secondEnvironment);
+
+		const std::string firstGreeting = first(1);
+		second(2);
+
+		EXPECT_EQ("hello", firstGreeting);
+		EXPECT_EQ(1, firstEnvironment.get<int>("counter"));
+		EXPECT_EQ(2, secondEnvironment.get<int>("counter"));
+		const sol::object globalCounter = m_lua["counter"];
+		EXPECT_FALSE(globalCounter.valid());
+	}
+
+	TEST_F(ScriptSandboxSetup, GivenAFunctionUsingALocalOfItsLevel_WhenIsolated_ThenTheCopySharesTheLocal)
+	{
+		sol::table functions = m_lua.script(R"(
+			local number_of_calls = 0
+			return {
+				increment = function() number_of_calls = number_of_calls + 1 end,
+				get = function() return number_of_calls end
+			}
+		)");
+
+		sol::function increment = ScriptSandbox::Isolate(functions["increment"], ScriptSandbox::CreateEnvironment(m_lua));
+		increment();
+		increment();
+
+		sol::function get = functions["get"];
+		EXPECT_EQ(2, get.call<int>());
+	}
+
+	TEST_F(ScriptSandboxSetup, GivenABudget_WhenAThreadRunsLongerThanIt_ThenItYieldsAndFinishesWhenResumed)
+	{
+		sol::function function = m_lua.script(R"(
+			return function()
+				local sum = 0
+				for i = 1, 10000 do sum = sum + i end
+				return sum
+			end
+		)");
+		sol::thread thread = sol::thread::create(m_lua);
+		sol::coroutine coroutine(thread.state(), function);
+
+		int numberOfResumes = 0;
+		sol::protected_function_result result;
+		do
+		{
+			ScriptSandbox::SetInstructionBudget(thread.state(), 1000);
+			result = coroutine();
+			numberOfResumes++;
+			ASSERT_TRUE(result.valid());
+			EXPECT_EQ(result.status() == sol::call_status::yielded, ScriptSandbox::HasSpentInstructionBudget(thread.state()));
+		} while (result.status() == sol::call_status::yielded);
+
+		EXPECT_GT(numberOfResumes, 10);
+		EXPECT_EQ(50005000, result.get<int>());
+	}
+}
@@ -0,0 +1,343 @@
+#include "pch.h"
+
+#include <sol/sol.hpp>
+
+#include "ECS/ECS.h"
+
+#include "Systems/ScriptSystem.h"
+
+namespace ScriptSystemTests
+{
+	class ScriptBatchSetup : public ::testing::Test
+	{
+	public:
+		ScriptBatchSetup()
+		{
+			m_lua.open_libraries(sol::lib::base);
+			m_registry = std::make_unique<Registry>();
+			m_registry->AddSystem<ScriptSystem>();
+			m_registry->GetSystem<ScriptSystem>().CreateLuaFunctionBindings(m_lua);
+
+			// moves every entity by its velocity and counts the calls
+			m_batchScript = m_lua.script(R"(
+				number_of_calls = 0
+				return function(batch, delta_time, ellapsed_time)
+					number_of_calls = number_of_calls + 1
+					for i = 1, batch.count do
+						batch.position_x[i] = batch.position_x[i] + batch.velocity_x[i] * delta_time
+						batch.velocity_y[i] = batch.id[i]
+					end
+				end
+			)");
+		}
+
+		Entity CreateScriptedEntity(float x, sol::function batchScript)
+		{
+			Entity entity = m_registry->CreateEntity();
+			entity.AddComponent<TransformComponent>(glm::vec2(x, 0));
+			entity.AddComponent<RigidbodyComponent>(glm::vec2(10, 0));
+			entity.AddComponent<ScriptComponent>(sol::lua_nil, batchScript);
+			return entity;
+		}
+
+		sol::state m_lua;
+		std::unique_ptr<Registry> m_registry;
+		sol::function m_batchScript;
+	};
+
+	TEST_F(ScriptBatchSetup, GivenEntitiesSharingABatchScript_WhenUpdated_ThenOneCallUpdatesAllOfThem)
+	{
+		Entity first = CreateScriptedEntity(0, m_batchScript);
+		Entity second = CreateScriptedEntity(100, m_batchScript);
+		m_registry->Update();
+
+		m_registry->GetSystem<ScriptSystem>().Update(2, 0);
+
+		const int numberOfCalls = m_lua["number_of_calls"];
+		ASSERT_EQ(1, numberOfCalls);
+		ASSERT_EQ(1, m_registry->GetSystem<ScriptSystem>().GetNumberOfBatches());
+		EXPECT_FLOAT_EQ(20, first.GetComponent<TransformComponent>().m_position.x);
+		EXPECT_FLOAT_EQ(120, second.GetComponent<TransformComponent>().m_position.x);
+		EXPECT_FLOAT_EQ(static_cast<float>(second.GetId()), second.GetComponent<RigidbodyComponent>().m_velocity.y);
+	}
+
+	TEST_F(ScriptBatchSetup, GivenEntitiesWithDifferentBatchScripts_WhenUpdated_ThenEachScriptGetsItsOwnBatchUntilUnused)
+	{
+		sol::function otherBatchScript = m_lua.script("return function(batch) end");
+		CreateScriptedEntity(0, m_batchScript);
+		Entity firstRemoved = CreateScriptedEntity(0, otherBatchScript);
+		Entity secondRemoved = CreateScriptedEntity(0, otherBatchScript);
+		m_registry->Update();
+
+		m_registry->GetSystem<ScriptSystem>().Update(1, 0);
+		ASSERT_EQ(2, m_registry->GetSystem<ScriptSystem>().GetNumberOfBatches());
+
+		// once nobody uses a script its batch is dropped
+		m_registry->DestroyEntity(firstRemoved);
+		m_registry->DestroyEntity(secondRemoved);
+		m_registry->Update();
+		m_registry->GetSystem<ScriptSystem>().Update(1, 0);
+		ASSERT_EQ(1, m_registry->GetSystem<ScriptSystem>().GetNumberOfBatches());
+	}
+
+	TEST_F(ScriptBatchSetup, GivenComponentBindings_WhenScriptWritesThem_ThenTheEntityComponentsChange)
+	{
+		Entity entity = m_registry->CreateEntity();
+		entity.AddComponent<TransformComponent>(glm::vec2(1, 2));
+		entity.AddComponent<RigidbodyComponent>(glm::vec2(3, 4));
+		sol::function script = m_lua.script(R"(
+			return function(entity)
+				local transform = entity.transform
+				transform.position.x = transform.position.x + 10
+				transform.rotation = 90
+				entity.rigidbody.velocity.y = -4
+				has_animation = entity.animation ~= nil
+			end
+		)");
+
+		script(entity);
+
+		const auto& transform = entity.GetComponent<TransformComponent>();
+		EXPECT_FLOAT_EQ(11, transform.m_position.x);
+		EXPECT_FLOAT_EQ(2, transform.m_position.y);
+		EXPECT_DOUBLE_EQ(90, transform.m_rotation);
+		EXPECT_FLOAT_EQ(-4, entity.GetComponent<RigidbodyComponent>().m_velocity.y);
+		const bool hasAnimation = m_lua["has_animation"];
+		EXPECT_FALSE(hasAnimation);
+	}
+
+	class ScriptBehaviourSetup : public ScriptBatchSetup
+	{
+	public:
+		Entity CreateEntityWithBehaviour(const std::string& behaviourScript)
+		{
+			Entity entity = m_registry->CreateEntity();
+			entity.AddComponent<TransformComponent>(glm::vec2(0, 0));
+			entity.AddComponent<ScriptComponent>(sol::lua_nil, sol::lua_nil, m_lua.script(behaviourScript));
+			m_registry->Update();
+			return entity;
+		}
+
+		void UpdateFrames(int numberOfFrames, double deltaTime)
+		{
+			for (int i = 0; i < numberOfFrames; i++)
+			{
+				m_registry->GetSystem<ScriptSystem>().Update(deltaTime, 0);
+			}
+		}
+	};
+
+	TEST_F(ScriptBehaviourSetup, GivenABehaviourWaiting_WhenTheTimeHasPassed_ThenItResumesWhereItStopped)
+	{
+		Entity entity = CreateEntityWithBehaviour(R"(
+			return function(entity)
+				entity.transform.position.x = 1
+				wait(1)
+				entity.transform.position.x = 2
+			end
+		)");
+
+		UpdateFrames(1, 0.5);
+		EXPECT_FLOAT_EQ(1, entity.GetComponent<TransformComponent>().m_position.x);
+		UpdateFrames(1, 0.25);
+		EXPECT_FLOAT_EQ(1, entity.GetComponent<TransformComponent>().m_position.x);
+
+		UpdateFrames(1, 0.75);
+		EXPECT_FLOAT_EQ(2, entity.GetComponent<TransformComponent>().m_position.x);
+		EXPECT_EQ(0, m_registry->GetSystem<ScriptSystem>().GetNumberOfBehaviours());
+	}
+
+	TEST_F(ScriptBehaviourSetup, GivenABehaviourWaitingForACondition_WhenItBecomesTrue_ThenItResumes)
+	{
+		Entity entity = CreateEntityWithBehaviour(R"(
+			door_is_open = false
+			return function(entity)
+				wait_until(function() return door_is_open end)
+				entity.transform.position.y = 5
+			end
+		)");
+
+		UpdateFrames(10, 1);
+		EXPECT_FLOAT_EQ(0, entity.GetComponent<TransformComponent>().m_position.y);
+
+		m_lua["door_is_open"] = true;
+		UpdateFrames(1, 1);
+		EXPECT_FLOAT_EQ(5, entity.GetComponent<TransformComponent>().m_position.y);
+	}
+
+	TEST_F(ScriptBehaviourSetup, GivenABehaviourInALoop_WhenItsEntityIsDestroyed_ThenItIsNotResumedAnymore)
+	{
+		CreateEntityWithBehaviour(R"(
+			number_of_steps = 0
+			return function(entity)
+				while true do
+					number_of_steps = number_of_steps + 1
+					wait(0)
+				end
+			end
+		)");
+		Entity destroyed = m_registry->GetSystem<ScriptSystem>().GetSystemEntities().front();
+
+		UpdateFrames(3, 1);
+		const int numberOfStepsBeforeDestroy = m_lua["number_of_steps"];
+		EXPECT_EQ(3, numberOfStepsBeforeDestroy);
+
+		m_registry->DestroyEntity(destroyed);
+		m_registry->Update();
+		UpdateFrames(3, 1);
+		const int numberOfSteps = m_lua["number_of_steps"];
+		EXPECT_EQ(3, numberOfSteps);
+		EXPECT_EQ(0, m_registry->GetSystem<ScriptSystem>().GetNumberOfBehaviours());
+	}
+
+	TEST_F(ScriptBehaviourSetup, GivenABehaviourRaisingAnError_WhenResumed_ThenOnlyThatBehaviourStops)
+	{
+		CreateEntityWithBehaviour("return function(entity) wait(1) error('broken') end");
+		CreateEntityWithBehaviour("return function(entity) wait(10) end");
+
+		UpdateFrames(2, 1);
+
+		EXPECT_EQ(1, m_registry->GetSystem<ScriptSystem>().GetNumberOfBehaviours());
+	}
+
+	TEST_F(ScriptBehaviourSetup, GivenSandboxedScripts_WhenEntitiesWriteTheSameGlobal_ThenTheyDoNotSeeEachOther)
+	{
+		m_registry->GetSystem<ScriptSystem>().SetSandboxed(true);
+		sol::function script = m_lua.script(R"(
+			speed = 10
+			return function(entity)
+				position = (position or 0) + speed
+				entity.transform.position.x = position
+			end
+		)");
+		Entity first = m_registry->CreateEntity();
+		first.AddComponent<TransformComponent>();
+		first.AddComponent<ScriptComponent>(script);
+		Entity second = m_registry->CreateEntity();
+		second.AddComponent<TransformComponent>();
+		second.AddComponent<ScriptComponent>(script);
+		m_registry->Update();
+
+		UpdateFrames(2, 1);
+
+		EXPECT_FLOAT_EQ(20, first.GetComponent<TransformComponent>().m_position.x);
+		EXPECT_FLOAT_EQ(20, second.GetComponent<TransformComponent>().m_position.x);
+		const sol::object globalPosition = m_lua["position"];
+		EXPECT_FALSE(globalPosition.valid());
+	}
+
+	TEST_F(ScriptBehaviourSetup, GivenASandboxedEntity_WhenOnlyItsUpdateScriptIsReplaced_ThenTheNewScriptSharesTheEnvironmentOfItsBehaviour)
+	{
+		m_registry->GetSystem<ScriptSystem>().SetSandboxed(true);
+		Entity entity = m_registry->CreateEntity();
+		entity.AddComponent<TransformComponent>();
+		entity.AddComponent<ScriptComponent>(sol::lua_nil, sol::lua_nil, m_lua.script(R"(
+			return function(entity)
+				while true do
+					steps = (steps or 0) + 1
+					wait(0)
+				end
+			end
+		)").get<sol::function>());
+		m_registry->Update();
+		UpdateFrames(2, 1);
+
+		ScriptSystem::ReplacedFunctions replacedFunctions;
+		replacedFunctions.m_isScriptReplaced = true;
+		sol::function script = m_lua.script("return function(entity) entity.transform.position.x = steps end");
+		m_registry->GetSystem<ScriptSystem>().ReplaceScript(entity, ScriptComponent(script), replacedFunctions);
+		UpdateFrames(1, 1);
+
+		// the steps the behaviour counted in the entity's environment, the update scripts run before the behaviours
+		EXPECT_FLOAT_EQ(2, entity.GetComponent<TransformComponent>().m_position.x);
+		const sol::object globalSteps = m_lua["steps"];
+		EXPECT_FALSE(globalSteps.valid());
+	}
+
+	TEST_F(ScriptBehaviourSetup, GivenAnInstructionBudget_WhenAnUpdateScriptNeverEnds_ThenTheOtherScriptsStillRunEveryFrame)
+	{
+		m_registry->GetSystem<ScriptSystem>().SetInstructionBudget(10000);
+		sol::function runawayScript = m_lua.script("return function(entity) while true do end end");
+		sol::function healthyScript = m_lua.script("return function(entity, delta_time) entity.transform.position.x = entity.transform.position.x + delta_time end");
+		Entity runaway = m_registry->CreateEntity();
+		runaway.AddComponent<ScriptComponent>(runawayScript);
+		Entity healthy = m_registry->CreateEntity();
+		healthy.AddComponent<TransformComponent>();
+		healthy.AddComponent<ScriptComponent>(healthyScript);
+		m_registry->Update();
+
+		UpdateFrames(3, 1);
+
+		EXPECT_FLOAT_EQ(3, healthy.GetComponent<TransformComponent>().m_position.x);
+		EXPECT_EQ(1, m_registry->GetSystem<ScriptSystem>().GetNumberOfDeferredScripts());
+	}
+
+	TEST_F(ScriptBehaviourSetup, GivenAnInstructionBudget_WhenAnUpdateScriptGoesOverIt_ThenItIsFinishedOnTheNextFrames)
+	{
+		m_registry->GetSystem<ScriptSystem>().SetInstructionBudget(10000);
+		sol::function script = m_lua.script(R"(
+			return function(entity)
+				local sum = 0
+				for i = 1, 10000 do sum = sum + 1 end
+				entity.transform.position.x = entity.transform.position.x + sum
+			end
+		)");
+		Entity entity = m_registry->CreateEntity();
+		entity.AddComponent<TransformComponent>();
+		entity.AddComponent<ScriptComponent>(script);
+		m_registry->Update();
+
+		UpdateFrames(1, 1);
+		EXPECT_FLOAT_EQ(0, entity.GetComponent<TransformComponent>().m_position.x);
+		EXPECT_EQ(1, m_registry->GetSystem<ScriptSystem>().GetNumberOfDeferredScripts());
+
+		int numberOfFrames = 1;
+		while (m_registry->GetSystem<ScriptSystem>().GetNumberOfDeferredScripts() > 0 && numberOfFrames < 100)
+		{
+			UpdateFrames(1, 1);
+			numberOfFrames++;
+		}
+		EXPECT_FLOAT_EQ(10000, entity.GetComponent<TransformComponent>().m_position.x);
+	}
+
+	TEST_F(ScriptBehaviourSetup, GivenAnInstructionBudget_WhenAnUpdateScriptRaisesAnErrorThatIsNotAString_ThenItIsLoggedAndCalledAgainNextFrame)
+	{
+		m_registry->GetSystem<ScriptSystem>().SetInstructionBudget(10000);
+		sol::function script = m_lua.script(R"(
+			number_of_calls = 0
+			return function(entity)
+				number_of_calls = number_of_calls + 1
+				if number_of_calls == 1 then error({}) end
+				if number_of_calls == 2 then error(nil) end
+			end
+		)");
+		Entity entity = m_registry->CreateEntity();
+		entity.AddComponent<ScriptComponent>(script);
+		m_registry->Update();
+
+		UpdateFrames(3, 1);
+
+		const int numberOfCalls = m_lua["number_of_calls"];
+		EXPECT_EQ(3, numberOfCalls);
+		EXPECT_EQ(0, m_registry->GetSystem<ScriptSystem>().GetNumberOfDeferredScripts());
+	}
+
+	TEST_F(ScriptBehaviourSetup, GivenAnInstructionBudget_WhenABehaviourGoesOverIt_ThenItContinuesNextFrame)
+	{
+		m_registry->GetSystem<ScriptSystem>().SetInstructionBudget(10000);
+		Entity entity = CreateEntityWithBehaviour(R"(
+			return function(entity)
+				local sum = 0
+				for i = 1, 10000 do sum = sum + 1 end
+				entity.transform.position.x = sum
+			end
+		)");
+
+		UpdateFrames(1, 1);
+		EXPECT_EQ(1, m_registry->GetSystem<ScriptSystem>().GetNumberOfBehaviours());
+
+		UpdateFrames(5, 1);
+		EXPECT_FLOAT_EQ(10000, entity.GetComponent<TransformComponent>().m_position.x);
+		EXPECT_EQ(0, m_registry->GetSystem<ScriptSystem>().GetNumberOfBehaviours());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "pch.h"
+
+#include "ECS/ECS.h"
+#include "SpatialGrid/SpatialGrid.h"
+
+namespace SpatialGridTests
+{
+	class SpatialGridSetup : public ::testing::Test
+	{
+	public:
+		SpatialGridSetup()
+			: m_registry(std::make_unique<Registry>())
+			, m_grid(m_cellSize)
+		{
+		}
+
+		std::vector<Entity> QueryArea(const SDL_Rect& area) const
+		{
+			std::vector<Entity> entitiesInArea;
+			m_grid.Query(area, entitiesInArea);
+			return entitiesInArea;
+		}
+
+		bool Contains(const std::vector<Entity>& entities, const Entity& entity) const
+		{
+			return std::find(entities.begin(), entities.end(), entity) != entities.end();
+		}
+
+		const int m_cellSize = 100;
+		std::unique_ptr<Registry> m_registry;
+		SpatialGrid m_grid;
+	};
+
+	TEST_F(SpatialGridSetup, GivenEntityInsideArea_WhenQueried_ThenEntityIsReturned)
+	{
+		const Entity entity = m_registry->CreateEntity();
+		m_grid.Insert(entity, SDL_FRect{ 50, 50, 10, 10 });
+
+		const auto entitiesInArea = QueryArea(SDL_Rect{ 0, 0, 200, 200 });
+
+		ASSERT_EQ(1, entitiesInArea.size());
+		ASSERT_TRUE(Contains(entitiesInArea, entity));
+	}
+
+	TEST_F(SpatialGridSetup, GivenEntityOutsideArea_WhenQueried_ThenEntityIsNotReturned)
+	{
+		const Entity entity = m_registry->CreateEntity();
+		m_grid.Insert(entity, SDL_FRect{ 1000, 1000, 10, 10 });
+
+		const auto entitiesInArea = QueryArea(SDL_Rect{ 0, 0, 200, 200 });
+
+		ASSERT_TRUE(entitiesInArea.empty());
+	}
+
+	TEST_F(SpatialGridSetup, GivenBigEntityCenteredInAnotherCell_WhenQueriedAreaOverlapsItsEdge_ThenEntityIsReturned)
+	{
+		// the center of this entity is many cells away from the queried area but its edge is inside it
+		const Entity entity = m_registry->CreateEntity();
+		m_grid.Insert(entity, SDL_FRect{ 150, 0, 1000, 10 });
+
+		const auto entitiesInArea = QueryArea(SDL_Rect{ 0, 0, 160, 20 });
+
+		ASSERT_TRUE(Contains(entitiesInArea, entity));
+	}
+
+	TEST_F(SpatialGridSetup, GivenEntityWithNegativeCoordinates_WhenQueried_ThenEntityIsReturned)
+	{
+		const Entity entity = m_registry->CreateEntity();
+		m_grid.Insert(entity, SDL_FRect{ -250, -250, 20, 20 });
+
+		const auto entitiesInArea = QueryArea(SDL_Rect{ -300, -300, 100, 100 });
+
+		ASSERT_TRUE(Contains(entitiesInArea, entity));
+	}
+
+	TEST_F(SpatialGridSetup, GivenRemovedEntity_WhenQueried_ThenEntityIsNotReturned)
+	{
+		const Entity removedEntity = m_registry->CreateEntity();
+		const Entity keptEntity = m_registry->CreateEntity();
+		m_grid.Insert(removedEntity, SDL_FRect{ 10, 10, 10, 10 });
+		m_grid.Insert(keptEntity, SDL_FRect{ 20, 20, 10, 10 });
+
+		m_grid.Remove(removedEntity);
+		const auto entitiesInArea = QueryArea(SDL_Rect{ 0, 0, 100, 100 });
+
+		ASSERT_FALSE(m_grid.Contains(removedEntity));
+		ASSERT_FALSE(Contains(entitiesInArea, removedEntity));
+		ASSERT_TRUE(Contains(entitiesInArea, keptEntity));
+	}
+
+	TEST_F(SpatialGridSetup, GivenEntitiesSpreadOverTheMap_WhenQueried_ThenOnlyIntersectingEntitiesAreReturned)
+	{
+		const int entitiesPerRow = 50;
+		const float entitySize = 32;
+		for (int y = 0; y < entitiesPerRow; y++)
+		{
+			for (int x = 0; x < entitiesPerRow; x++)
+			{
+				m_grid.Insert(m_registry->CreateEntity(), SDL_FRect{ x * entitySize, y * entitySize, entitySize, entitySize });
+			}
+		}
+
+		// a 2x2 block of entities fits exactly inside this area and the entities around it touch its borders (4x4 in total)
+		const SDL_Rect area{ 320, 320, 64, 64 };
+		const auto entitiesInArea = QueryArea(area);
+
+		ASSERT_EQ(entitiesPerRow * entitiesPerRow, m_grid.GetSize());
+		ASSERT_EQ(16, entitiesInArea.size());
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Base of the fixtures that write files: a directory of their own in the temporary directory, emptied before each test
+// (a run that crashed may have left files in it) and removed after it, once the members of the fixture are destroyed
+class TemporaryDirectorySetup : public ::testing::Test
+{
+public:
+	TemporaryDirectorySetup(const std::string& directoryName)
+		: m_directory(std::filesystem::temp_directory_path() / directoryName)
+	{
+		std::filesystem::remove_all(m_directory);
+		std::filesystem::create_directories(m_directory);
+	}
+
+	~TemporaryDirectorySetup()
+	{
+		std::filesystem::remove_all(m_directory);
+	}
+
+	// 'fileName' is relative to the directory, the missing directories are created. Returns the path of the file
+	std::string WriteFile(const std::string& fileName, const std::string& content) const
+	{
+		const std::filesystem::path filePath = m_directory / fileName;
+		std::filesystem::create_directories(filePath.parent_path());
+		std::ofstream(filePath, std::ios::binary) << content;
+		return filePath.generic_string();
+	}
+
+	std::filesystem::path m_directory;
+};
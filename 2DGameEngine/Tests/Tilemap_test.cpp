@@ -0,0 +1,98 @@
+#include "pch.h"
+
+#include "ECS/ECS.h"
+#include "Tilemap/Tilemap.h"
+#include "Components/SpriteComponent.h"
+#include "Components/TransformComponent.h"
+
+namespace TilemapTests
+{
+	// 32x32 tiles at scale 1 in chunks of 8 tiles: a chunk is 256 pixels wide
+	class TilemapSetup : public ::testing::Test
+	{
+	public:
+		TilemapSetup()
+			: m_registry(std::make_unique<Registry>())
+			, m_tilemap("tileset", 32, 1., 8)
+		{
+		}
+
+		// numberOfColumns x numberOfRows tiles of value 21
+		std::string CreateMap(int numberOfColumns, int numberOfRows) const
+		{
+			std::string map;
+			for (int row = 0; row < numberOfRows; row++)
+			{
+				for (int column = 0; column < numberOfColumns; column++)
+				{
+					map += column == 0 ? "21" : ",21";
+				}
+				map += "\n";
+			}
+			return map;
+		}
+
+		bool Parse(const std::string& map, int numberOfColumns, int numberOfRows)
+		{
+			std::string error;
+			return m_tilemap.Parse(map.data(), map.size(), numberOfColumns, numberOfRows, error);
+		}
+
+		std::unique_ptr<Registry> m_registry;
+		Tilemap m_tilemap;
+	};
+
+	TEST_F(TilemapSetup, GivenAMapWithWindowsLineEndings_WhenParsed_ThenEveryTileKeepsBothOfItsDigits)
+	{
+		ASSERT_TRUE(Parse("21,08,13\r\n26, 9,10\r\n", 3, 2));
+
+		EXPECT_EQ(21, m_tilemap.GetTile(0, 0));
+		EXPECT_EQ(8, m_tilemap.GetTile(1, 0));
+		EXPECT_EQ(26, m_tilemap.GetTile(0, 1));
+		EXPECT_EQ(9, m_tilemap.GetTile(1, 1));
+		EXPECT_EQ(10, m_tilemap.GetTile(2, 1));
+	}
+
+	TEST_F(TilemapSetup, GivenAMapOfTheWrongSize_WhenParsed_ThenItIsRejected)
+	{
+		EXPECT_FALSE(Parse("21,21\n21\n", 2, 2));
+		EXPECT_FALSE(Parse("21,21,21\n21,21\n", 2, 2));
+		EXPECT_FALSE(Parse("21,21\n", 2, 2));
+		EXPECT_FALSE(Parse("21,x1\n21,21\n", 2, 2));
+		EXPECT_TRUE(Parse("21,21\n21,21", 2, 2));
+	}
+
+	TEST_F(TilemapSetup, GivenATile_WhenItsChunkIsLoaded_ThenItsSpriteComesFromTheTilesetRowAndColumnOfItsDigits)
+	{
+		ASSERT_TRUE(Parse("21,08\n", 2, 1));
+		m_tilemap.LoadAllChunks(*m_registry);
+
+		const auto& firstSprite = m_registry->GetComponent<SpriteComponent>(Entity(0));
+		EXPECT_EQ(1 * 32, firstSprite.m_textureRect.x);
+		EXPECT_EQ(2 * 32, firstSprite.m_textureRect.y);
+		const auto& secondSprite = m_registry->GetComponent<SpriteComponent>(Entity(1));
+		EXPECT_EQ(8 * 32, secondSprite.m_textureRect.x);
+		EXPECT_EQ(0, secondSprite.m_textureRect.y);
+		EXPECT_EQ(32, m_registry->GetComponent<TransformComponent>(Entity(1)).m_position.x);
+	}
+
+	TEST_F(TilemapSetup, GivenACameraMovingAcrossALargeMap_WhenStreamed_ThenOnlyTheChunksAroundItAreLoaded)
+	{
+		ASSERT_TRUE(Parse(CreateMap(256, 16), 256, 16));
+		m_tilemap.SetStreamingRadius(1, 2);
+
+		// sees the chunk (0, 0), loads (0..1, 0..1)
+		m_tilemap.Stream(*m_registry, SDL_Rect{ 0, 0, 256, 256 });
+		EXPECT_EQ(4, m_tilemap.GetNumberOfLoadedChunks());
+		EXPECT_EQ(4 * 8 * 8, m_tilemap.GetNumberOfLoadedTiles());
+
+		// sees the chunks (2, 0..1): (0..1, 0..1) are within the unload radius and kept, (2..3, 0..1) are loaded
+		m_tilemap.Stream(*m_registry, SDL_Rect{ 512, 0, 256, 300 });
+		EXPECT_EQ(8, m_tilemap.GetNumberOfLoadedChunks());
+
+		// far away, only the chunks (19..21, 0..1) are left
+		m_tilemap.Stream(*m_registry, SDL_Rect{ 20 * 256, 0, 256, 256 });
+		EXPECT_EQ(6, m_tilemap.GetNumberOfLoadedChunks());
+		EXPECT_EQ(6 * 8 * 8, m_tilemap.GetNumberOfLoadedTiles());
+	}
+}